@@ -0,0 +1,221 @@
+#include "ActionBuffer.h"
+
+#include "Profiler.h"
+
+#include <algorithm>
+
+using namespace sc2;
+
+namespace {
+
+// Whether the ability replaces the unit's orders when it is not queued.
+// Train, research and instant commands like a MULE or a scan leave the
+// orders alone, so they are kept next to the other commands of the frame.
+bool ReplacesOrders(AbilityID ability) {
+	switch (ability.ToType()) {
+	case ABILITY_ID::ATTACK:
+	case ABILITY_ID::ATTACK_ATTACK:
+	case ABILITY_ID::MOVE_MOVE:
+	case ABILITY_ID::SMART:
+	case ABILITY_ID::STOP:
+	case ABILITY_ID::HOLDPOSITION:
+	case ABILITY_ID::PATROL:
+	case ABILITY_ID::HARVEST_GATHER:
+	case ABILITY_ID::HARVEST_RETURN:
+	case ABILITY_ID::EFFECT_REPAIR:
+	case ABILITY_ID::EFFECT_REPAIR_SCV:
+	case ABILITY_ID::EFFECT_TACTICALJUMP:
+	case ABILITY_ID::BUILD_ARMORY:
+	case ABILITY_ID::BUILD_BARRACKS:
+	case ABILITY_ID::BUILD_BUNKER:
+	case ABILITY_ID::BUILD_COMMANDCENTER:
+	case ABILITY_ID::BUILD_ENGINEERINGBAY:
+	case ABILITY_ID::BUILD_FACTORY:
+	case ABILITY_ID::BUILD_FUSIONCORE:
+	case ABILITY_ID::BUILD_GHOSTACADEMY:
+	case ABILITY_ID::BUILD_MISSILETURRET:
+	case ABILITY_ID::BUILD_REFINERY:
+	case ABILITY_ID::BUILD_SENSORTOWER:
+	case ABILITY_ID::BUILD_STARPORT:
+	case ABILITY_ID::BUILD_SUPPLYDEPOT:
+		return true;
+	default:
+		return false;
+	}
+}
+
+}
+
+bool ActionBuffer::SameCommand(const Group& a, const Group& b) const {
+	return a.ability == b.ability && a.target_type == b.target_type &&
+		a.queued == b.queued && a.target_unit == b.target_unit &&
+		a.point.x == b.point.x && a.point.y == b.point.y;
+}
+
+void ActionBuffer::Add(const Unit* unit, const Group& command) {
+	++total_commands;
+
+	// Earliest group the unit can join without reordering its commands
+	size_t first = 0;
+	auto last = last_group.find(unit->tag);
+	if (last != last_group.end()) {
+		if (command.queued || !ReplacesOrders(command.ability)) {
+			first = last->second + 1;
+		}
+		else {
+			// The new command replaces the orders sent before it
+			Remove(unit);
+		}
+	}
+
+	size_t index = groups.size();
+	for (size_t i = groups.size(); i > first; --i) {
+		if (SameCommand(groups[i - 1], command)) {
+			index = i - 1;
+			break;
+		}
+	}
+	if (index == groups.size()) {
+		groups.push_back(command);
+	}
+	groups[index].units.push_back(unit);
+	last_group[unit->tag] = index;
+}
+
+void ActionBuffer::Remove(const Unit* unit) {
+	for (auto& group : groups) {
+		if (!ReplacesOrders(group.ability)) {
+			continue;
+		}
+		group.units.erase(
+			std::remove(group.units.begin(), group.units.end(), unit),
+			group.units.end());
+	}
+}
+
+void ActionBuffer::Flush() {
+	PROFILE_SCOPE("FlushActions");
+	for (const auto& group : groups) {
+		if (group.units.empty()) {
+			continue;
+		}
+		++total_groups;
+		// Single units keep the single unit call
+		if (group.units.size() == 1) {
+			const Unit* unit = group.units.front();
+			switch (group.target_type) {
+			case Group::PointTarget:
+				target->UnitCommand(unit, group.ability, group.point,
+					group.queued);
+				break;
+			case Group::UnitTarget:
+				target->UnitCommand(unit, group.ability, group.target_unit,
+					group.queued);
+				break;
+			default:
+				target->UnitCommand(unit, group.ability, group.queued);
+				break;
+			}
+			continue;
+		}
+		switch (group.target_type) {
+		case Group::PointTarget:
+			target->UnitCommand(group.units, group.ability, group.point,
+				group.queued);
+			break;
+		case Group::UnitTarget:
+			target->UnitCommand(group.units, group.ability, group.target_unit,
+				group.queued);
+			break;
+		default:
+			target->UnitCommand(group.units, group.ability, group.queued);
+			break;
+		}
+	}
+	groups.clear();
+	last_group.clear();
+}
+
+void ActionBuffer::UnitCommand(const Unit* unit, AbilityID ability,
+	bool queued_command) {
+	// Leave invalid commands to the game
+	if (!unit) {
+		target->UnitCommand(unit, ability, queued_command);
+		return;
+	}
+	Group command;
+	command.ability = ability;
+	command.queued = queued_command;
+	Add(unit, command);
+}
+
+void ActionBuffer::UnitCommand(const Unit* unit, AbilityID ability,
+	const Point2D& point, bool queued_command) {
+	if (!unit) {
+		target->UnitCommand(unit, ability, point, queued_command);
+		return;
+	}
+	Group command;
+	command.ability = ability;
+	command.target_type = Group::PointTarget;
+	command.point = point;
+	command.queued = queued_command;
+	Add(unit, command);
+}
+
+void ActionBuffer::UnitCommand(const Unit* unit, AbilityID ability,
+	const Unit* unit_target, bool queued_command) {
+	if (!unit) {
+		target->UnitCommand(unit, ability, unit_target, queued_command);
+		return;
+	}
+	Group command;
+	command.ability = ability;
+	command.target_type = Group::UnitTarget;
+	command.target_unit = unit_target;
+	command.queued = queued_command;
+	Add(unit, command);
+}
+
+void ActionBuffer::UnitCommand(const Units& units, AbilityID ability,
+	bool queued_move) {
+	for (const auto& unit : units) {
+		UnitCommand(unit, ability, queued_move);
+	}
+}
+
+void ActionBuffer::UnitCommand(const Units& units, AbilityID ability,
+	const Point2D& point, bool queued_command) {
+	for (const auto& unit : units) {
+		UnitCommand(unit, ability, point, queued_command);
+	}
+}
+
+void ActionBuffer::UnitCommand(const Units& units, AbilityID ability,
+	const Unit* unit_target, bool queued_command) {
+	for (const auto& unit : units) {
+		UnitCommand(unit, ability, unit_target, queued_command);
+	}
+}
+
+const std::vector<Tag>& ActionBuffer::Commands() const {
+	return target->Commands();
+}
+
+void ActionBuffer::ToggleAutocast(Tag unit_tag, AbilityID ability) {
+	target->ToggleAutocast(unit_tag, ability);
+}
+
+void ActionBuffer::ToggleAutocast(const std::vector<Tag>& unit_tags,
+	AbilityID ability) {
+	target->ToggleAutocast(unit_tags, ability);
+}
+
+void ActionBuffer::SendChat(const std::string& message, ChatChannel channel) {
+	target->SendChat(message, channel);
+}
+
+void ActionBuffer::SendActions() {
+	Flush();
+	target->SendActions();
+}
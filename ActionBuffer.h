@@ -0,0 +1,83 @@
+#ifndef ACTION_BUFFER_H_
+#define ACTION_BUFFER_H_
+
+#include "sc2api/sc2_interfaces.h"
+#include "sc2api/sc2_unit.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Holds the unit commands of a frame and sends them as group commands.
+// Commands with the same ability, target and queue flag are merged into
+// one UnitCommand(Units, ...) when Flush() is called at the end of the
+// step. What each unit ends up doing is unchanged: a new move, attack or
+// build drops the unit's earlier orders of the frame, like the game would,
+// while train and instant commands are kept next to them. Queued commands
+// are sent after the ones before them.
+class ActionBuffer : public sc2::ActionInterface {
+public:
+	void SetTarget(sc2::ActionInterface* actions) { target = actions; }
+
+	// Sends the buffered commands, one call per group
+	void Flush();
+
+	// Number of unit commands buffered since the start of the game
+	uint64_t TotalCommands() const { return total_commands; }
+
+	// Number of commands sent to the game after merging
+	uint64_t TotalGroups() const { return total_groups; }
+
+	void UnitCommand(const sc2::Unit* unit, sc2::AbilityID ability,
+		bool queued_command = false) override;
+	void UnitCommand(const sc2::Unit* unit, sc2::AbilityID ability,
+		const sc2::Point2D& point, bool queued_command = false) override;
+	void UnitCommand(const sc2::Unit* unit, sc2::AbilityID ability,
+		const sc2::Unit* target, bool queued_command = false) override;
+	void UnitCommand(const sc2::Units& units, sc2::AbilityID ability,
+		bool queued_move = false) override;
+	void UnitCommand(const sc2::Units& units, sc2::AbilityID ability,
+		const sc2::Point2D& point, bool queued_command = false) override;
+	void UnitCommand(const sc2::Units& units, sc2::AbilityID ability,
+		const sc2::Unit* target, bool queued_command = false) override;
+	const std::vector<sc2::Tag>& Commands() const override;
+	void ToggleAutocast(sc2::Tag unit_tag, sc2::AbilityID ability) override;
+	void ToggleAutocast(const std::vector<sc2::Tag>& unit_tags,
+		sc2::AbilityID ability) override;
+	void SendChat(const std::string& message,
+		sc2::ChatChannel channel = sc2::ChatChannel::All) override;
+	void SendActions() override;
+
+private:
+	struct Group {
+		enum TargetType { NoTarget, PointTarget, UnitTarget };
+
+		sc2::AbilityID ability;
+		TargetType target_type = NoTarget;
+		sc2::Point2D point;
+		const sc2::Unit* target_unit = nullptr;
+		bool queued = false;
+		sc2::Units units;
+	};
+
+	bool SameCommand(const Group& a, const Group& b) const;
+
+	// Adds the unit to the last matching group it may join
+	void Add(const sc2::Unit* unit, const Group& command);
+
+	// Removes the unit from every group of the frame that gives it orders
+	void Remove(const sc2::Unit* unit);
+
+	sc2::ActionInterface* target = nullptr;
+
+	// Groups of the frame, in the order they were created
+	std::vector<Group> groups;
+
+	// Index of the last group each commanded unit was added to
+	std::unordered_map<sc2::Tag, size_t> last_group;
+
+	uint64_t total_commands = 0;
+	uint64_t total_groups = 0;
+};
+
+#endif
@@ -0,0 +1,209 @@
+#include "ActionFilter.h"
+
+using namespace sc2;
+
+namespace {
+
+// Points closer than this are the same command target
+const float kPointTolerance = 0.1f;
+
+} // namespace
+
+void ActionFilter::NewFrame(const ObservationInterface* obs) {
+	game_loop = obs->GetGameLoop();
+	suppressed = 0;
+
+	// Ability data is only needed to match commands with their orders
+	if (remaps.empty()) {
+		for (const AbilityData& data : obs->GetAbilityData()) {
+			uint32_t id = data.ability_id;
+			if (id >= remaps.size()) {
+				remaps.resize(id + 1, 0);
+			}
+			remaps[id] = data.remaps_to_ability_id;
+		}
+	}
+}
+
+uint32_t ActionFilter::Generalize(AbilityID ability) const {
+	uint32_t id = ability;
+	if (id < remaps.size() && remaps[id] != 0) {
+		return remaps[id];
+	}
+	return id;
+}
+
+bool ActionFilter::MatchesOrder(const Unit* unit,
+	const Command& command) const {
+	// A new command replaces the whole queue, so only a single order matches
+	if (unit->orders.size() != 1) {
+		return false;
+	}
+	const UnitOrder& order = unit->orders.front();
+	if (Generalize(order.ability_id) != Generalize(command.ability)) {
+		return false;
+	}
+	switch (command.target_type) {
+	case Command::UnitTarget:
+		return order.target_unit_tag == command.target_tag;
+	case Command::PointTarget:
+		return order.target_unit_tag == 0 &&
+			DistanceSquared2D(order.target_pos, command.point) <
+			kPointTolerance * kPointTolerance;
+	default:
+		return order.target_unit_tag == 0;
+	}
+}
+
+bool ActionFilter::SameCommand(const Command& a, const Command& b) const {
+	if (a.ability != b.ability || a.target_type != b.target_type) {
+		return false;
+	}
+	switch (a.target_type) {
+	case Command::UnitTarget:
+		return a.target_tag == b.target_tag;
+	case Command::PointTarget:
+		return DistanceSquared2D(a.point, b.point) <
+			kPointTolerance * kPointTolerance;
+	default:
+		return true;
+	}
+}
+
+bool ActionFilter::Accept(const Unit* unit, const Command& command,
+	bool queued_command) {
+	// Leave invalid commands to the game
+	if (!unit) {
+		++total_forwarded;
+		return true;
+	}
+	if (queued_command) {
+		// Queued commands add to the orders, a repeat is no longer a no-op
+		last_commands.erase(unit->tag);
+		++total_forwarded;
+		return true;
+	}
+
+	// The unit is already doing this
+	if (MatchesOrder(unit, command)) {
+		++suppressed;
+		++total_suppressed;
+		return false;
+	}
+
+	// Sent recently, the order hasn't been observed yet
+	auto last = last_commands.find(unit->tag);
+	if (last != last_commands.end() && SameCommand(last->second, command) &&
+		game_loop - last->second.game_loop < kRepeatLoops) {
+		++suppressed;
+		++total_suppressed;
+		return false;
+	}
+
+	Command& recorded = last_commands[unit->tag];
+	recorded = command;
+	recorded.game_loop = game_loop;
+	++total_forwarded;
+	return true;
+}
+
+void ActionFilter::UnitCommand(const Unit* unit, AbilityID ability,
+	bool queued_command) {
+	Command command;
+	command.ability = ability;
+	if (Accept(unit, command, queued_command)) {
+		target->UnitCommand(unit, ability, queued_command);
+	}
+}
+
+void ActionFilter::UnitCommand(const Unit* unit, AbilityID ability,
+	const Point2D& point, bool queued_command) {
+	Command command;
+	command.ability = ability;
+	command.target_type = Command::PointTarget;
+	command.point = point;
+	if (Accept(unit, command, queued_command)) {
+		target->UnitCommand(unit, ability, point, queued_command);
+	}
+}
+
+void ActionFilter::UnitCommand(const Unit* unit, AbilityID ability,
+	const Unit* unit_target, bool queued_command) {
+	Command command;
+	command.ability = ability;
+	command.target_type = Command::UnitTarget;
+	command.target_tag = unit_target ? unit_target->tag : 0;
+	if (Accept(unit, command, queued_command)) {
+		target->UnitCommand(unit, ability, unit_target, queued_command);
+	}
+}
+
+void ActionFilter::UnitCommand(const Units& units, AbilityID ability,
+	bool queued_move) {
+	Command command;
+	command.ability = ability;
+	accepted.clear();
+	for (const auto& unit : units) {
+		if (Accept(unit, command, queued_move)) {
+			accepted.push_back(unit);
+		}
+	}
+	if (!accepted.empty()) {
+		target->UnitCommand(accepted, ability, queued_move);
+	}
+}
+
+void ActionFilter::UnitCommand(const Units& units, AbilityID ability,
+	const Point2D& point, bool queued_command) {
+	Command command;
+	command.ability = ability;
+	command.target_type = Command::PointTarget;
+	command.point = point;
+	accepted.clear();
+	for (const auto& unit : units) {
+		if (Accept(unit, command, queued_command)) {
+			accepted.push_back(unit);
+		}
+	}
+	if (!accepted.empty()) {
+		target->UnitCommand(accepted, ability, point, queued_command);
+	}
+}
+
+void ActionFilter::UnitCommand(const Units& units, AbilityID ability,
+	const Unit* unit_target, bool queued_command) {
+	Command command;
+	command.ability = ability;
+	command.target_type = Command::UnitTarget;
+	command.target_tag = unit_target ? unit_target->tag : 0;
+	accepted.clear();
+	for (const auto& unit : units) {
+		if (Accept(unit, command, queued_command)) {
+			accepted.push_back(unit);
+		}
+	}
+	if (!accepted.empty()) {
+		target->UnitCommand(accepted, ability, unit_target, queued_command);
+	}
+}
+
+const std::vector<Tag>& ActionFilter::Commands() const {
+	return target->Commands();
+}
+
+void ActionFilter::ToggleAutocast(Tag unit_tag, AbilityID ability) {
+	target->ToggleAutocast(unit_tag, ability);
+}
+
+void ActionFilter::ToggleAutocast(const std::vector<Tag>& unit_tags,
+	AbilityID ability) {
+	target->ToggleAutocast(unit_tags, ability);
+}
+
+void ActionFilter::SendChat(const std::string& message, ChatChannel channel) {
+	target->SendChat(message, channel);
+}
+
+void ActionFilter::SendActions() {
+	target->SendActions();
+}
@@ -0,0 +1,95 @@
+#ifndef ACTION_FILTER_H_
+#define ACTION_FILTER_H_
+
+#include "sc2api/sc2_interfaces.h"
+#include "sc2api/sc2_unit.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Drops unit commands that would not change what a unit is doing.
+// A command is suppressed when it matches the unit's only current order,
+// or when the same command was sent to the unit in the last few game loops
+// and the game hasn't reported the order yet. Queued commands always go
+// through. Everything else is forwarded to the target interface.
+class ActionFilter : public sc2::ActionInterface {
+public:
+	void SetTarget(sc2::ActionInterface* actions) { target = actions; }
+
+	// Starts counting a new frame. Called at the start of a step.
+	void NewFrame(const sc2::ObservationInterface* obs);
+
+	// Drops the last command of a unit that died
+	void Forget(sc2::Tag tag) { last_commands.erase(tag); }
+
+	// Number of commands suppressed this frame
+	uint32_t Suppressed() const { return suppressed; }
+
+	// Number of commands suppressed since the start of the game
+	uint64_t TotalSuppressed() const { return total_suppressed; }
+
+	// Number of commands forwarded since the start of the game
+	uint64_t TotalForwarded() const { return total_forwarded; }
+
+	void UnitCommand(const sc2::Unit* unit, sc2::AbilityID ability,
+		bool queued_command = false) override;
+	void UnitCommand(const sc2::Unit* unit, sc2::AbilityID ability,
+		const sc2::Point2D& point, bool queued_command = false) override;
+	void UnitCommand(const sc2::Unit* unit, sc2::AbilityID ability,
+		const sc2::Unit* target, bool queued_command = false) override;
+	void UnitCommand(const sc2::Units& units, sc2::AbilityID ability,
+		bool queued_move = false) override;
+	void UnitCommand(const sc2::Units& units, sc2::AbilityID ability,
+		const sc2::Point2D& point, bool queued_command = false) override;
+	void UnitCommand(const sc2::Units& units, sc2::AbilityID ability,
+		const sc2::Unit* target, bool queued_command = false) override;
+	const std::vector<sc2::Tag>& Commands() const override;
+	void ToggleAutocast(sc2::Tag unit_tag, sc2::AbilityID ability) override;
+	void ToggleAutocast(const std::vector<sc2::Tag>& unit_tags,
+		sc2::AbilityID ability) override;
+	void SendChat(const std::string& message,
+		sc2::ChatChannel channel = sc2::ChatChannel::All) override;
+	void SendActions() override;
+
+private:
+	// Game loops a repeated command is held back while its order shows up
+	static const uint32_t kRepeatLoops = 8;
+
+	struct Command {
+		enum TargetType { NoTarget, PointTarget, UnitTarget };
+
+		sc2::AbilityID ability;
+		TargetType target_type = NoTarget;
+		sc2::Point2D point;
+		sc2::Tag target_tag = 0;
+		uint32_t game_loop = 0;
+	};
+
+	// Returns true if the command changes something and records it
+	bool Accept(const sc2::Unit* unit, const Command& command,
+		bool queued_command);
+
+	bool MatchesOrder(const sc2::Unit* unit, const Command& command) const;
+	bool SameCommand(const Command& a, const Command& b) const;
+
+	// Generalized ability (ATTACK_ATTACK -> ATTACK), from the ability data
+	uint32_t Generalize(sc2::AbilityID ability) const;
+
+	sc2::ActionInterface* target = nullptr;
+
+	uint32_t game_loop = 0;
+	std::unordered_map<sc2::Tag, Command> last_commands;
+
+	// remaps[ability] is the generalized ability, empty until loaded
+	std::vector<uint32_t> remaps;
+
+	uint32_t suppressed = 0;
+	uint64_t total_suppressed = 0;
+	uint64_t total_forwarded = 0;
+
+	// Reused for filtered group commands
+	sc2::Units accepted;
+};
+
+#endif
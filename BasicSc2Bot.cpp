@@ -21,6 +21,14 @@ BasicSc2Bot::BasicSc2Bot()
 		ABILITY_ID::BUILD_BUNKER,      ABILITY_ID::BUILD_FACTORY,
 		ABILITY_ID::BUILD_STARPORT,    ABILITY_ID::BUILD_TECHLAB,
 		ABILITY_ID::BUILD_FUSIONCORE,  ABILITY_ID::BUILD_COMMANDCENTER };
+
+	for (const auto& threat : threat_levels) {
+		size_t index = static_cast<size_t>(threat.first);
+		if (index >= threat_by_type.size()) {
+			threat_by_type.resize(index + 1, 0);
+		}
+		threat_by_type[index] = threat.second;
+	}
 }
 
 // =================================================================================
@@ -131,7 +139,7 @@ void BasicSc2Bot::Debugging() {
 	sc2::DebugInterface* debug = Debug();
 
 	Units scvs_building =
-		obs->GetUnits(Unit::Alliance::Self, [this](const Unit& unit) {
+		Index().GetUnits(Unit::Alliance::Self, [this](const Unit& unit) {
 		return unit.unit_type == UNIT_TYPEID::TERRAN_SCV &&
 			!unit.orders.empty() && IsBuildingOrder(unit.orders.front());
 			});
@@ -166,14 +174,17 @@ void BasicSc2Bot::Debugging() {
 	// buildable map
 	/*if (current_gameloop % 100)
 	{
-		for (const auto& i : build_map[0])
+		for (int y = build_map[0].Min().y; y <= build_map[0].Max().y; ++y)
 		{
-			if (!i.second)
+			for (int x = build_map[0].Min().x; x <= build_map[0].Max().x; ++x)
 			{
-				continue;
+				if (!build_map[0].IsBuildable(x, y))
+				{
+					continue;
+				}
+				DrawBoxAtLocation(debug, Point3D(x + 0.5f, y + 0.5f,
+	height_at_float(Point2DI(x, y)) + 0.1f), 1.0f, sc2::Colors::Green);
 			}
-			DrawBoxAtLocation(debug, Point3D(i.first.x + 0.5f, i.first.y + 0.5f,
-	height_at_float(i.first) + 0.1f), 1.0f, sc2::Colors::Green);
 		}
 	}*/
 
@@ -211,6 +222,7 @@ void BasicSc2Bot::Debugging() {
 
 // Start the bot
 void BasicSc2Bot::on_start() {
+	PROFILE_SCOPE("on_start");
 	// Initialize start locations, expansion locations, chokepoints, etc.
 	const ObservationInterface* obs = Observation();
 	start_location = obs->GetStartLocation();
@@ -218,7 +230,6 @@ void BasicSc2Bot::on_start() {
 	if (!enemy_start_locations.empty()) {
 		enemy_start_location = enemy_start_locations[0];
 	}
-	expansion_locations = search::CalculateExpansionLocations(obs, Query());
 	retreat_location = { start_location.x + 5.0f, start_location.y };
 
 	// Get map dimensions for corner coordinates
@@ -236,15 +247,80 @@ void BasicSc2Bot::on_start() {
 
 	// find ramps
 	base_location = GetBaseLocation();
-	find_right_ramp(start_location);
-	find_ramps_build_map(false);
-	update_build_map(true);
-	auto mineral_points = get_close_mineral_points(start_location);
-	main_mineral_convexHull = convexHull(mineral_points);
+
+	// the map analysis only depends on the map and our start location. It
+	// was started in OnGameStart, from the cache if this map was played
+	// before.
+	if (!scout_grid.valid()) {
+		start_map_analysis();
+	}
+	if (map_analysis_cached) {
+		MapAnalysis& analysis = cached_analysis;
+		terrain_height.Reset(game_info);
+		expansion_locations = std::move(analysis.expansion_locations);
+		ramps = std::move(analysis.ramps);
+		mainBase_depot_points = std::move(analysis.main_base_depot_points);
+		mainBase_barrack_point = analysis.main_base_barrack_point;
+		build_map = std::move(analysis.build_map);
+		build_map_minmax = { build_map[0].Min(), build_map[0].Max() };
+		main_mineral_convexHull =
+			std::move(analysis.main_mineral_convex_hull);
+		map_regions = std::move(analysis.regions);
+	}
+	else {
+		// the expansion search queries the game, so it stays on this thread
+		expansion_locations =
+			search::CalculateExpansionLocations(obs, Query());
+		MapLayout layout = map_layout.get();
+		terrain_height = std::move(layout.terrain_height);
+		ramps = std::move(layout.ramps);
+		build_map = std::move(layout.build_map);
+		build_map_minmax = { build_map[0].Min(), build_map[0].Max() };
+		map_regions = std::move(layout.regions);
+		find_right_ramp(start_location);
+		auto mineral_points = get_close_mineral_points(start_location);
+		main_mineral_convexHull = convexHull(mineral_points);
+
+		if (map_cache.Enabled()) {
+			MapAnalysis analysis;
+			analysis.expansion_locations = expansion_locations;
+			analysis.ramps = ramps;
+			analysis.main_base_depot_points = mainBase_depot_points;
+			analysis.main_base_barrack_point = mainBase_barrack_point;
+			analysis.build_map = build_map;
+			analysis.main_mineral_convex_hull = main_mineral_convexHull;
+			analysis.regions = map_regions;
+			if (!map_cache.Save(game_info, start_location, analysis)) {
+				std::cout << "Could not write the map cache to "
+					<< map_cache.Path(game_info, start_location) << std::endl;
+			}
+		}
+	}
+	// stamp the structures we start with, later ones are stamped as they
+	// are placed
+	build_map_terrain = build_map[0];
+	structure_stamps.clear();
+	build_reservations.clear();
+	lifted_structures.clear();
+	for (const auto& structure : Index().GetUnits(Unit::Alliance::Self)) {
+		if (IsFriendlyStructure(*structure)) {
+			stamp_structure(structure);
+		}
+	}
+
+	// ground distance fields of the locations most decisions measure from,
+	// the expansions are spread over the next frames
+	Ground().Field(start_location);
+	Ground().Field(enemy_start_location);
+	for (const auto& expansion : expansion_locations) {
+		Ground().Prepare(expansion);
+	}
+	plan_build_slots();
+	ClassifyBattlecruiserTargets();
 
 	// Initialize base
-	Units command_centers = obs->GetUnits(
-		Unit::Alliance::Self, IsUnit(UNIT_TYPEID::TERRAN_COMMANDCENTER));
+	Units command_centers = Index().GetUnits(
+		Unit::Alliance::Self, UNIT_TYPEID::TERRAN_COMMANDCENTER);
 	if (!command_centers.empty()) {
 		bases.emplace_back(command_centers.front());
 	}
@@ -274,28 +350,16 @@ void BasicSc2Bot::on_start() {
 		}
 	}
 
-	// Get map dimensions
-	unsigned int width = game_info.width;
-	unsigned int height = game_info.height;
-
-	// Generate grid points across the entire map for scouting
-	scout_points.clear(); // Clear previous scout points if any
-	const unsigned int step_size =
-		15; // Step size for grid points (adjust for thoroughness)
-	for (unsigned int x = 0; x < width; x += step_size) {
-		for (unsigned int y = 0; y < height; y += step_size) {
-			Point2D grid_point(static_cast<float>(x), static_cast<float>(y));
-			if (obs->IsPathable(grid_point)) {
-				scout_points.emplace_back(grid_point);
-			}
-		}
-	}
+	// Scout points were generated in OnGameStart
+	scout_points = scout_grid.get();
 
 	// Start scouting from the beginning
 	clean_up_index = 0;
 }
 
 void BasicSc2Bot::OnGameStart() {
+	// overlap the map analysis with the first frames, see on_start
+	start_map_analysis();
 	//
 	/*Debug()->DebugIgnoreResourceCost();
 	Debug()->DebugFastBuild();
@@ -330,13 +394,249 @@ void BasicSc2Bot::OnGameEnd() {
 			<< playerTypes[((*(players[playerResult.player_id])).player_type)]
 			<< gameResults[playerResult.result] << std::endl;
 	}
+
+	// Print how often the unit index saved a full observation scan
+	std::cout << "UnitIndex: " << unit_index.Rebuilds() << " rebuilds, "
+		<< unit_index.ScansAvoided() << " GetUnits scans avoided"
+		<< std::endl;
+
+	// Print how many redundant unit commands were never sent
+	std::cout << "ActionFilter: " << action_filter.TotalSuppressed()
+		<< " of " << action_filter.TotalSuppressed() +
+		action_filter.TotalForwarded() << " unit commands suppressed"
+		<< std::endl;
+	std::cout << "ActionBuffer: " << action_buffer.TotalCommands()
+		<< " unit commands sent as " << action_buffer.TotalGroups()
+		<< " commands" << std::endl;
+
+	// Print where the step time went
+	PROFILE_REPORT(std::cout);
+
+	recorder.Close();
+	TraceWriter::Get().Close();
+}
+
+const ObservationInterface* BasicSc2Bot::Observation() const {
+	return observation_override ? observation_override : Agent::Observation();
+}
+
+ActionInterface* BasicSc2Bot::Actions() {
+	ActionInterface* actions =
+		actions_override ? actions_override : Agent::Actions();
+	if (TraceWriter::Get().IsOpen()) {
+		traced_actions.SetTarget(actions);
+		actions = &traced_actions;
+	}
+	action_buffer.SetTarget(actions);
+	action_filter.SetTarget(&action_buffer);
+	return &action_filter;
+}
+
+QueryInterface* BasicSc2Bot::Query() {
+	QueryInterface* query = query_override ? query_override : Agent::Query();
+	if (TraceWriter::Get().IsOpen()) {
+		traced_query.SetTarget(query);
+		return &traced_query;
+	}
+	return query;
+}
+
+DebugInterface* BasicSc2Bot::Debug() {
+	return debug_override ? debug_override : Agent::Debug();
+}
+
+void BasicSc2Bot::SetInterfaces(const ObservationInterface* observation,
+	ActionInterface* actions, QueryInterface* query, DebugInterface* debug) {
+	observation_override = observation;
+	actions_override = actions;
+	query_override = query;
+	debug_override = debug;
+}
+
+// Returns the unit index, rebuilding it first if the game loop advanced
+const UnitIndex& BasicSc2Bot::Index() const {
+	unit_index.Update(Observation());
+	return unit_index;
+}
+
+// Returns the enemy grid, rebuilding it first if the game loop advanced
+const SpatialGrid& BasicSc2Bot::EnemyGrid() const {
+	const UnitIndex& index = Index();
+	if (!enemy_grid.Initialized()) {
+		const GameInfo& game_info = Observation()->GetGameInfo();
+		enemy_grid.Reset(game_info.playable_min, game_info.playable_max);
+	}
+	else if (enemy_grid.GameLoop() == index.GameLoop()) {
+		return enemy_grid;
+	}
+	enemy_grid.Build(index.GetUnits(Unit::Alliance::Enemy), index.GameLoop());
+	return enemy_grid;
+}
+
+// Walks the footprints of the structures on the ground
+void BasicSc2Bot::ForEachFootprint(bool stamp_lowered_depots,
+	const std::function<void(const Point2D&)>& mineral,
+	const std::function<void(const Point2D&, float)>& stamp) const {
+	const UnitIndex& index = Index();
+	const UnitTypes& unit_types = Observation()->GetUnitTypeData();
+	for (const auto alliance : { Unit::Alliance::Self, Unit::Alliance::Enemy,
+		Unit::Alliance::Neutral }) {
+		for (const auto& unit : index.GetUnits(alliance)) {
+			if (unit->is_flying || (!stamp_lowered_depots &&
+				unit->unit_type == UNIT_TYPEID::TERRAN_SUPPLYDEPOTLOWERED)) {
+				continue;
+			}
+			if (IsMineralPatch()(*unit)) {
+				mineral(unit->pos);
+				continue;
+			}
+			auto footprint = footprint_r.find(unit->unit_type);
+			if (footprint != footprint_r.end()) {
+				if (unit->unit_type != UNIT_TYPEID::TERRAN_SCV) {
+					stamp(unit->pos, footprint->second);
+				}
+				continue;
+			}
+			if (unit->unit_type >= unit_types.size()) {
+				continue;
+			}
+			const auto& attributes = unit_types[unit->unit_type].attributes;
+			if (std::find(attributes.begin(), attributes.end(),
+				Attribute::Structure) != attributes.end()) {
+				// Footprints are whole cells, a bit smaller than the radius
+				stamp(unit->pos, std::floor(unit->radius * 2.0f) / 2.0f);
+			}
+		}
+	}
+}
+
+// Returns the placement grid, restamping it first if the game loop advanced
+const PlacementGrid& BasicSc2Bot::PlacementMap() const {
+	const UnitIndex& index = Index();
+	if (!placement_grid.Initialized()) {
+		placement_grid.Reset(Observation()->GetGameInfo());
+	}
+	else if (placement_grid.GameLoop() == index.GameLoop()) {
+		return placement_grid;
+	}
+	placement_grid.Clear(index.GameLoop());
+
+	// Stamp every structure on the ground, lifted buildings free their cells
+	ForEachFootprint(true,
+		[this](const Point2D& pos) { placement_grid.StampMineral(pos); },
+		[this](const Point2D& pos, float radius) {
+			placement_grid.Stamp(pos, radius);
+		});
+
+	// Keep the paths between our town halls and their resources clear
+	for (const auto& town_hall : index.GetTownHalls(Unit::Alliance::Self)) {
+		for (const auto& resource : index.GetUnits(Unit::Alliance::Neutral)) {
+			if ((IsMineralPatch()(*resource) || IsGeyser()(*resource)) &&
+				DistanceSquared2D(resource->pos, town_hall->pos) < 100.0f) {
+				placement_grid.StampLane(town_hall->pos, resource->pos, 1.0f);
+			}
+		}
+	}
+	return placement_grid;
+}
+
+GroundDistances& BasicSc2Bot::Ground() const {
+	const UnitIndex& index = Index();
+	if (!ground_distances.Initialized()) {
+		ground_distances.Reset(Observation()->GetGameInfo());
+	}
+	else if (ground_distances.GameLoop() == index.GameLoop()) {
+		return ground_distances;
+	}
+	ground_distances.Clear(index.GameLoop());
+
+	// Stamp every structure on the ground, lowered depots can be walked over
+	ForEachFootprint(false,
+		[this](const Point2D& pos) { ground_distances.StampMineral(pos); },
+		[this](const Point2D& pos, float radius) {
+			ground_distances.Stamp(pos, radius);
+		});
+	ground_distances.Apply();
+	ground_distances.PrepareNext();
+	return ground_distances;
+}
+
+// Returns the danger field, rebuilding it first if the game loop advanced
+const DangerField& BasicSc2Bot::Danger() const {
+	const UnitIndex& index = Index();
+	if (!danger_field.Initialized()) {
+		danger_field.Reset(Observation()->GetGameInfo());
+	}
+	else if (danger_field.GameLoop() == index.GameLoop()) {
+		return danger_field;
+	}
+	// Past the safe radius of retreating workers
+	const float reach = 20.0f;
+	danger_field.Build(index.GetUnits(Unit::Alliance::Enemy), reach,
+		index.GameLoop());
+	return danger_field;
+}
+
+// Returns the anti-air threat, resplatting it first if the game loop advanced
+const InfluenceGrid& BasicSc2Bot::AirThreat() const {
+	const UnitIndex& index = Index();
+	if (!air_threat.Initialized()) {
+		const GameInfo& game_info = Observation()->GetGameInfo();
+		air_threat.Reset(game_info.width, game_info.height);
+	}
+	else if (air_threat.GameLoop() == index.GameLoop()) {
+		return air_threat;
+	}
+	air_threat.Clear(index.GameLoop());
+
+	// Full weight where an enemy can shoot or will after closing in a bit,
+	// fading out over a few more cells. Types without an air weapon in the
+	// type data (carriers, tests) get a typical range.
+	const float default_range = 6.0f;
+	const float approach = 3.0f;
+	const float falloff = 3.0f;
+	const UnitTypes& unit_types = Observation()->GetUnitTypeData();
+	for (const auto& enemy : index.GetUnits(Unit::Alliance::Enemy)) {
+		int weight = ThreatLevel(enemy->unit_type);
+		if (weight == 0 || !enemy->is_alive) {
+			continue;
+		}
+		float range = 0.0f;
+		if (enemy->unit_type < unit_types.size()) {
+			for (const auto& weapon : unit_types[enemy->unit_type].weapons) {
+				if (weapon.type != Weapon::TargetType::Ground) {
+					range = std::max(range, weapon.range);
+				}
+			}
+		}
+		if (range == 0.0f) {
+			range = default_range;
+		}
+		float reach = range + enemy->radius + approach;
+		air_threat.Splat(enemy->pos, static_cast<float>(weight), reach,
+			reach + falloff);
+	}
+	return air_threat;
+}
+
+float BasicSc2Bot::GroundDistance(const Point2D& from,
+	const Point2D& to) const {
+	float distance = Ground().Distance(from, to);
+	return distance < 0.0f ? Distance2D(from, to) : distance;
 }
 
 // Main game loop
 void BasicSc2Bot::OnStep() {
+	TraceWriter::Get().BeginFrame(Observation()->GetGameLoop());
+	PROFILE_SCOPE("OnStep");
 	++step_counter;
+	// Snapshot all units once for this frame
+	unit_index.Update(Observation());
+	action_filter.NewFrame(Observation());
+	recorder.Record(Observation());
 	// Wait for 10 frames
 	if (step_counter < 10) {
+		action_buffer.Flush();
 		return;
 	}
 	// On 10th frame, redo our init
@@ -348,6 +648,7 @@ void BasicSc2Bot::OnStep() {
 		BasicSc2Bot::Debugging();*/
 
 	if (step_counter > 10) {
+		BasicSc2Bot::update_build_map();
 		BasicSc2Bot::depot_control();
 		BasicSc2Bot::ManageEconomy();
 		BasicSc2Bot::ExecuteBuildOrder();
@@ -356,6 +657,8 @@ void BasicSc2Bot::OnStep() {
 		BasicSc2Bot::Defense();
 		BasicSc2Bot::Offense();
 	}
+	// Send the frame's commands, merged into group commands
+	action_buffer.Flush();
 }
 
 void BasicSc2Bot::OnUnitIdle(const Unit* unit) {
@@ -422,6 +725,11 @@ void BasicSc2Bot::OnUnitCreated(const Unit* unit) {
 		return;
 	}
 
+	// Structure placed
+	if (IsFriendlyStructure(*unit)) {
+		stamp_structure(unit);
+	}
+
 	// SCV created
 	if (unit->unit_type == UNIT_TYPEID::TERRAN_SCV) {
 		++num_scvs;
@@ -458,8 +766,9 @@ void BasicSc2Bot::OnUnitCreated(const Unit* unit) {
 }
 
 void BasicSc2Bot::OnBuildingConstructionComplete(const Unit* unit) {
-	const ObservationInterface* obs = Observation();
-	update_build_map(true);
+	if (IsFriendlyStructure(*unit)) {
+		stamp_structure(unit);
+	}
 	std::vector<uint32_t> minsec = GetRealTime();
 	auto unit_type = unit->unit_type.ToType();
 
@@ -484,10 +793,8 @@ void BasicSc2Bot::OnBuildingConstructionComplete(const Unit* unit) {
 	}
 
 	if (unit->unit_type == UNIT_TYPEID::TERRAN_REFINERY) {
-		const ObservationInterface* obs = Observation();
-
 		// Get all SCVs that are free
-		Units scvs = obs->GetUnits(Unit::Alliance::Self, [](const Unit& unit) {
+		Units scvs = Index().GetUnits(Unit::Alliance::Self, [](const Unit& unit) {
 			return unit.unit_type == UNIT_TYPEID::TERRAN_SCV &&
 				!unit.orders.empty() &&
 				unit.orders.front().ability_id == ABILITY_ID::HARVEST_GATHER;
@@ -516,8 +823,8 @@ void BasicSc2Bot::OnBuildingConstructionComplete(const Unit* unit) {
 
 		// Barracks completed
 		if (unit->unit_type == UNIT_TYPEID::TERRAN_BARRACKS) {
-			Units barracks = obs->GetUnits(
-				Unit::Alliance::Self, IsUnit(UNIT_TYPEID::TERRAN_BARRACKS));
+			Units barracks = Index().GetUnits(
+				Unit::Alliance::Self, UNIT_TYPEID::TERRAN_BARRACKS);
 			/*const Unit* b = !barracks.empty() ? barracks.front() : nullptr;
 			ramp_middle[0] = const_cast<sc2::Unit*>(unit);*/
 			if (CanBuild(50, 25)) {
@@ -530,8 +837,8 @@ void BasicSc2Bot::OnBuildingConstructionComplete(const Unit* unit) {
 		}
 		else if (unit->unit_type == UNIT_TYPEID::TERRAN_BARRACKSTECHLAB) {
 			Units techlab =
-				obs->GetUnits(Unit::Alliance::Self,
-					IsUnit(UNIT_TYPEID::TERRAN_BARRACKSTECHLAB));
+				Index().GetUnits(
+					Unit::Alliance::Self, UNIT_TYPEID::TERRAN_BARRACKSTECHLAB);
 			const Unit* t = !techlab.empty() ? techlab.front() : nullptr;
 			ramp_middle[1] = const_cast<sc2::Unit*>(t);
 			++phase;
@@ -540,10 +847,10 @@ void BasicSc2Bot::OnBuildingConstructionComplete(const Unit* unit) {
 	else if (phase == 1) {
 
 		if (unit->unit_type == UNIT_TYPEID::TERRAN_FACTORY) {
-			Units factories = obs->GetUnits(
-				Unit::Alliance::Self, IsUnit(UNIT_TYPEID::TERRAN_FACTORY));
-			Units barracks = obs->GetUnits(
-				Unit::Alliance::Self, IsUnit(UNIT_TYPEID::TERRAN_BARRACKS));
+			Units factories = Index().GetUnits(
+				Unit::Alliance::Self, UNIT_TYPEID::TERRAN_FACTORY);
+			Units barracks = Index().GetUnits(
+				Unit::Alliance::Self, UNIT_TYPEID::TERRAN_BARRACKS);
 
 			if (barracks.empty())
 				return;
@@ -573,9 +880,14 @@ void BasicSc2Bot::OnUpgradeCompleted(UpgradeID upgrade_id) {
 }
 
 void BasicSc2Bot::OnUnitDestroyed(const Unit* unit) {
+	recorder.UnitDestroyed(unit->tag);
+	action_filter.Forget(unit->tag);
+	// Free its footprint, or the site it was on its way to build
+	unstamp_structure(unit->tag);
+	lifted_structures.erase(unit->tag);
+	release_build_map(unit->tag);
 	// Update unit counts and remove destroyed units from the game state
 	if (IsFriendlyStructure(*unit)) {
-		update_build_map(false, unit);
 		// TODO: make sure if ramp_depots[1] becomes ramp_depots[0] when
 		// ramp_depots[0] is destroyed,
 		if (unit == ramp_depots[0]) {
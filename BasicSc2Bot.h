@@ -11,6 +11,30 @@
 #include "sc2utils/sc2_arg_parser.h"
 #include "sc2utils/sc2_manage_process.h"
 
+#include "ActionBuffer.h"
+#include "ActionFilter.h"
+#include "BitGrid.h"
+#include "BuildMap.h"
+#include "BuildSlots.h"
+#include "DangerField.h"
+#include "DistanceField.h"
+#include "FocusFire.h"
+#include "GridComponents.h"
+#include "HeightGrid.h"
+#include "InfluenceGrid.h"
+#include "MapCache.h"
+#include "PlacementGrid.h"
+#include "Profiler.h"
+#include "Recording.h"
+#include "RegionGraph.h"
+#include "SpatialGrid.h"
+#include "Tracing.h"
+#include "UnitIndex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <future>
 #include <iostream>
 #include <map>
 #include <string>
@@ -43,7 +67,42 @@ public:
 	virtual void OnUnitDestroyed(const Unit* unit) final;
 	virtual void OnUnitEnterVision(const Unit* unit) final;
 
+	// Game interfaces. These hide the sc2::Client accessors so the replay
+	// bench can drive the bot without a running game. Actions() drops
+	// redundant unit commands and merges the rest into group commands sent
+	// at the end of the step. While a trace is open Actions() and Query()
+	// also time every call.
+	const ObservationInterface* Observation() const;
+	ActionInterface* Actions();
+	QueryInterface* Query();
+	DebugInterface* Debug();
+
+	// Replaces the game interfaces with the given implementations
+	void SetInterfaces(const ObservationInterface* observation,
+		ActionInterface* actions, QueryInterface* query,
+		DebugInterface* debug);
+
+	// Records every observation when opened, see LadderInterface.h
+	FrameRecorder& Recorder() { return recorder; }
+
+	// Keeps the startup map analysis between games when a directory is set
+	MapCache& AnalysisCache() { return map_cache; }
+
 private:
+	// Interfaces set by SetInterfaces(), null when playing a live game
+	const ObservationInterface* observation_override = nullptr;
+	ActionInterface* actions_override = nullptr;
+	QueryInterface* query_override = nullptr;
+	DebugInterface* debug_override = nullptr;
+
+	ActionFilter action_filter;
+	ActionBuffer action_buffer;
+	TracedActions traced_actions;
+	TracedQuery traced_query;
+
+	FrameRecorder recorder;
+	MapCache map_cache;
+
 	// =========================
 	// Debugging
 	// =========================
@@ -55,13 +114,86 @@ private:
 		const sc2::Point3D& location, float size,
 		const sc2::Color& color = sc2::Colors::Red) const;
 
-	uint32_t current_gameloop;
+	uint32_t current_gameloop = 0;
 	uint32_t last_gameloop;
 
 	uint32_t step_counter;
 
 	void on_start();
 
+	// Per-frame snapshot of all units, bucketed by alliance and type
+	mutable UnitIndex unit_index;
+
+	// Returns the unit index, rebuilding it first if the game loop advanced
+	const UnitIndex& Index() const;
+
+	// Enemy units bucketed by position, rebuilt once per frame
+	mutable SpatialGrid enemy_grid;
+
+	// Returns the enemy grid, rebuilding it first if the game loop advanced
+	const SpatialGrid& EnemyGrid() const;
+
+	// Calls mineral for every mineral patch and stamp for the footprint of
+	// every other structure on the ground, as a center and half width.
+	// Lowered depots are skipped unless stamp_lowered_depots is set.
+	void ForEachFootprint(bool stamp_lowered_depots,
+		const std::function<void(const Point2D&)>& mineral,
+		const std::function<void(const Point2D&, float)>& stamp) const;
+
+	// Placeable cells minus known structures and mining lanes, restamped
+	// once per frame
+	mutable PlacementGrid placement_grid;
+
+	// Returns the placement grid, restamping it first if the game loop
+	// advanced
+	const PlacementGrid& PlacementMap() const;
+
+	// Pathing grid minus structures on the ground with distance fields from
+	// key locations, restamped once per frame
+	mutable GroundDistances ground_distances;
+
+	// Returns the ground distances, restamping them first if the game loop
+	// advanced
+	GroundDistances& Ground() const;
+
+	// Distance from every cell to the closest enemy for retreating workers,
+	// rebuilt once per frame
+	mutable DangerField danger_field;
+
+	// Returns the danger field, rebuilding it first if the game loop
+	// advanced
+	const DangerField& Danger() const;
+
+	// Anti-air weight of the enemies over the cells they can shoot at or
+	// will be able to shortly, resplatted once per frame
+	mutable InfluenceGrid air_threat;
+
+	// Returns the anti-air threat, resplatting it first if the game loop
+	// advanced
+	const InfluenceGrid& AirThreat() const;
+
+	// Weight of the unit type in threat_levels, 0 if it can't shoot up
+	int ThreatLevel(UNIT_TYPEID type) const {
+		size_t index = static_cast<size_t>(type);
+		return index < threat_by_type.size() ? threat_by_type[index] : 0;
+	}
+
+	// Ground distance from a key location (start, enemy start, expansions,
+	// rally points) to a point. Falls back to the straight line when there
+	// is no ground path, like for units across water.
+	float GroundDistance(const Point2D& from, const Point2D& to) const;
+
+	// Structure built by the ability, INVALID if it doesn't build one
+	UNIT_TYPEID BuildStructure(ABILITY_ID ability) const;
+
+	// Footprint radius of the structure built by the ability, 0 if unknown
+	float BuildFootprint(ABILITY_ID ability) const;
+
+	// Orders the builder to build at location and reserves the footprint in
+	// the build map until the structure is placed or the order is dropped
+	void OrderBuild(const Unit* builder, AbilityID ability,
+		const Point2D& location, bool queued_command = false);
+
 	// =========================
 	// Economy Management
 	// =========================
@@ -308,6 +440,13 @@ private:
 	// Controls Battlecruisers to target enemy units
 	void TargetBattlecruisers();
 
+	// Fills battlecruiser_target_by_type from the unit type data
+	void ClassifyBattlecruiserTargets();
+
+	// Targeting priority of every unit type for Battlecruisers, lower
+	// first, with turrets ranked as if they were avoided
+	std::vector<uint8_t> battlecruiser_target_by_type;
+
 	// Calculate the Kite Vector for a unit
 	Point2D GetKiteVector(const Unit* unit, const Unit* target);
 
@@ -358,8 +497,11 @@ private:
 	void KiteMarine(const Unit* marine, const Unit* target, bool advance,
 		float distance);
 
+	// Spreads the Marines' shots over the enemies in their range
+	FocusFire marine_focus_fire;
+
 	// SCV that is building
-	const sc2::Unit* scv_building;
+	const sc2::Unit* scv_building = nullptr;
 	// SCV that is scouting
 	const sc2::Unit* scv_scout;
 
@@ -458,6 +600,11 @@ private:
 		UNIT_TYPEID unit_type,
 		const Point2D& location);
 
+	// Validates all candidates in one placement request and returns the
+	// index of the first valid one, or -1 if none is.
+	int FirstValidPlacement(
+		const std::vector<QueryInterface::PlacementQuery>& candidates);
+
 	Point2D GetRallyPoint();
 
 	void SetRallyPoint(const Unit* b, const Point2D& p);
@@ -506,12 +653,6 @@ private:
 	// MapInfo (Ramp, build_map, etc)
 	// =========================
 
-	struct Point2DComparator {
-		bool operator()(const Point2D& lhs, const Point2D& rhs) const {
-			return lhs.x < rhs.x || (lhs.x == rhs.x && lhs.y < rhs.y);
-		}
-	};
-
 	enum class BaseLocation {
 		lefttop, righttop, leftbottom, rightbottom
 	};
@@ -531,17 +672,68 @@ private:
 		find_terret_location_btw(std::vector<Point2D>& mineral_patches,
 			Point2D& townhall);
 
-	void update_build_map(const bool built,
-		const Unit* destroyed_building = nullptr);
+	// Cells a structure covers in the build map
+	struct BuildMapStamp {
+		int x = 0;
+		int y = 0;
+		int w = 0;
+		int h = 0;
+
+		bool operator==(const BuildMapStamp& other) const {
+			return x == other.x && y == other.y && w == other.w &&
+				h == other.h;
+		}
+		bool Overlaps(const BuildMapStamp& other) const {
+			return x < other.x + other.w && other.x < x + w &&
+				y < other.y + other.h && other.y < y + h;
+		}
+	};
+
+	// A builder walking to its build site
+	struct BuildReservation {
+		BuildMapStamp stamp;
+		ABILITY_ID ability;
+		Point2D location;
+		uint32_t game_loop;
+	};
+
+	// Footprint of a structure of the type at pos, false for types that
+	// aren't stamped
+	static bool build_map_stamp(UNIT_TYPEID type, const Point2D& pos,
+		BuildMapStamp& stamp);
+
+	// Stamps the structure's footprint, moving it if it was stamped
+	// somewhere else before
+	void stamp_structure(const Unit* structure);
+
+	// Frees the footprint of a destroyed or lifted structure
+	void unstamp_structure(Tag tag);
+
+	// Reserves the footprint of the structure the builder was ordered to
+	// build, replacing the builder's earlier reservation
+	void reserve_build_map(const Unit* builder, ABILITY_ID ability,
+		const Point2D& location);
+
+	// Drops the builder's reservation
+	void release_build_map(Tag builder);
+
+	// Puts the original cells back under a freed footprint and stamps the
+	// footprints overlapping it again
+	void free_build_map(const BuildMapStamp& stamp);
+
+	// Follows lifted and landed structures and drops the reservations of
+	// builders that no longer have their build order, once per frame
+	void update_build_map();
+
+	// Compares the build map against one rebuilt from scratch, see
+	// UEDBOT_CHECK_BUILD_MAP
+	bool check_build_map() const;
 
 	float cross_product(const Point2D& O, const Point2D& A,
 		const Point2D& B) const;
 
 	Point2D Point2D_mean(const std::vector<Point2D>& points) const;
 
-	Point2D Point2D_mean(
-		const std::map<Point2D, bool, Point2DComparator>& map_points) const;
-
 	std::vector<Point2D> convexHull(std::vector<Point2D>& points) const;
 
 	std::vector<Point2D> circle_intersection(const Point2D& p1,
@@ -549,14 +741,41 @@ private:
 
 	Point2D towards(const Point2D& p1, const Point2D& p2, float distance) const;
 
-	int height_at(const Point2DI& p) const;
+	// terrain height, decoded once in on_start
+	HeightGrid terrain_height;
+
+	int height_at(const Point2DI& p) const {
+		return terrain_height.Level(p.x, p.y);
+	}
+
+	float height_at_float(const Point2DI& p) const {
+		return terrain_height.Height(p.x, p.y);
+	}
+
+	// Map analysis that only reads the map. It runs on worker threads from
+	// OnGameStart, over a copy of the game info, while the first frames
+	// play; on_start waits for it and applies it.
+	struct MapLayout {
+		HeightGrid terrain_height;
+		std::vector<std::vector<Point2D>> ramps;
+		std::vector<BuildMap> build_map;
+		RegionGraph regions;
+	};
 
-	float height_at_float(const Point2DI& p) const;
+	static MapLayout find_ramps_build_map(const GameInfo& game_info,
+		const Point2D& start);
 
-	void find_ramps_build_map(bool isRamp);
+	static std::vector<Point2D> find_scout_points(const GameInfo& game_info);
 
-	void find_groups(std::vector<Point2D>& points, int minimum_points_per_group,
-		int max_distance_between_points);
+	// Loads the cached analysis or starts the workers
+	void start_map_analysis();
+
+	GameInfo map_snapshot;
+	Point2D map_snapshot_start;
+	bool map_analysis_cached = false;
+	MapAnalysis cached_analysis;
+	std::future<MapLayout> map_layout;
+	std::future<std::vector<Point2D>> scout_grid;
 
 	std::vector<Point2D> upper_lower(const std::vector<Point2D>& points,
 		bool up) const;
@@ -582,12 +801,13 @@ private:
 		barracks_correct_placement(const std::vector<Point2D>& ramp_points,
 			const std::vector<Point2D>& corner_depots) const;
 
-	bool area33_check(const Point2D& b, const bool addon);
+	// lay the 3x3 slots over the main base, see BuildSlots.h
+	void plan_build_slots();
 
+	// build a 3x3 structure in the best open slot, with room for an addon
+	// if addon is true
 	bool build33_after_check(const Unit* builder,
-		const AbilityID& build_ability,
-		const BasicSc2Bot::BaseLocation whereismybase,
-		const bool addon);
+		const AbilityID& build_ability, const bool addon);
 
 	bool depot_area_check(const Unit* builder, const AbilityID& build_ability,
 		BasicSc2Bot::BaseLocation whereismybase);
@@ -599,11 +819,11 @@ private:
 	// Count units in combat
 	int UnitsInCombat(UNIT_TYPEID unit_type);
 
-	// Calculates the threat level of enemy units
-	int CalculateThreatLevel(const Unit* unit);
+	// Anti-air threat at the unit's position
+	float CalculateThreatLevel(const Unit* unit);
 
-	// Get the closest threat to a unit
-	const Unit* GetClosestThreat(const Unit* unit);
+	// Get the closest threat to a unit within max_distance
+	const Unit* GetClosestThreat(const Unit* unit, float max_distance);
 
 	// =========================
 	// Member Variables
@@ -632,8 +852,26 @@ private:
 	std::vector<sc2::Point2D> main_mineral_convexHull;
 	std::vector<sc2::Point2D> main_base_terret_locations;
 
-	// buildable map
-	std::vector<std::map<Point2D, bool, Point2DComparator>> build_map;
+	// buildable regions, closest to the start location first
+	std::vector<BuildMap> build_map;
+
+	// build_map[0] before anything was stamped on it
+	BuildMap build_map_terrain;
+
+	// footprints stamped in build_map[0] by our structures, reserved by
+	// builders on their way, and structures lifted off their footprint
+	std::unordered_map<Tag, BuildMapStamp> structure_stamps;
+	std::unordered_map<Tag, BuildReservation> build_reservations;
+	std::unordered_set<Tag> lifted_structures;
+
+	// where the 3x3 structures go in build_map[0]
+	BuildSlots build_slots;
+
+	// first depot candidate the next depot_area_check confirms with the game
+	size_t depot_candidate_offset = 0;
+
+	// open regions of the map and the chokes between them
+	RegionGraph map_regions;
 
 	// map for buildings in progress
 	// it is used to check if the building is under construction after 1 or 2
@@ -713,6 +951,9 @@ private:
 		{sc2::UNIT_TYPEID::ZERG_CORRUPTOR, 4},
 		{sc2::UNIT_TYPEID::ZERG_SPORECRAWLER, 3} };
 
+	// threat_levels indexed by unit type
+	std::vector<int> threat_by_type;
+
 	bool IsFriendlyStructure(const Unit& unit) const {
 		switch (unit.unit_type.ToType()) {
 		case UNIT_TYPEID::TERRAN_SUPPLYDEPOT:
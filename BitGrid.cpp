@@ -0,0 +1,146 @@
+#include "BitGrid.h"
+
+#include <algorithm>
+
+using namespace sc2;
+
+namespace {
+
+// Bits of every byte in reverse order, map grids store the leftmost cell
+// of a byte in its highest bit
+struct ReversedBytes {
+	uint8_t bytes[256];
+
+	ReversedBytes() {
+		for (int i = 0; i < 256; ++i) {
+			uint8_t reversed = 0;
+			for (int bit = 0; bit < 8; ++bit) {
+				if (i & (1 << bit)) {
+					reversed |= static_cast<uint8_t>(0x80 >> bit);
+				}
+			}
+			bytes[i] = reversed;
+		}
+	}
+};
+
+const ReversedBytes kReversed;
+
+// Bits [from, to) of a word set, from and to within [0, 64]
+uint64_t BitRange(int from, int to) {
+	if (from >= to) {
+		return 0;
+	}
+	uint64_t below_to = to >= 64 ? ~uint64_t(0) : (uint64_t(1) << to) - 1;
+	uint64_t below_from = (uint64_t(1) << from) - 1;
+	return below_to & ~below_from;
+}
+
+} // namespace
+
+void BitGrid::Reset(int grid_width, int grid_height) {
+	width = std::max(grid_width, 0);
+	height = std::max(grid_height, 0);
+	row_words = (width + 63) / 64;
+	words.assign(static_cast<size_t>(row_words) * height, 0);
+}
+
+void BitGrid::Decode(const ImageData& image) {
+	Reset(image.width, image.height);
+	const size_t pixels = static_cast<size_t>(width) * height;
+	if (image.bits_per_pixel == 1 && image.data.size() * 8 < pixels) {
+		return;
+	}
+	if (image.bits_per_pixel != 1 && image.data.size() < pixels) {
+		return;
+	}
+	const uint8_t* data = reinterpret_cast<const uint8_t*>(image.data.data());
+	for (int y = 0; y < height; ++y) {
+		// Images are stored with an upper left origin
+		const size_t first = static_cast<size_t>(height - 1 - y) * width;
+		uint64_t* row = &words[static_cast<size_t>(y) * row_words];
+		if (image.bits_per_pixel != 1) {
+			for (int x = 0; x < width; ++x) {
+				if (data[first + x] != 0) {
+					row[x / 64] |= uint64_t(1) << (x % 64);
+				}
+			}
+		}
+		else if (first % 8 == 0) {
+			// The row starts on a byte, move it eight cells at a time
+			const uint8_t* bytes = data + first / 8;
+			const int whole = width / 8;
+			for (int b = 0; b < whole; ++b) {
+				row[b / 8] |= uint64_t(kReversed.bytes[bytes[b]]) << (b % 8 * 8);
+			}
+			for (int x = whole * 8; x < width; ++x) {
+				if ((bytes[x / 8] >> (7 - x % 8)) & 1) {
+					row[x / 64] |= uint64_t(1) << (x % 64);
+				}
+			}
+		}
+		else {
+			for (int x = 0; x < width; ++x) {
+				size_t index = first + x;
+				if ((data[index / 8] >> (7 - index % 8)) & 1) {
+					row[x / 64] |= uint64_t(1) << (x % 64);
+				}
+			}
+		}
+	}
+}
+
+size_t BitGrid::Count() const {
+	size_t count = 0;
+	for (uint64_t word : words) {
+		count += PopCount(word);
+	}
+	return count;
+}
+
+void BitGrid::Crop(int x0, int y0, int x1, int y1) {
+	x0 = std::max(x0, 0);
+	x1 = std::min(x1, width);
+	for (int y = 0; y < height; ++y) {
+		uint64_t* row = &words[static_cast<size_t>(y) * row_words];
+		for (int w = 0; w < row_words; ++w) {
+			if (y < y0 || y >= y1) {
+				row[w] = 0;
+			}
+			else {
+				row[w] &= BitRange(std::max(x0 - w * 64, 0),
+					std::min(x1 - w * 64, 64));
+			}
+		}
+	}
+}
+
+BitGrid& BitGrid::operator&=(const BitGrid& other) {
+	const size_t count = std::min(words.size(), other.words.size());
+	for (size_t i = 0; i < count; ++i) {
+		words[i] &= other.words[i];
+	}
+	return *this;
+}
+
+BitGrid& BitGrid::operator|=(const BitGrid& other) {
+	const size_t count = std::min(words.size(), other.words.size());
+	for (size_t i = 0; i < count; ++i) {
+		words[i] |= other.words[i];
+	}
+	return *this;
+}
+
+BitGrid& BitGrid::AndNot(const BitGrid& other) {
+	const size_t count = std::min(words.size(), other.words.size());
+	for (size_t i = 0; i < count; ++i) {
+		words[i] &= ~other.words[i];
+	}
+	return *this;
+}
+
+std::vector<uint8_t> BitGrid::Bytes(uint8_t set) const {
+	std::vector<uint8_t> bytes(static_cast<size_t>(width) * height, 0);
+	ForEach([&](int x, int y) { bytes[x + y * width] = set; });
+	return bytes;
+}
@@ -0,0 +1,111 @@
+#ifndef BIT_GRID_H_
+#define BIT_GRID_H_
+
+#include "sc2api/sc2_gametypes.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Number of set bits
+inline int PopCount(uint64_t value) {
+#if defined(_MSC_VER) && defined(_M_X64)
+	return static_cast<int>(__popcnt64(value));
+#elif defined(_MSC_VER)
+	value = value - ((value >> 1) & 0x5555555555555555ull);
+	value = (value & 0x3333333333333333ull) +
+		((value >> 2) & 0x3333333333333333ull);
+	value = (value + (value >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+	return static_cast<int>((value * 0x0101010101010101ull) >> 56);
+#else
+	return __builtin_popcountll(value);
+#endif
+}
+
+// Index of the lowest set bit, value must not be zero
+inline int LowestBit(uint64_t value) {
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward64(&index, value);
+	return static_cast<int>(index);
+#else
+	return __builtin_ctzll(value);
+#endif
+}
+
+// One bit per map cell, packed into 64 bit words. Every row starts on a new
+// word and bit x % 64 of word x / 64 is column x, so whole rows can be
+// combined a word at a time and the set cells walked with LowestBit().
+// The bits past the width of a row are always clear.
+class BitGrid {
+public:
+	// Sizes the grid with every cell clear
+	void Reset(int width, int height);
+
+	// Decodes a map grid, GameInfo::pathing_grid or placement_grid
+	void Decode(const sc2::ImageData& image);
+
+	int Width() const { return width; }
+	int Height() const { return height; }
+
+	// Cell of the grid, false outside of it
+	bool Get(int x, int y) const {
+		if (x < 0 || y < 0 || x >= width || y >= height) {
+			return false;
+		}
+		return (words[Word(x, y)] >> (x % 64)) & 1;
+	}
+
+	void Set(int x, int y, bool value) {
+		uint64_t bit = uint64_t(1) << (x % 64);
+		if (value) {
+			words[Word(x, y)] |= bit;
+		}
+		else {
+			words[Word(x, y)] &= ~bit;
+		}
+	}
+
+	// Number of set cells
+	size_t Count() const;
+
+	// Clears every cell outside of [x0, x1) x [y0, y1)
+	void Crop(int x0, int y0, int x1, int y1);
+
+	// Cell by cell operations with a grid of the same size
+	BitGrid& operator&=(const BitGrid& other);
+	BitGrid& operator|=(const BitGrid& other);
+	BitGrid& AndNot(const BitGrid& other);
+
+	// Calls f(x, y) for every set cell in raster order from the bottom left
+	template <typename F>
+	void ForEach(F f) const {
+		for (int y = 0; y < height; ++y) {
+			const uint64_t* row = &words[static_cast<size_t>(y) * row_words];
+			for (int w = 0; w < row_words; ++w) {
+				for (uint64_t word = row[w]; word != 0; word &= word - 1) {
+					f(w * 64 + LowestBit(word), y);
+				}
+			}
+		}
+	}
+
+	// Unpacks the grid to one byte per cell, row-major from the bottom left
+	std::vector<uint8_t> Bytes(uint8_t set = 1) const;
+
+private:
+	size_t Word(int x, int y) const {
+		return static_cast<size_t>(y) * row_words + x / 64;
+	}
+
+	int width = 0;
+	int height = 0;
+	int row_words = 0;
+	std::vector<uint64_t> words;
+};
+
+#endif
@@ -0,0 +1,180 @@
+#include "BuildMap.h"
+
+#include "Recording.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace sc2;
+
+namespace {
+
+// Cells kept around the region so footprints at its edge can be stamped
+const int kMargin = 4;
+
+// Bits [from, to) of a word
+uint64_t Mask(int from, int to) {
+	uint64_t high = to == 64 ? ~uint64_t(0) : (uint64_t(1) << to) - 1;
+	return high & ~((uint64_t(1) << from) - 1);
+}
+
+} // namespace
+
+void BuildMap::Reset(const std::vector<Point2D>& points) {
+	size = points.size();
+	mean = Point2D();
+	min = Point2D(std::numeric_limits<float>::max(),
+		std::numeric_limits<float>::max());
+	max = Point2D(std::numeric_limits<float>::lowest(),
+		std::numeric_limits<float>::lowest());
+	for (const auto& p : points) {
+		mean += p;
+		min.x = std::min(min.x, p.x);
+		min.y = std::min(min.y, p.y);
+		max.x = std::max(max.x, p.x);
+		max.y = std::max(max.y, p.y);
+	}
+	if (points.empty()) {
+		width = height = words_per_row = 0;
+		member.clear();
+		buildable.clear();
+		return;
+	}
+	mean /= static_cast<float>(size);
+
+	origin_x = static_cast<int>(std::floor(min.x)) - kMargin;
+	origin_y = static_cast<int>(std::floor(min.y)) - kMargin;
+	width = static_cast<int>(std::floor(max.x)) + kMargin + 1 - origin_x;
+	height = static_cast<int>(std::floor(max.y)) + kMargin + 1 - origin_y;
+	words_per_row = (width + 63) / 64;
+	member.assign(static_cast<size_t>(words_per_row) * height, 0);
+	buildable.assign(member.size(), 0);
+
+	for (const auto& p : points) {
+		Set(static_cast<int>(std::floor(p.x)), static_cast<int>(std::floor(p.y)),
+			1, 1, true);
+	}
+}
+
+bool BuildMap::Clip(int& x, int& y, int& w, int& h) const {
+	int x1 = std::min(x + w, origin_x + width);
+	int y1 = std::min(y + h, origin_y + height);
+	x = std::max(x, origin_x);
+	y = std::max(y, origin_y);
+	w = x1 - x;
+	h = y1 - y;
+	return w > 0 && h > 0;
+}
+
+bool BuildMap::IsBuildable(int x, int y, int w, int h) const {
+	// Cells outside of the box are never buildable
+	int cx = x, cy = y, cw = w, ch = h;
+	if (!Clip(cx, cy, cw, ch) || cw != w || ch != h) {
+		return false;
+	}
+	int begin = x - origin_x;
+	int end = begin + w;
+	for (int row = y - origin_y; row < y - origin_y + h; ++row) {
+		const uint64_t* words = &buildable[static_cast<size_t>(row) * words_per_row];
+		for (int i = begin; i < end; i = (i / 64 + 1) * 64) {
+			uint64_t mask = Mask(i % 64, std::min(end - i / 64 * 64, 64));
+			if ((words[i / 64] & mask) != mask) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+void BuildMap::Set(int x, int y, int w, int h, bool is_buildable) {
+	if (!Clip(x, y, w, h)) {
+		return;
+	}
+	int begin = x - origin_x;
+	int end = begin + w;
+	for (int row = y - origin_y; row < y - origin_y + h; ++row) {
+		size_t offset = static_cast<size_t>(row) * words_per_row;
+		for (int i = begin; i < end; i = (i / 64 + 1) * 64) {
+			uint64_t mask = Mask(i % 64, std::min(end - i / 64 * 64, 64));
+			member[offset + i / 64] |= mask;
+			if (is_buildable) {
+				buildable[offset + i / 64] |= mask;
+			}
+			else {
+				buildable[offset + i / 64] &= ~mask;
+			}
+		}
+	}
+}
+
+void BuildMap::Restore(int x, int y, int w, int h,
+	const BuildMap& original) {
+	if (!Clip(x, y, w, h)) {
+		return;
+	}
+	int begin = x - origin_x;
+	int end = begin + w;
+	for (int row = y - origin_y; row < y - origin_y + h; ++row) {
+		size_t offset = static_cast<size_t>(row) * words_per_row;
+		for (int i = begin; i < end; i = (i / 64 + 1) * 64) {
+			uint64_t mask = Mask(i % 64, std::min(end - i / 64 * 64, 64));
+			size_t word = offset + i / 64;
+			member[word] = (member[word] & ~mask) |
+				(original.member[word] & mask);
+			buildable[word] = (buildable[word] & ~mask) |
+				(original.buildable[word] & mask);
+		}
+	}
+}
+
+bool BuildMap::CanFit(const Point2D& center, int footprint) const {
+	float half = footprint / 2.0f;
+	int x = static_cast<int>(std::floor(center.x - half + 0.5f));
+	int y = static_cast<int>(std::floor(center.y - half + 0.5f));
+	return IsBuildable(x, y, footprint, footprint);
+}
+
+bool BuildMap::CanFitWithAddon(const Point2D& center) const {
+	// Addons sit to the right of the building, level with its lower rows
+	return CanFit(center, 3) &&
+		CanFit(Point2D(center.x + 2.5f, center.y - 0.5f), 2);
+}
+
+void BuildMap::Write(recording::ByteWriter& out) const {
+	out.Write(static_cast<int32_t>(origin_x));
+	out.Write(static_cast<int32_t>(origin_y));
+	out.Write(static_cast<int32_t>(width));
+	out.Write(static_cast<int32_t>(height));
+	out.Write(static_cast<uint32_t>(size));
+	out.Write(mean);
+	out.Write(min);
+	out.Write(max);
+	for (size_t i = 0; i < member.size(); ++i) {
+		out.Write(member[i]);
+		out.Write(buildable[i]);
+	}
+}
+
+bool BuildMap::Read(recording::ByteReader& in) {
+	origin_x = in.Read<int32_t>();
+	origin_y = in.Read<int32_t>();
+	width = in.Read<int32_t>();
+	height = in.Read<int32_t>();
+	size = in.Read<uint32_t>();
+	mean = in.Read<Point2D>();
+	min = in.Read<Point2D>();
+	max = in.Read<Point2D>();
+	if (!in.Ok() || width < 0 || height < 0 || width > 4096 ||
+		height > 4096) {
+		return false;
+	}
+	words_per_row = (width + 63) / 64;
+	member.resize(static_cast<size_t>(words_per_row) * height);
+	buildable.resize(member.size());
+	for (size_t i = 0; i < member.size(); ++i) {
+		member[i] = in.Read<uint64_t>();
+		buildable[i] = in.Read<uint64_t>();
+	}
+	return in.Ok();
+}
@@ -0,0 +1,105 @@
+#ifndef BUILD_MAP_H_
+#define BUILD_MAP_H_
+
+#include "sc2api/sc2_common.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace recording {
+class ByteReader;
+class ByteWriter;
+}
+
+// One connected buildable region of the map, one bit per cell.
+// Cells are addressed by their integer lower left corner. A cell is part of
+// the region once it has been added or stamped, and buildable while nothing
+// is built on it. Storage covers the bounding box of the region plus a small
+// margin, so footprints of structures at the edge still fit; cells outside
+// of it are never part of the region.
+class BuildMap {
+public:
+	// Makes the given cells the region, all of them buildable
+	void Reset(const std::vector<sc2::Point2D>& points);
+
+	// Number of cells the region was created with
+	size_t Size() const { return size; }
+
+	// Mean of the cells the region was created with
+	sc2::Point2D Mean() const { return mean; }
+
+	// Lowest and highest cell the region was created with
+	sc2::Point2D Min() const { return min; }
+	sc2::Point2D Max() const { return max; }
+
+	// True if the cell is part of the region
+	bool Contains(int x, int y) const {
+		return Test(member, x, y);
+	}
+
+	// True if the cell is part of the region and nothing is built on it
+	bool IsBuildable(int x, int y) const {
+		return Test(buildable, x, y);
+	}
+
+	// True if every cell of the w x h rectangle is buildable
+	bool IsBuildable(int x, int y, int w, int h) const;
+
+	// Adds the cells of the w x h rectangle to the region and marks them as
+	// buildable or built on
+	void Set(int x, int y, int w, int h, bool is_buildable);
+
+	// Copies the cells of the w x h rectangle from original, a copy of this
+	// region taken before anything was stamped on it
+	void Restore(int x, int y, int w, int h, const BuildMap& original);
+
+	// True if both have the same cells, for checking incremental updates
+	bool operator==(const BuildMap& other) const {
+		return origin_x == other.origin_x && origin_y == other.origin_y &&
+			width == other.width && height == other.height &&
+			member == other.member && buildable == other.buildable;
+	}
+	bool operator!=(const BuildMap& other) const { return !(*this == other); }
+
+	// True if a square structure of the given size fits around center
+	bool CanFit(const sc2::Point2D& center, int footprint) const;
+
+	// True if a 3x3 structure and its 2x2 addon both fit
+	bool CanFitWithAddon(const sc2::Point2D& center) const;
+
+	// Stores the region in the map cache, see MapCache.h
+	void Write(recording::ByteWriter& out) const;
+	bool Read(recording::ByteReader& in);
+
+private:
+	bool Test(const std::vector<uint64_t>& bits, int x, int y) const {
+		x -= origin_x;
+		y -= origin_y;
+		if (x < 0 || y < 0 || x >= width || y >= height) {
+			return false;
+		}
+		size_t index = static_cast<size_t>(y) * words_per_row + x / 64;
+		return (bits[index] >> (x % 64)) & 1;
+	}
+
+	// Clips the rectangle to the box, false if nothing is left
+	bool Clip(int& x, int& y, int& w, int& h) const;
+
+	// Lower left cell of the box and its size in cells
+	int origin_x = 0;
+	int origin_y = 0;
+	int width = 0;
+	int height = 0;
+	int words_per_row = 0;
+
+	// Row-major from the bottom left, bit x % 64 of word x / 64
+	std::vector<uint64_t> member;
+	std::vector<uint64_t> buildable;
+
+	size_t size = 0;
+	sc2::Point2D mean;
+	sc2::Point2D min;
+	sc2::Point2D max;
+};
+
+#endif
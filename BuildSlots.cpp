@@ -0,0 +1,115 @@
+#include "BuildSlots.h"
+
+#include "BuildMap.h"
+
+#include <cmath>
+
+using namespace sc2;
+
+namespace {
+
+// Cells a slot covers, the structure and its addon
+const int kSlotWidth = 5;
+const int kSlotHeight = 3;
+
+bool Fits(const BuildMap& region, const Point2D& center,
+	BuildSlots::Kind kind) {
+	return kind == BuildSlots::kAddon ? region.CanFitWithAddon(center)
+		: region.CanFit(center, 3);
+}
+
+} // namespace
+
+const int BuildSlots::kStepX;
+const int BuildSlots::kStepY;
+const uint32_t BuildSlots::kReopenLoops;
+
+void BuildSlots::Plan(const BuildMap& terrain, const Point2D& anchor,
+	const Rank& rank) {
+	slots.clear();
+	for (auto& kind : open) {
+		kind.clear();
+	}
+	closed.clear();
+	if (terrain.Size() == 0) {
+		return;
+	}
+
+	// First lattice column and row at or below the region's lowest cell
+	const Point2D min = terrain.Min();
+	const Point2D max = terrain.Max();
+	float first_x = anchor.x -
+		std::ceil((anchor.x - min.x) / kStepX) * kStepX;
+	float first_y = anchor.y -
+		std::ceil((anchor.y - min.y) / kStepY) * kStepY;
+	for (float y = first_y; y <= max.y + 1.0f; y += kStepY) {
+		for (float x = first_x; x <= max.x + 1.0f; x += kStepX) {
+			Slot slot;
+			slot.center = Point2D(x, y);
+			slot.x = static_cast<int>(std::floor(x - 1.0f));
+			slot.y = static_cast<int>(std::floor(y - 1.0f));
+			bool any = false;
+			for (int kind = 0; kind < kKinds; ++kind) {
+				Kind k = static_cast<Kind>(kind);
+				slot.rank[kind] = Fits(terrain, slot.center, k)
+					? rank(slot.center, k) : -1.0f;
+				any = any || slot.rank[kind] >= 0.0f;
+			}
+			if (any) {
+				slots.push_back(slot);
+			}
+		}
+	}
+}
+
+void BuildSlots::Refresh(const BuildMap& region) {
+	for (size_t slot = 0; slot < slots.size(); ++slot) {
+		Update(slot, region);
+	}
+}
+
+void BuildSlots::Refresh(const BuildMap& region, int x, int y, int w,
+	int h) {
+	for (size_t slot = 0; slot < slots.size(); ++slot) {
+		const Slot& s = slots[slot];
+		if (s.x < x + w && x < s.x + kSlotWidth &&
+			s.y < y + h && y < s.y + kSlotHeight) {
+			Update(slot, region);
+		}
+	}
+}
+
+void BuildSlots::Close(size_t slot, Kind kind, uint32_t game_loop) {
+	open[kind].erase(std::make_pair(slots[slot].rank[kind], slot));
+	closed.push_back({ slot, kind, game_loop });
+}
+
+void BuildSlots::Reopen(const BuildMap& region, uint32_t game_loop) {
+	size_t expired = 0;
+	while (expired < closed.size() &&
+		closed[expired].game_loop + kReopenLoops <= game_loop) {
+		const Closed& c = closed[expired];
+		if (Fits(region, slots[c.slot].center, c.kind)) {
+			open[c.kind].insert(
+				std::make_pair(slots[c.slot].rank[c.kind], c.slot));
+		}
+		++expired;
+	}
+	closed.erase(closed.begin(), closed.begin() + expired);
+}
+
+void BuildSlots::Update(size_t slot, const BuildMap& region) {
+	const Slot& s = slots[slot];
+	for (int kind = 0; kind < kKinds; ++kind) {
+		if (s.rank[kind] < 0.0f) {
+			continue;
+		}
+		std::pair<float, size_t> entry(s.rank[kind], slot);
+		if (Fits(region, s.center, static_cast<Kind>(kind))) {
+			open[kind].insert(entry);
+		}
+		else {
+			open[kind].erase(entry);
+		}
+	}
+}
@@ -0,0 +1,94 @@
+#ifndef BUILD_SLOTS_H_
+#define BUILD_SLOTS_H_
+
+#include "sc2api/sc2_common.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <set>
+#include <utility>
+#include <vector>
+
+class BuildMap;
+
+// Where the 3x3 structures of a build region go, planned once.
+// Slots sit on a lattice through an anchor cell, 6 cells apart across and
+// 5 up, so a 3x3 structure with its 2x2 addon leaves a lane of one cell to
+// its right and two above it. Every slot takes either kind of structure
+// where it fits; the open slots of each kind are kept in rank order and are
+// opened and closed as structures are stamped on the region and freed.
+class BuildSlots {
+public:
+	enum Kind { kAddon = 0, kPlain = 1, kKinds = 2 };
+
+	// Lattice spacing between slot centers
+	static const int kStepX = 6;
+	static const int kStepY = 5;
+
+	// Ranks the slot for a kind, lower first, negative if the kind
+	// shouldn't go there
+	typedef std::function<float(const sc2::Point2D& center, Kind kind)> Rank;
+
+	// Lays the slots over the cells of the region with nothing built on
+	// them, all of them closed until Refresh()
+	void Plan(const BuildMap& terrain, const sc2::Point2D& anchor,
+		const Rank& rank);
+
+	// Opens the slots that fit in the region and closes the others
+	void Refresh(const BuildMap& region);
+
+	// Same, only for the slots overlapping the w x h rectangle
+	void Refresh(const BuildMap& region, int x, int y, int w, int h);
+
+	// Game loops a slot the game rejected stays closed before it is
+	// checked again
+	static const uint32_t kReopenLoops = 224;
+
+	// Closes the slot for the kind, for slots the game rejected. It opens
+	// again when a Refresh() covering it or a Reopen() finds it fits.
+	void Close(size_t slot, Kind kind, uint32_t game_loop);
+
+	// Opens the slots closed kReopenLoops or more ago that fit in the region
+	void Reopen(const BuildMap& region, uint32_t game_loop);
+
+	// Open slots of the kind as { rank, slot }, best first
+	const std::set<std::pair<float, size_t>>& Open(Kind kind) const {
+		return open[kind];
+	}
+
+	// Center of the 3x3 structure of the slot
+	const sc2::Point2D& Center(size_t slot) const {
+		return slots[slot].center;
+	}
+
+	// Number of slots planned
+	size_t Count() const { return slots.size(); }
+
+private:
+	struct Slot {
+		sc2::Point2D center;
+		// Lower left cell of the structure and its addon
+		int x = 0;
+		int y = 0;
+		// Negative for the kinds that can't go there
+		float rank[kKinds];
+	};
+
+	struct Closed {
+		size_t slot;
+		Kind kind;
+		uint32_t game_loop;
+	};
+
+	// Opens or closes the slot by what fits in the region
+	void Update(size_t slot, const BuildMap& region);
+
+	std::vector<Slot> slots;
+	std::set<std::pair<float, size_t>> open[kKinds];
+
+	// Slots the game rejected, oldest first
+	std::vector<Closed> closed;
+};
+
+#endif
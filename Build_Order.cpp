@@ -4,6 +4,7 @@
 using namespace sc2;
 
 void BasicSc2Bot::ExecuteBuildOrder() {
+	PROFILE_SCOPE("ExecuteBuildOrder");
 	// what do I do if some buildings are destroyed?
 	BuildBarracks();
 	BuildFactory();
@@ -23,10 +24,9 @@ void BasicSc2Bot::ExecuteBuildOrder() {
 
 // Build Barracks if we have a Supply Depot and enough resources
 void BasicSc2Bot::BuildBarracks() {
-	const ObservationInterface* obs = Observation();
-
+	PROFILE_SCOPE("BuildBarracks");
 	// Get Supply Depots
-	Units dps = obs->GetUnits(Unit::Alliance::Self, [this](const Unit& unit) {
+	Units dps = Index().GetUnits(Unit::Alliance::Self, [this](const Unit& unit) {
 		return (unit.unit_type == UNIT_TYPEID::TERRAN_SUPPLYDEPOT ||
 			unit.unit_type == UNIT_TYPEID::TERRAN_SUPPLYDEPOTLOWERED) &&
 			ALLBuildingsFilter(unit);
@@ -48,7 +48,7 @@ void BasicSc2Bot::BuildBarracks() {
 
 	// Build only 1 Barrack
 	Units barracks =
-		obs->GetUnits(Unit::Alliance::Self, [this](const Unit& unit) {
+		Index().GetUnits(Unit::Alliance::Self, [this](const Unit& unit) {
 		return unit.unit_type == UNIT_TYPEID::TERRAN_BARRACKS &&
 			ALLBuildingsFilter(unit);
 			});
@@ -71,16 +71,15 @@ void BasicSc2Bot::BuildBarracks() {
 
 // Build Orbital Command if we have a Command Center and enough resources
 void BasicSc2Bot::BuildOrbitalCommand() {
-	const ObservationInterface* obs = Observation();
-
+	PROFILE_SCOPE("BuildOrbitalCommand");
 	// Can't build Orbital Command without Barracks or Factories
 	if (!num_barracks || !num_factories) {
 		return;
 	}
 
 	// Find a Command Center that can be upgraded
-	Units command_centers = obs->GetUnits(
-		Unit::Alliance::Self, IsUnit(UNIT_TYPEID::TERRAN_COMMANDCENTER));
+	Units command_centers = Index().GetUnits(
+		Unit::Alliance::Self, UNIT_TYPEID::TERRAN_COMMANDCENTER);
 
 	if (command_centers.empty()) {
 		return;
@@ -105,8 +104,7 @@ void BasicSc2Bot::BuildOrbitalCommand() {
 
 // Build Factory if we have a Barracks and enough resources
 void BasicSc2Bot::BuildFactory() {
-	const ObservationInterface* observation = Observation();
-
+	PROFILE_SCOPE("BuildFactory");
 	// Can't build Factory without Barracks
 	if (!num_barracks) {
 		return;
@@ -122,7 +120,7 @@ void BasicSc2Bot::BuildFactory() {
 
 	// Build only 1 Factory
 	Units factories =
-		observation->GetUnits(Unit::Alliance::Self, [this](const Unit& unit) {
+		Index().GetUnits(Unit::Alliance::Self, [this](const Unit& unit) {
 		return unit.unit_type == UNIT_TYPEID::TERRAN_FACTORY ||
 			unit.unit_type == UNIT_TYPEID::TERRAN_FACTORYFLYING;
 			});
@@ -133,8 +131,7 @@ void BasicSc2Bot::BuildFactory() {
 
 // Build Starport if we have a Factory and enough resources
 void BasicSc2Bot::BuildStarport() {
-	const ObservationInterface* obs = Observation();
-
+	PROFILE_SCOPE("BuildStarport");
 	// Can't build Starports without Factories
 	if (!num_factories) {
 		return;
@@ -142,7 +139,7 @@ void BasicSc2Bot::BuildStarport() {
 
 	// Build only 1 Starport
 	Units starports =
-		obs->GetUnits(Unit::Alliance::Self, [this](const Unit& unit) {
+		Index().GetUnits(Unit::Alliance::Self, [this](const Unit& unit) {
 		return unit.unit_type == UNIT_TYPEID::TERRAN_STARPORT ||
 			unit.unit_type == UNIT_TYPEID::TERRAN_STARPORTFLYING;
 			});
@@ -154,31 +151,31 @@ void BasicSc2Bot::BuildStarport() {
 
 // Build Tech lab if we have a Factory and enough resources
 void BasicSc2Bot::BuildAddon() {
+	PROFILE_SCOPE("BuildAddon");
 	if (!swap_in_progress) {
-		const ObservationInterface* obs = Observation();
 		// Get Barracks
 		Units barracks =
-			obs->GetUnits(Unit::Alliance::Self, [](const Unit& unit) {
+			Index().GetUnits(Unit::Alliance::Self, [](const Unit& unit) {
 			return unit.unit_type == UNIT_TYPEID::TERRAN_BARRACKS &&
 				!unit.is_flying && !unit.add_on_tag;
 				});
 
 		// Get Factories
 		Units factories =
-			obs->GetUnits(Unit::Alliance::Self, [](const Unit& unit) {
+			Index().GetUnits(Unit::Alliance::Self, [](const Unit& unit) {
 			return unit.unit_type == UNIT_TYPEID::TERRAN_FACTORY &&
 				!unit.is_flying && !unit.add_on_tag;
 				});
 
 		// Get Starports
 		Units starports =
-			obs->GetUnits(Unit::Alliance::Self, [](const Unit& unit) {
+			Index().GetUnits(Unit::Alliance::Self, [](const Unit& unit) {
 			return unit.unit_type == UNIT_TYPEID::TERRAN_STARPORT &&
 				!unit.is_flying && !unit.add_on_tag;
 				});
 
 		Units barracks_techlab =
-			obs->GetUnits(Unit::Alliance::Self, [](const Unit& unit) {
+			Index().GetUnits(Unit::Alliance::Self, [](const Unit& unit) {
 			return unit.unit_type == UNIT_TYPEID::TERRAN_BARRACKSTECHLAB;
 				});
 
@@ -234,8 +231,7 @@ void BasicSc2Bot::BuildAddon() {
 
 // Build Fusion Core if we have a Starport and enough resources
 void BasicSc2Bot::BuildFusionCore() {
-	const ObservationInterface* obs = Observation();
-
+	PROFILE_SCOPE("BuildFusionCore");
 	// Can't build fusion core without Starports
 	if (!num_starports || num_fusioncores) {
 		return;
@@ -243,7 +239,7 @@ void BasicSc2Bot::BuildFusionCore() {
 
 	// Build only 1 Fusion core
 	Units fusioncore =
-		obs->GetUnits(Unit::Alliance::Self, [this](const Unit& unit) {
+		Index().GetUnits(Unit::Alliance::Self, [this](const Unit& unit) {
 		return unit.unit_type == UNIT_TYPEID::TERRAN_FUSIONCORE &&
 			ALLBuildingsFilter(unit);
 			});
@@ -257,8 +253,7 @@ void BasicSc2Bot::BuildFusionCore() {
 
 // Build Armory if we have a Fusion core and enough resources
 void BasicSc2Bot::BuildArmory() {
-	const ObservationInterface* obs = Observation();
-
+	PROFILE_SCOPE("BuildArmory");
 	// Can't build Armory core without the First Battlecruiser
 	if (!first_battlecruiser) {
 		return;
@@ -266,7 +261,7 @@ void BasicSc2Bot::BuildArmory() {
 
 	// Build only 1 Armory
 	Units armories =
-		obs->GetUnits(Unit::Alliance::Self, [this](const Unit& unit) {
+		Index().GetUnits(Unit::Alliance::Self, [this](const Unit& unit) {
 		return unit.unit_type == UNIT_TYPEID::TERRAN_ARMORY &&
 			ALLBuildingsFilter(unit);
 			});
@@ -278,17 +273,16 @@ void BasicSc2Bot::BuildArmory() {
 
 // Build Engineering bay if we have a Barrack and enough resources
 void BasicSc2Bot::BuildEngineeringBay() {
-	const ObservationInterface* obs = Observation();
-
+	PROFILE_SCOPE("BuildEngineeringBay");
 	// Get Barracks
 	Units barracks =
-		obs->GetUnits(Unit::Alliance::Self, [this](const Unit& unit) {
+		Index().GetUnits(Unit::Alliance::Self, [this](const Unit& unit) {
 		return unit.unit_type == UNIT_TYPEID::TERRAN_BARRACKS &&
 			ALLBuildingsFilter(unit);
 			});
 	// Get Startports
 	Units starports =
-		obs->GetUnits(Unit::Alliance::Self, [this](const Unit& unit) {
+		Index().GetUnits(Unit::Alliance::Self, [this](const Unit& unit) {
 		return unit.unit_type == UNIT_TYPEID::TERRAN_STARPORT &&
 			ALLBuildingsFilter(unit);
 			});
@@ -300,7 +294,7 @@ void BasicSc2Bot::BuildEngineeringBay() {
 
 	// Build only 1 engineering bay (After Starports)
 	Units engineeringbays =
-		obs->GetUnits(Unit::Alliance::Self, [this](const Unit& unit) {
+		Index().GetUnits(Unit::Alliance::Self, [this](const Unit& unit) {
 		return unit.unit_type == UNIT_TYPEID::TERRAN_ENGINEERINGBAY &&
 			ALLBuildingsFilter(unit);
 			});
@@ -314,6 +308,7 @@ void BasicSc2Bot::BuildEngineeringBay() {
 
 // Swaps a Factory with a Starport
 void BasicSc2Bot::Swap(const Unit* a, const Unit* b, bool lift) {
+	PROFILE_SCOPE("Swap");
 
 	// lift buildings
 	if (lift) {
@@ -325,7 +320,6 @@ void BasicSc2Bot::Swap(const Unit* a, const Unit* b, bool lift) {
 	}
 	else {
 		if (swap_in_progress && a->is_flying && b->is_flying) {
-			const ObservationInterface* obs = Observation();
 			Point2D swap_position_a = a->pos;
 			Point2D swap_position_b = b->pos;
 			Actions()->UnitCommand(a, ABILITY_ID::LAND, swap_position_b);
@@ -3,6 +3,7 @@
 using namespace sc2;
 
 void BasicSc2Bot::ManageProduction() {
+	PROFILE_SCOPE("ManageProduction");
 	// Train units and upgrades
 	TrainMarines();
 	TrainBattlecruisers();
@@ -15,16 +16,16 @@ void BasicSc2Bot::ManageProduction() {
 }
 
 void BasicSc2Bot::TrainMarines() {
+	PROFILE_SCOPE("TrainMarines");
 	// Find Barracks to train Marines
-	const ObservationInterface* obs = Observation();
-	Units barracks = obs->GetUnits(Unit::Alliance::Self,
-		IsUnit(UNIT_TYPEID::TERRAN_BARRACKS));
-	Units factories = obs->GetUnits(Unit::Alliance::Self,
-		IsUnit(UNIT_TYPEID::TERRAN_FACTORY));
-	Units starport = obs->GetUnits(Unit::Alliance::Self,
-		IsUnit(UNIT_TYPEID::TERRAN_STARPORT));
-	Units reactor = obs->GetUnits(Unit::Alliance::Self,
-		IsUnit(UNIT_TYPEID::TERRAN_BARRACKSREACTOR));
+	Units barracks = Index().GetUnits(
+		Unit::Alliance::Self, UNIT_TYPEID::TERRAN_BARRACKS);
+	Units factories = Index().GetUnits(
+		Unit::Alliance::Self, UNIT_TYPEID::TERRAN_FACTORY);
+	Units starport = Index().GetUnits(
+		Unit::Alliance::Self, UNIT_TYPEID::TERRAN_STARPORT);
+	Units reactor = Index().GetUnits(
+		Unit::Alliance::Self, UNIT_TYPEID::TERRAN_BARRACKSREACTOR);
 
 	if (barracks.empty() ||
 		phase == 0) { // Can't train Marines without Barracks
@@ -61,13 +62,13 @@ void BasicSc2Bot::TrainMarines() {
 }
 
 void BasicSc2Bot::TrainBattlecruisers() {
+	PROFILE_SCOPE("TrainBattlecruisers");
 	// Find Starports to build a Battlecruiser
-	const ObservationInterface* obs = Observation();
-	Units starports = obs->GetUnits(Unit::Alliance::Self, [](const Unit& unit) {
+	Units starports = Index().GetUnits(Unit::Alliance::Self, [](const Unit& unit) {
 		return unit.unit_type == UNIT_TYPEID::TERRAN_STARPORT && unit.tag;
 		});
 	Units fusioncore =
-		obs->GetUnits(Unit::Alliance::Self, [](const Unit& unit) {
+		Index().GetUnits(Unit::Alliance::Self, [](const Unit& unit) {
 		return unit.unit_type == UNIT_TYPEID::TERRAN_FUSIONCORE && unit.tag;
 			});
 
@@ -96,14 +97,14 @@ void BasicSc2Bot::TrainBattlecruisers() {
 }
 
 void BasicSc2Bot::TrainSiegeTanks() {
+	PROFILE_SCOPE("TrainSiegeTanks");
 	// Find Factories to train Siege Tanks
-	const ObservationInterface* obs = Observation();
-	Units factories = obs->GetUnits(Unit::Alliance::Self,
-		IsUnit(UNIT_TYPEID::TERRAN_FACTORY));
-	Units starport = obs->GetUnits(Unit::Alliance::Self,
-		IsUnit(UNIT_TYPEID::TERRAN_STARPORT));
-	Units fusioncores = obs->GetUnits(Unit::Alliance::Self,
-		IsUnit(UNIT_TYPEID::TERRAN_FUSIONCORE));
+	Units factories = Index().GetUnits(
+		Unit::Alliance::Self, UNIT_TYPEID::TERRAN_FACTORY);
+	Units starport = Index().GetUnits(
+		Unit::Alliance::Self, UNIT_TYPEID::TERRAN_STARPORT);
+	Units fusioncores = Index().GetUnits(
+		Unit::Alliance::Self, UNIT_TYPEID::TERRAN_FUSIONCORE);
 
 	// Can't train Siege Tanks without Factories
 	if (factories.empty()) {
@@ -155,12 +156,12 @@ void BasicSc2Bot::TrainSiegeTanks() {
 }
 
 void BasicSc2Bot::UpgradeMarines() {
+	PROFILE_SCOPE("UpgradeMarines");
 	// Find Tech Labs and Engineering Bays to upgrade Marines
-	const ObservationInterface* observation = Observation();
-	Units techlabs = observation->GetUnits(
-		Unit::Alliance::Self, IsUnit(UNIT_TYPEID::TERRAN_BARRACKSTECHLAB));
-	Units engineeringbays = observation->GetUnits(
-		Unit::Alliance::Self, IsUnit(UNIT_TYPEID::TERRAN_ENGINEERINGBAY));
+	Units techlabs = Index().GetUnits(
+		Unit::Alliance::Self, UNIT_TYPEID::TERRAN_BARRACKSTECHLAB);
+	Units engineeringbays = Index().GetUnits(
+		Unit::Alliance::Self, UNIT_TYPEID::TERRAN_ENGINEERINGBAY);
 
 	// Can't upgrade Marines without Engineering Bays
 	if (engineeringbays.empty()) {
@@ -206,10 +207,10 @@ void BasicSc2Bot::UpgradeMarines() {
 }
 
 void BasicSc2Bot::UpgradeMechs() {
+	PROFILE_SCOPE("UpgradeMechs");
 	// Find Armories to upgrade Mechs
-	const ObservationInterface* observation = Observation();
-	Units armories = observation->GetUnits(Unit::Alliance::Self,
-		IsUnit(UNIT_TYPEID::TERRAN_ARMORY));
+	Units armories = Index().GetUnits(
+		Unit::Alliance::Self, UNIT_TYPEID::TERRAN_ARMORY);
 
 	// Can't upgrade Mechs(Battlecruisers and Tanks) without Armories
 	// Also, save resources for first Battlecruiser
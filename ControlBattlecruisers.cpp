@@ -3,6 +3,19 @@
 
 using namespace sc2;
 
+namespace {
+
+// Battlecruiser targeting priorities, lower first
+const uint8_t kAntiAirTarget = 0;
+const uint8_t kWorkerTarget = 1;
+const uint8_t kTurretTarget = 2;
+const uint8_t kUnitTarget = 3;
+const uint8_t kSupplyTarget = 4;
+const uint8_t kStructureTarget = 5;
+const uint8_t kNoTarget = 6;
+
+} // namespace
+
 // ------------------ Helper Functions ------------------
 
 // Retreat function for Battlecruisers
@@ -20,52 +33,70 @@ void BasicSc2Bot::Retreat(const Unit* unit) {
 }
 
 // Calculate the threat level for the Battlecruisers
-int BasicSc2Bot::CalculateThreatLevel(const Unit* unit) {
+float BasicSc2Bot::CalculateThreatLevel(const Unit* unit) {
 	if (!unit) { // Null check
-		return 0;
+		return 0.0f;
 	}
+	return AirThreat().At(unit->pos);
+}
 
-	int threat_level = 0;
-
-	// Detect radius for Battlecruisers
-	const float defense_check_radius = 14.0f;
-	for (const auto& enemy_unit :
-		Observation()->GetUnits(Unit::Alliance::Enemy)) {
-		auto threat = threat_levels.find(enemy_unit->unit_type);
-
-		if (threat != threat_levels.end()) {
-			float distance = Distance2D(unit->pos, enemy_unit->pos);
-
-			if (distance < defense_check_radius) {
-				threat_level += threat->second;
-			}
+// Rank every unit type once instead of looking up its type data for every
+// enemy a Battlecruiser considers
+void BasicSc2Bot::ClassifyBattlecruiserTargets() {
+	const UnitTypes& unit_types = Observation()->GetUnitTypeData();
+	battlecruiser_target_by_type.assign(unit_types.size(), kNoTarget);
+	for (size_t index = 0; index < unit_types.size(); ++index) {
+		UNIT_TYPEID type = static_cast<UNIT_TYPEID>(index);
+		bool is_turret = std::find(turret_types.begin(), turret_types.end(),
+			type) != turret_types.end();
+		bool is_structure = std::any_of(unit_types[index].attributes.begin(),
+			unit_types[index].attributes.end(), [](Attribute attr) {
+				return attr == Attribute::Structure;
+			});
+		uint8_t& target = battlecruiser_target_by_type[index];
+		if (is_turret) {
+			target = kTurretTarget;
+		}
+		else if (ThreatLevel(type) > 0) {
+			target = kAntiAirTarget;
+		}
+		else if (std::find(worker_types.begin(), worker_types.end(), type) !=
+			worker_types.end()) {
+			target = kWorkerTarget;
+		}
+		else if (!is_structure && type != UNIT_TYPEID::ZERG_LARVA &&
+			type != UNIT_TYPEID::ZERG_EGG) {
+			target = kUnitTarget;
+		}
+		else if (std::find(resource_units.begin(), resource_units.end(),
+			type) != resource_units.end()) {
+			target = kSupplyTarget;
+		}
+		else if (is_structure) {
+			target = kStructureTarget;
 		}
 	}
-
-	return threat_level;
 }
 
 // Get the closest threat to the Battlecruisers
-const Unit* BasicSc2Bot::GetClosestThreat(const Unit* unit) {
+const Unit* BasicSc2Bot::GetClosestThreat(const Unit* unit,
+	float max_distance) {
 	if (!unit) { // Null check
 		return nullptr;
 	}
 
 	const Unit* target = nullptr;
-	constexpr float max_distance = std::numeric_limits<float>::max();
-	float min_distance = max_distance;
+	float min_distance = std::numeric_limits<float>::max();
 	float min_hp = std::numeric_limits<float>::max();
 
 	// Find the closest threat to the Battlecruisers
 	for (const auto& enemy_unit :
-		Observation()->GetUnits(Unit::Alliance::Enemy)) {
+		EnemyGrid().GetUnitsWithin(unit->pos, max_distance)) {
 		// Ensure the enemy unit is alive
 		if (!enemy_unit->is_alive) {
 			continue;
 		}
-		auto threat = threat_levels.find(enemy_unit->unit_type);
-
-		if (threat != threat_levels.end()) {
+		if (ThreatLevel(enemy_unit->unit_type) > 0) {
 			float distance = Distance2D(unit->pos, enemy_unit->pos);
 			if (distance < min_distance ||
 				(distance == min_distance && enemy_unit->health < min_hp)) {
@@ -147,6 +178,7 @@ Point2D BasicSc2Bot::GetKiteVector(const Unit* unit, const Unit* target) {
 
 // Main function to control Battlecruisers
 void BasicSc2Bot::ControlBattlecruisers() {
+	PROFILE_SCOPE("ControlBattlecruisers");
 	Jump();
 	TargetBattlecruisers();
 	RetreatCheck();
@@ -154,9 +186,9 @@ void BasicSc2Bot::ControlBattlecruisers() {
 
 // Use Tactical Jump to attack the enemy base
 void BasicSc2Bot::Jump() {
+	PROFILE_SCOPE("Jump");
 
 	const Unit* main_base = GetMainBase();
-	const ObservationInterface* obs = Observation();
 	// Check if the main base is under attack; don't use Tactical Jump in that
 	// case
 	if (!main_base || EnemyNearby(main_base->pos, true, 25)) {
@@ -164,7 +196,7 @@ void BasicSc2Bot::Jump() {
 	}
 
 	// Check if any Battlecruiser is still retreating
-	for (const auto& unit : Observation()->GetUnits(Unit::Alliance::Self)) {
+	for (const auto& unit : Index().GetUnits(Unit::Alliance::Self)) {
 		if (unit->unit_type == UNIT_TYPEID::TERRAN_BATTLECRUISER &&
 			battlecruiser_retreating[unit]) {
 			// Wait until all retreating Battlecruisers finish their retreat
@@ -173,26 +205,30 @@ void BasicSc2Bot::Jump() {
 	}
 
 	// No retreating Battlecruisers, proceed with Tactical Jump logic
-	for (const auto& unit : Observation()->GetUnits(Unit::Alliance::Self)) {
+	for (const auto& unit : Index().GetUnits(Unit::Alliance::Self)) {
 		// Check if the unit is a Battlecruiser with full health and not retreating
 		if (unit->unit_type == UNIT_TYPEID::TERRAN_BATTLECRUISER &&
 			unit->health >= unit->health_max &&
 			Distance2D(unit->pos, enemy_start_location) > 40.0f &&
 			HasAbility(unit, ABILITY_ID::EFFECT_TACTICALJUMP)) {
-			Actions()->UnitCommand(unit, ABILITY_ID::EFFECT_TACTICALJUMP, enemy_start_location);
+			// land in the least defended spot of the enemy main
+			const float jump_spread = 8.0f;
+			Actions()->UnitCommand(unit, ABILITY_ID::EFFECT_TACTICALJUMP,
+				AirThreat().Lowest(enemy_start_location, jump_spread));
 		}
 	}
 }
 
 // Target mechanics for Battlecruisers
 void BasicSc2Bot::TargetBattlecruisers() {
+	PROFILE_SCOPE("TargetBattlecruisers");
 
 	// Maximum distance to consider for targetting
 	const float max_distace_for_target = 20.0f;
 
 	// Get Battlecruisers
-	const Units battlecruisers = Observation()->GetUnits(
-		Unit::Alliance::Self, IsUnit(UNIT_TYPEID::TERRAN_BATTLECRUISER));
+	const Units battlecruisers = Index().GetUnits(
+		Unit::Alliance::Self, UNIT_TYPEID::TERRAN_BATTLECRUISER);
 
 	// Exit when there are no battlecruisers
 	if (battlecruisers.empty()) {
@@ -209,6 +245,15 @@ void BasicSc2Bot::TargetBattlecruisers() {
 	// Threshold for "kiting" behavior
 	const int threat_threshold = 10 * num_battlecruisers_in_combat;
 
+	// Count turrets
+	int num_turrets = 0;
+	for (const auto& enemy_unit : Index().GetUnits(Unit::Alliance::Enemy)) {
+		if (std::find(turret_types.begin(), turret_types.end(),
+			enemy_unit->unit_type) != turret_types.end()) {
+			num_turrets++;
+		}
+	}
+
 	for (const auto& battlecruiser : battlecruisers) {
 
         // Disables targetting while Jumping
@@ -226,7 +271,7 @@ void BasicSc2Bot::TargetBattlecruisers() {
 			return;
 		}
 
-		int total_threat = CalculateThreatLevel(battlecruiser);
+		float total_threat = CalculateThreatLevel(battlecruiser);
 
 		// Determine whether to retreat based on the threat level
 		// retreat if the total threat level is above the threshold
@@ -254,128 +299,77 @@ void BasicSc2Bot::TargetBattlecruisers() {
 				Retreat(battlecruiser);
 			}
 			else {
-				const Unit* target = GetClosestThreat(battlecruiser);
-				// Kite enemy units
+				// Kite enemy units, unless they are too far away
+				const Unit* target = GetClosestThreat(battlecruiser, 12.0f);
 				if (target) {
-					// Skip kiting if the target is too far away
-					if (Distance2D(battlecruiser->pos, target->pos) > 12.0f) {
-						continue;
-					}
-					else {
-						Actions()->UnitCommand(battlecruiser, ABILITY_ID::MOVE_MOVE, GetKiteVector(battlecruiser, target));
-					}
+					Actions()->UnitCommand(battlecruiser, ABILITY_ID::MOVE_MOVE,
+						GetKiteVector(battlecruiser, target));
 				}
 			}
 		}
 		// Do not kite if the total threat level is below the threshold
 		else {
-			const Unit* target = nullptr;
-			float min_distance = std::numeric_limits<float>::max();
-			float min_hp = std::numeric_limits<float>::max();
-
-			auto UpdateTarget = [&](const Unit* enemy_unit,
-				float max_distance) {
-					float distance =
-						Distance2D(battlecruiser->pos, enemy_unit->pos);
-					if (!enemy_unit->is_alive || distance > max_distance) {
-						return;
-					}
-					if (distance < min_distance ||
-						(distance == min_distance && enemy_unit->health < min_hp)) {
-						min_distance = distance;
-						min_hp = enemy_unit->health;
-						target = enemy_unit;
-					}
-				};
-
-			// Count turrets
-			int num_turrets = 0;
-			for (const auto& enemy_unit :
-				Observation()->GetUnits(Unit::Alliance::Enemy)) {
-				if (std::find(turret_types.begin(), turret_types.end(),
-					enemy_unit->unit_type) != turret_types.end()) {
-					num_turrets++;
+			// Whether anything besides turrets can shoot up close by
+			const float defense_check_radius = 14.0f;
+			bool other_threats = EnemyGrid().AnyWithin(battlecruiser->pos,
+				defense_check_radius, [this](const Unit& enemy_unit) {
+					return ThreatLevel(enemy_unit.unit_type) > 0 &&
+						std::find(turret_types.begin(), turret_types.end(),
+							enemy_unit.unit_type) == turret_types.end();
+				});
+			// Avoid turrets when conditions apply
+			bool avoid_turrets =
+				num_turrets >= 2 * num_battlecruisers_in_combat ||
+				other_threats;
+
+			// Prioritize targets based on rules, lower first:
+			// 1st anti air units (turrets only when not avoided),
+			// 2nd workers, 3rd turrets, 4th any units that are not
+			// structures, 5th supply structures, 6th any structures
+			auto Priority = [&](const Unit* enemy_unit) {
+				size_t index = static_cast<size_t>(enemy_unit->unit_type);
+				uint8_t priority = index < battlecruiser_target_by_type.size()
+					? battlecruiser_target_by_type[index] : kNoTarget;
+				if (priority == kTurretTarget && !avoid_turrets &&
+					ThreatLevel(enemy_unit->unit_type) > 0) {
+					return kAntiAirTarget;
 				}
-			}
-
-			// Prioritize targets based on rules
-			auto PrioritizeTargets = [&](const std::vector<UNIT_TYPEID>& types,
-				float max_distance) {
-					for (const auto& enemy_unit :
-						Observation()->GetUnits(Unit::Alliance::Enemy)) {
-						if (std::find(types.begin(), types.end(),
-							enemy_unit->unit_type) != types.end()) {
-							UpdateTarget(enemy_unit, max_distance);
-						}
-					}
-				};
-
-			// 1st Priority: Enemy units (excluding turrets based on turret
-			// conditions)
-			for (const auto& enemy_unit :
-				Observation()->GetUnits(Unit::Alliance::Enemy)) {
-				auto threat = threat_levels.find(enemy_unit->unit_type);
-				if (threat != threat_levels.end()) {
-					if (std::find(turret_types.begin(), turret_types.end(),
-						enemy_unit->unit_type) !=
-						turret_types.end()) {
-						// Avoid turrets when conditions apply
-						if (num_turrets >= 2 * num_battlecruisers_in_combat ||
-							total_threat - (3 * num_turrets) != 0) {
-							continue;
-						}
-					}
-					UpdateTarget(enemy_unit, max_distace_for_target);
+				return priority;
+			};
+
+			// One pass over the enemies in reach, keeping the closest of
+			// every priority and the weakest of the closest
+			struct Candidate {
+				const Unit* unit = nullptr;
+				float distance = std::numeric_limits<float>::max();
+				float hp = std::numeric_limits<float>::max();
+			};
+			Candidate best[kNoTarget];
+			for (const auto& enemy_unit : EnemyGrid().GetUnitsWithin(
+				battlecruiser->pos, max_distace_for_target)) {
+				if (!enemy_unit->is_alive) {
+					continue;
 				}
-			}
-
-			if (!target) {
-				PrioritizeTargets(worker_types, max_distace_for_target);
-			}
-
-			// 3rd Priority -> Turrets
-			if (!target) {
-				PrioritizeTargets(turret_types, max_distace_for_target);
-			}
-
-			// 4th Priority -> Any units that are not structures
-			if (!target) {
-				for (const auto& enemy_unit :
-					Observation()->GetUnits(Unit::Alliance::Enemy)) {
-					const UnitTypeData& unit_type_data =
-						Observation()->GetUnitTypeData().at(
-							enemy_unit->unit_type);
-					if (!std::any_of(unit_type_data.attributes.begin(),
-						unit_type_data.attributes.end(),
-						[](Attribute attr) {
-							return attr == Attribute::Structure;
-						}) &&
-						enemy_unit->unit_type != UNIT_TYPEID::ZERG_LARVA &&
-							enemy_unit->unit_type != UNIT_TYPEID::ZERG_EGG) {
-						UpdateTarget(enemy_unit, max_distace_for_target);
-					}
+				uint8_t priority = Priority(enemy_unit);
+				if (priority == kNoTarget) {
+					continue;
+				}
+				Candidate& candidate = best[priority];
+				float distance =
+					Distance2D(battlecruiser->pos, enemy_unit->pos);
+				if (distance < candidate.distance ||
+					(distance == candidate.distance &&
+						enemy_unit->health < candidate.hp)) {
+					candidate.unit = enemy_unit;
+					candidate.distance = distance;
+					candidate.hp = enemy_unit->health;
 				}
 			}
-
-			// 5th Priority -> Supply structures
-			if (!target) {
-				PrioritizeTargets(resource_units, max_distace_for_target);
-			}
-
-			// 6th Priority -> Any structures
-			if (!target) {
-				for (const auto& enemy_unit :
-					Observation()->GetUnits(Unit::Alliance::Enemy)) {
-					const UnitTypeData& unit_type_data =
-						Observation()->GetUnitTypeData().at(
-							enemy_unit->unit_type);
-					if (std::any_of(unit_type_data.attributes.begin(),
-						unit_type_data.attributes.end(),
-						[](Attribute attr) {
-							return attr == Attribute::Structure;
-						})) {
-						UpdateTarget(enemy_unit, max_distace_for_target);
-					}
+			const Unit* target = nullptr;
+			for (const auto& candidate : best) {
+				if (candidate.unit) {
+					target = candidate.unit;
+					break;
 				}
 			}
 
@@ -391,11 +385,12 @@ void BasicSc2Bot::TargetBattlecruisers() {
 }
 
 void BasicSc2Bot::RetreatCheck() {
+	PROFILE_SCOPE("RetreatCheck");
 	// Distance threshold for arrival
 	const float arrival_threshold = 5.0f;
 
-	for (const auto& battlecruiser : Observation()->GetUnits(
-		Unit::Alliance::Self, IsUnit(UNIT_TYPEID::TERRAN_BATTLECRUISER))) {
+	for (const auto& battlecruiser : Index().GetUnits(
+		Unit::Alliance::Self, UNIT_TYPEID::TERRAN_BATTLECRUISER)) {
 		// Check if the Battlecruiser has reached the retreat location
 		if (battlecruiser_retreating[battlecruiser] &&
 			Distance2D(battlecruiser->pos, retreat_location) <=
@@ -58,28 +58,9 @@ const Unit* BasicSc2Bot::GetClosestTarget(const Unit* unit) {
 		return nullptr;
 	}
 
-	const Unit* target = nullptr;
-	float min_distance = std::numeric_limits<float>::max();
-
-	// Find the closest enemy
-	for (const auto& enemy_unit :
-		Observation()->GetUnits(Unit::Alliance::Enemy)) {
-		// Skip invalid or dead units
-		if (!enemy_unit || !enemy_unit->is_alive) {
-			continue;
-		}
-
-		// Calculate distance to the enemy unit
-		float distance_to_enemy = Distance2D(unit->pos, enemy_unit->pos);
-
-		// Find the closest unit
-		if (distance_to_enemy < min_distance && distance_to_enemy < 13.0f) {
-			min_distance = distance_to_enemy;
-			target = enemy_unit;
-		}
-	}
-
-	return target;
+	// Find the closest living enemy within 13
+	return EnemyGrid().Closest(unit->pos, 13.0f,
+		[](const Unit& enemy_unit) { return enemy_unit.is_alive; });
 }
 
 // Move Marine to a new position to perform kite
@@ -104,18 +85,20 @@ void BasicSc2Bot::KiteMarine(const Unit* marine, const Unit* target,
 
 // Main function to control Marines
 void BasicSc2Bot::ControlMarines() {
+	PROFILE_SCOPE("ControlMarines");
 	KillScouts();
 	TargetMarines();
 }
 
 // Target agressive scouts(Reapers) with Marines
 void BasicSc2Bot::KillScouts() {
+	PROFILE_SCOPE("KillScouts");
 
 	// Get all Marines
-	Units marines = Observation()->GetUnits(Unit::Alliance::Self,
-		IsUnit(UNIT_TYPEID::TERRAN_MARINE));
+	Units marines = Index().GetUnits(
+		Unit::Alliance::Self, UNIT_TYPEID::TERRAN_MARINE);
 	// Get all enemy units
-	Units enemies = Observation()->GetUnits(Unit::Alliance::Enemy);
+	Units enemies = Index().GetUnits(Unit::Alliance::Enemy);
 
 	// Check if there are no Marines or enemies
 	if (marines.empty() || enemies.empty()) {
@@ -138,10 +121,11 @@ void BasicSc2Bot::KillScouts() {
 
 // Target mechanics for Marines
 void BasicSc2Bot::TargetMarines() {
+	PROFILE_SCOPE("TargetMarines");
 
 	// Get all Marines
-	Units marines = Observation()->GetUnits(Unit::Alliance::Self,
-		IsUnit(UNIT_TYPEID::TERRAN_MARINE));
+	Units marines = Index().GetUnits(
+		Unit::Alliance::Self, UNIT_TYPEID::TERRAN_MARINE);
 	if (marines.empty()) { // Check if there are no Marines
 		return;
 	}
@@ -152,9 +136,90 @@ void BasicSc2Bot::TargetMarines() {
 		1.0f; // Distance to kite away for melee units
 	const float advance_distance = 0.5f; // Distance to close for ranged units
 
+	// Marine weapon, from the type data when it has one
+	const UnitTypes& unit_types = Observation()->GetUnitTypeData();
+	float marine_damage = 6.0f;
+	float marine_range = 5.0f;
+	int marine_attacks = 1;
+	const UnitTypeID marine_type = UNIT_TYPEID::TERRAN_MARINE;
+	if (marine_type < unit_types.size() &&
+		!unit_types[marine_type].weapons.empty()) {
+		const Weapon& weapon = unit_types[marine_type].weapons.front();
+		marine_damage = weapon.damage_;
+		marine_range = weapon.range;
+		marine_attacks = weapon.attacks;
+	}
+
+	// Spread the shots of the Marines ready to fire over the enemies in
+	// their range so they finish one off before moving to the next. The
+	// others kite this frame and don't count towards the damage.
+	Units ready;
+	for (const auto& marine : marines) {
+		if (marine->weapon_cooldown == 0.0f) {
+			ready.push_back(marine);
+		}
+	}
+	auto is_structure = [&unit_types](const Unit& enemy_unit) {
+		return enemy_unit.unit_type < unit_types.size() &&
+			std::find(unit_types[enemy_unit.unit_type].attributes.begin(),
+				unit_types[enemy_unit.unit_type].attributes.end(),
+				Attribute::Structure) !=
+			unit_types[enemy_unit.unit_type].attributes.end();
+	};
+	// Only what the Marines can see and shoot, no larva or eggs
+	auto can_attack = [](const Unit& enemy_unit) {
+		return enemy_unit.is_alive &&
+			enemy_unit.display_type == Unit::DisplayType::Visible &&
+			enemy_unit.cloak != Unit::CloakState::Cloaked &&
+			enemy_unit.unit_type != UNIT_TYPEID::ZERG_LARVA &&
+			enemy_unit.unit_type != UNIT_TYPEID::ZERG_EGG;
+	};
+	auto damage = [&](const Unit&, const Unit& enemy_unit) {
+		float armor = enemy_unit.unit_type < unit_types.size()
+			? unit_types[enemy_unit.unit_type].armor : 0.0f;
+		return std::max(marine_damage - armor, 0.5f) * marine_attacks;
+	};
+	std::vector<const Unit*> assigned = marine_focus_fire.Assign(
+		ready, EnemyGrid(), marine_range,
+		[&](const Unit& enemy_unit) {
+			return can_attack(enemy_unit) && !is_structure(enemy_unit);
+		}, damage);
+
+	// Marines with no unit in range go for the structures in range
+	Units idle;
+	for (size_t i = 0; i < ready.size(); ++i) {
+		if (!assigned[i]) {
+			idle.push_back(ready[i]);
+		}
+	}
+	if (!idle.empty()) {
+		const std::vector<const Unit*>& structures = marine_focus_fire.Assign(
+			idle, EnemyGrid(), marine_range,
+			[&](const Unit& enemy_unit) {
+				return can_attack(enemy_unit) && is_structure(enemy_unit);
+			}, damage);
+		size_t next_idle = 0;
+		for (auto& target : assigned) {
+			if (!target) {
+				target = structures[next_idle++];
+			}
+		}
+	}
+
+	// Marines attacking each target, sent as one command per target
+	std::vector<std::pair<const Unit*, Units>> attacks;
+
 	// For each Marine
+	size_t next_ready = 0;
 	for (const auto& marine : marines) {
-		const Unit* target = GetClosestTarget(marine);
+		// Marines kiting or with nothing in range go by the closest enemy
+		const Unit* target = nullptr;
+		if (marine->weapon_cooldown == 0.0f) {
+			target = assigned[next_ready++];
+		}
+		if (!target) {
+			target = GetClosestTarget(marine);
+		}
 
 		if (target) {
 			// Check if the target is a melee unit
@@ -175,8 +240,15 @@ void BasicSc2Bot::TargetMarines() {
 
 			// Attack whenever possible
 			if (marine->weapon_cooldown == 0.0f) {
-				Actions()->UnitCommand(marine, ABILITY_ID::ATTACK_ATTACK,
-					target);
+				auto group = std::find_if(attacks.begin(), attacks.end(),
+					[target](const std::pair<const Unit*, Units>& attack) {
+						return attack.first == target;
+					});
+				if (group == attacks.end()) {
+					attacks.emplace_back(target, Units());
+					group = attacks.end() - 1;
+				}
+				group->second.push_back(marine);
 			}
 			// Do not Kite if the ramp is intact and the Marine is near the ramp
 			else if (IsRampIntact() && IsNearRamp(marine)) {
@@ -209,4 +281,9 @@ void BasicSc2Bot::TargetMarines() {
 			}
 		}
 	}
+
+	for (const auto& attack : attacks) {
+		Actions()->UnitCommand(attack.second, ABILITY_ID::ATTACK_ATTACK,
+			attack.first);
+	}
 }
@@ -2,6 +2,7 @@
 
 // Main function to control SCVs
 void BasicSc2Bot::ControlSCVs() {
+	PROFILE_SCOPE("ControlSCVs");
 	SCVScoutEnemySpawn();
 	RetreatFromDanger();
 	UpdateRepairingSCVs();
@@ -15,11 +16,10 @@ void BasicSc2Bot::ControlSCVs() {
 
 // SCVs scout the map to find enemy bases
 void BasicSc2Bot::SCVScoutEnemySpawn() {
-	const sc2::ObservationInterface* observation = Observation();
-
+	PROFILE_SCOPE("SCVScoutEnemySpawn");
 	// Check if we have enough SCVs
-	sc2::Units scvs = observation->GetUnits(
-		sc2::Unit::Alliance::Self, sc2::IsUnit(sc2::UNIT_TYPEID::TERRAN_SCV));
+	sc2::Units scvs = Index().GetUnits(
+		sc2::Unit::Alliance::Self, sc2::UNIT_TYPEID::TERRAN_SCV);
 
 	if (scvs.empty() || scvs.size() < 12 || scout_complete) {
 		return;
@@ -41,7 +41,7 @@ void BasicSc2Bot::SCVScoutEnemySpawn() {
 			enemy_start_locations[current_scout_location_index]);
 		if (distance_to_target < 5.0f) {
 			// Check for enemy town halls
-			sc2::Units enemy_structures = observation->GetUnits(
+			sc2::Units enemy_structures = Index().GetUnits(
 				sc2::Unit::Alliance::Enemy, [](const sc2::Unit& unit) {
 					return unit.unit_type ==
 						sc2::UNIT_TYPEID::TERRAN_COMMANDCENTER ||
@@ -145,11 +145,12 @@ void BasicSc2Bot::SCVScoutEnemySpawn() {
 
 // SCVs retreat from dangerous situations (e.g., enemy rushes)
 void BasicSc2Bot::RetreatFromDanger() {
+	PROFILE_SCOPE("RetreatFromDanger");
 	// Iterate through all our units
-	for (const auto& unit : Observation()->GetUnits(Unit::Alliance::Self)) {
+	for (const auto& unit : Index().GetUnits(Unit::Alliance::Self)) {
 		// Only consider SCVs that are not the scouting SCV
 		if (unit->unit_type == UNIT_TYPEID::TERRAN_SCV && unit != scv_scout &&
-			!(Distance2D(unit->pos, enemy_start_location) < 20.0f)) {
+			!(GroundDistance(enemy_start_location, unit->pos) < 20.0f)) {
 
 			// Skip SCVs that are actively attacking
 			bool scv_is_attacking = false; // Renamed to avoid conflict
@@ -179,6 +180,7 @@ void BasicSc2Bot::RetreatFromDanger() {
 
 // SCVs repair damaged Battlecruisers during or after engagements
 void BasicSc2Bot::RepairUnits() {
+	PROFILE_SCOPE("RepairUnits");
 
 	// Radius around the base considered "at base".
 	const float base_radius = 20.0f;
@@ -215,6 +217,7 @@ void BasicSc2Bot::RepairUnits() {
 
 // SCVs repair damaged structures during enemy attacks
 void BasicSc2Bot::RepairStructures() {
+	PROFILE_SCOPE("RepairStructures");
 	const Unit* target = FindDamagedStructure();
 
 	// Repair the target if it is at the base
@@ -246,12 +249,13 @@ void BasicSc2Bot::RepairStructures() {
 }
 
 void BasicSc2Bot::UpdateRepairingSCVs() {
+	PROFILE_SCOPE("UpdateRepairingSCVs");
 	// if there are less than 6 repairing SCVs, add more to the scv_repairing
 	// set
 	const ObservationInterface* obs = Observation();
 
 	Units scvs =
-		obs->GetUnits(Unit::Alliance::Self, IsUnit(UNIT_TYPEID::TERRAN_SCV));
+		Index().GetUnits(Unit::Alliance::Self, UNIT_TYPEID::TERRAN_SCV);
 	Units scvs_gas = GetAllSCVsGettingGas();
 
 	// Add SCVs to the repairing set
@@ -302,6 +306,7 @@ void BasicSc2Bot::UpdateRepairingSCVs() {
 
 // SCVs attack in urgent situations (e.g., enemy attacking the main base)
 void BasicSc2Bot::SCVAttackEmergency() {
+	PROFILE_SCOPE("SCVAttackEmergency");
 	if (EnemyNearby(start_location, false, 25)) {
 
 		// If there are significant enemy combat units, send SCVs to attack
@@ -315,8 +320,8 @@ void BasicSc2Bot::SCVAttackEmergency() {
 			if (!main_base) {
 				return; // If we don't have a main base, exit
 			}
-			Units scvs = Observation()->GetUnits(
-				Unit::Alliance::Self, IsUnit(UNIT_TYPEID::TERRAN_SCV));
+			Units scvs = Index().GetUnits(
+				Unit::Alliance::Self, UNIT_TYPEID::TERRAN_SCV);
 			for (const auto& scv : scvs) {
 				// Only use SCVs that have the repair tag
 				if (scvs_repairing.find(scv->tag) != scvs_repairing.end()) {
@@ -2,6 +2,15 @@
 
 using namespace sc2;
 
+namespace {
+
+// Splash of a sieged tank's shot, the share of its damage taken within each
+// radius of the target
+const float kSplashRadius[3] = { 0.4687f, 0.7812f, 1.25f };
+const float kSplashDamage[3] = { 1.0f, 0.5f, 0.25f };
+
+} // namespace
+
 // ------------------ Helper Functions ------------------
 
 // Determine whether siege tank should transform to Siege Mode, or Unsiege
@@ -11,41 +20,31 @@ bool BasicSc2Bot::SiegeTankInCombat(const Unit* unit) {
 	}
 	// Detect radius of the Siege Tank
 	const float enemy_detection_radius = 13.5f;
-	bool enemy_nearby = false;
-	// Check for nearby enemies within the detection radius
-	for (const auto& enemy_unit :
-		Observation()->GetUnits(Unit::Alliance::Enemy)) {
-
-		// Skip trivial and worker units
-		if (IsTrivialUnit(enemy_unit) || IsWorkerUnit(enemy_unit)) {
-			continue;
-		}
-
-		// Calculate distance to enemy
-		float distance_to_enemy = Distance2D(unit->pos, enemy_unit->pos);
-		if (distance_to_enemy <= enemy_detection_radius) {
-			enemy_nearby = true;
-			break;
-		}
-	}
-	return enemy_nearby;
+	// Check for nearby enemies within the detection radius, skipping trivial
+	// and worker units
+	return EnemyGrid().AnyWithin(unit->pos, enemy_detection_radius,
+		[this](const Unit& enemy_unit) {
+			return !IsTrivialUnit(&enemy_unit) && !IsWorkerUnit(&enemy_unit);
+		});
 }
 
 // ------------------ Main Functions ------------------
 
 // Main function to control Siege Tanks
 void BasicSc2Bot::ControlSiegeTanks() {
+	PROFILE_SCOPE("ControlSiegeTanks");
 	SiegeMode();
 	TargetSiegeTank();
 }
 
 // Transform Siege Tanks to Siege Mode or Unsiege
 void BasicSc2Bot::SiegeMode() {
+	PROFILE_SCOPE("SiegeMode");
 	// Get all Siege Tanks
-	const Units siege_tanks = Observation()->GetUnits(
-		Unit::Alliance::Self, IsUnit(UNIT_TYPEID::TERRAN_SIEGETANK));
-	const Units siege_tanks_sieged = Observation()->GetUnits(
-		Unit::Alliance::Self, IsUnit(UNIT_TYPEID::TERRAN_SIEGETANKSIEGED));
+	const Units siege_tanks = Index().GetUnits(
+		Unit::Alliance::Self, UNIT_TYPEID::TERRAN_SIEGETANK);
+	const Units siege_tanks_sieged = Index().GetUnits(
+		Unit::Alliance::Self, UNIT_TYPEID::TERRAN_SIEGETANKSIEGED);
 
 	if (siege_tanks.empty() && siege_tanks_sieged.empty()) { // No Siege Tanks
 		return;
@@ -67,80 +66,82 @@ void BasicSc2Bot::SiegeMode() {
 
 // Target mechanics for Siege Tanks
 void BasicSc2Bot::TargetSiegeTank() {
+	PROFILE_SCOPE("TargetSiegeTank");
 
 	if (current_gameloop % 10 != 0)
 	{
 		return;
 	}
 	// Get all Siege Tanks
-	const Units siege_tanks_sieged = Observation()->GetUnits(
-		Unit::Alliance::Self, IsUnit(UNIT_TYPEID::TERRAN_SIEGETANKSIEGED));
+	const Units siege_tanks_sieged = Index().GetUnits(
+		Unit::Alliance::Self, UNIT_TYPEID::TERRAN_SIEGETANKSIEGED);
 
 	if (siege_tanks_sieged.empty()) {
 		return;
 	}
 
-	for (const auto& siege_tank : siege_tanks_sieged) {
-
-		// Initialize variables to find the best target
-		const Unit* best_target = nullptr;
-		float best_score = -1.0f;
-
-		// Get all enemy units
-		for (const auto& enemy_unit :
-			Observation()->GetUnits(Unit::Alliance::Enemy)) {
-			// Skip invalid or dead units
+	// Score every enemy once, only the distance depends on the tank
+	const Units& enemy_units = Index().GetUnits(Unit::Alliance::Enemy);
+	std::vector<std::pair<const Unit*, float>> targets;
+	targets.reserve(enemy_units.size());
+	for (const auto& enemy_unit : enemy_units) {
+		// Skip invalid or dead units
+		if (!enemy_unit || !enemy_unit->is_alive) {
+			continue;
+		}
 
-			if (!enemy_unit || !enemy_unit->is_alive) {
-				continue;
-			}
+		// Calculate priority score for this enemy
+		float score = 0.0f;
 
-			// Calculate priority score for this enemy
-			float score = 0.0f;
+		// 1. Priority: Heavy Armor (e.g., Stalkers, Marauiders...etc)
+		const bool heavy_armor = std::find(heavy_armor_units.begin(),
+			heavy_armor_units.end(), enemy_unit->unit_type) !=
+			heavy_armor_units.end();
+		if (heavy_armor) {
+			score += 200.0f;
+		}
 
-			// 1. Priority: Heavy Armor (e.g., Stalkers, Marauiders...etc)
-			if (std::find(heavy_armor_units.begin(), heavy_armor_units.end(),
-				enemy_unit->unit_type) != heavy_armor_units.end()) {
-				score += 200.0f;
-			}
+		// 2. Priority: Packed Enemies (AOE Potential)
+		// Add 10 points for each nearby enemy, scaled by the splash it takes
+		score += 10.0f * EnemyGrid().SumWithin(enemy_unit->pos,
+			kSplashRadius[2], [enemy_unit](const Unit& nearby_enemy, float d2) {
+				if (&nearby_enemy == enemy_unit) {
+					return 0.0f;
+				}
+				for (int i = 0; i < 3; ++i) {
+					if (d2 < kSplashRadius[i] * kSplashRadius[i]) {
+						return kSplashDamage[i];
+					}
+				}
+				return 0.0f;
+			});
 
-			// 2. Priority: Packed Enemies (AOE Potential)
-			int packed_count = 0;
+		// 3. Priority: Enemies close to one-shot
+		// Tank damage is 40(Light) or 70(Armored) in Siege Mode
+		float health_difference = std::abs(
+			(enemy_unit->health + enemy_unit->shield) -
+			(heavy_armor ? 70.0f : 40.0f));
 
-			for (const auto& nearby_enemy :
-				Observation()->GetUnits(Unit::Alliance::Enemy)) {
-				if (nearby_enemy != enemy_unit &&
-					Distance2D(enemy_unit->pos, nearby_enemy->pos) < 1.25f) {
-					packed_count++;
-				}
-			}
-			// Add 10 points for each nearby enemy
-			score += packed_count * 10.0f;
+		score += 200.0f / (health_difference + 1.0f);
 
-			// 3. Priority: Enemies close to one-shot
-			// Tank damage is 40(Light) or 70(Armored) in Siege Mode
-			float health_difference = 0.0f;
+		targets.emplace_back(enemy_unit, score);
+	}
 
-			if (std::find(heavy_armor_units.begin(), heavy_armor_units.end(),
-				enemy_unit->unit_type) != heavy_armor_units.end()) {
-				health_difference =
-					std::abs((enemy_unit->health + enemy_unit->shield) - 70.0f);
-			}
-			else {
-				health_difference =
-					std::abs((enemy_unit->health + enemy_unit->shield) - 40.0f);
-			}
+	for (const auto& siege_tank : siege_tanks_sieged) {
 
-			score += 200.0f / (health_difference + 1.0f);
+		// Initialize variables to find the best target
+		const Unit* best_target = nullptr;
+		float best_score = -1.0f;
 
+		for (const auto& target : targets) {
 			// 4. The Rest (Prioritize closer targets)
-			score +=
-				1.0f / (Distance2D(siege_tank->pos, enemy_unit->pos) + 1.0f);
+			float score = target.second +
+				1.0f / (Distance2D(siege_tank->pos, target.first->pos) + 1.0f);
 
 			// Update best target based on score
 			if (score > best_score) {
 				best_score = score;
-				best_target = enemy_unit;
+				best_target = target.first;
 			}
 		}
 
@@ -149,4 +150,4 @@ void BasicSc2Bot::TargetSiegeTank() {
 			Actions()->UnitCommand(siege_tank, ABILITY_ID::ATTACK, best_target);
 		}
 	}
-}
\ No newline at end of file
+}
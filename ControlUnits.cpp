@@ -2,6 +2,7 @@
 
 // Control all units
 void BasicSc2Bot::ControlUnits() {
+	PROFILE_SCOPE("ControlUnits");
 	ControlSCVs();
 	ControlBattlecruisers();
 	ControlSiegeTanks();
@@ -0,0 +1,207 @@
+#include "DangerField.h"
+
+#include "BitGrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace sc2;
+
+namespace {
+
+// Squared distance of cells without an enemy
+const float kFar = 1e30f;
+
+const int kNeighbourX[8] = { 1, -1, 0, 0, 1, 1, -1, -1 };
+const int kNeighbourY[8] = { 0, 0, 1, -1, 1, -1, 1, -1 };
+
+} // namespace
+
+void DangerField::Reset(const GameInfo& game_info) {
+	BitGrid grid;
+	grid.Decode(game_info.pathing_grid);
+	width = grid.Width();
+	height = grid.Height();
+	pathable = grid.Bytes();
+	nearest.assign(pathable.size(), -1);
+	distance_squared.assign(pathable.size(), kFar);
+	enemy_positions.clear();
+	visited.assign(pathable.size(), 0);
+	search = 0;
+	game_loop = 0;
+}
+
+int DangerField::Cell(const Point2D& p) const {
+	int x = static_cast<int>(p.x);
+	int y = static_cast<int>(p.y);
+	if (p.x < 0.0f || p.y < 0.0f || x >= width || y >= height) {
+		return -1;
+	}
+	return x + y * width;
+}
+
+void DangerField::Take(int cell, int x, int y, int from) {
+	int candidate = nearest[from];
+	if (candidate < 0 || candidate == nearest[cell]) {
+		return;
+	}
+	const Point2D& enemy = enemy_positions[candidate];
+	float dx = x + 0.5f - enemy.x;
+	float dy = y + 0.5f - enemy.y;
+	float d = dx * dx + dy * dy;
+	if (d < distance_squared[cell]) {
+		nearest[cell] = candidate;
+		distance_squared[cell] = d;
+	}
+}
+
+void DangerField::Build(const Units& enemies, float reach, uint32_t loop) {
+	game_loop = loop;
+	std::fill(nearest.begin(), nearest.end(), -1);
+	std::fill(distance_squared.begin(), distance_squared.end(), kFar);
+	enemy_positions.clear();
+	int x0 = width;
+	int y0 = height;
+	int x1 = 0;
+	int y1 = 0;
+	for (const auto& enemy : enemies) {
+		int cell = Cell(enemy->pos);
+		if (cell < 0) {
+			continue;
+		}
+		int x = cell % width;
+		int y = cell / width;
+		float d = DistanceSquared2D(enemy->pos, Point2D(x + 0.5f, y + 0.5f));
+		if (d < distance_squared[cell]) {
+			nearest[cell] = static_cast<int>(enemy_positions.size());
+			distance_squared[cell] = d;
+		}
+		enemy_positions.emplace_back(enemy->pos);
+		x0 = std::min(x0, x);
+		y0 = std::min(y0, y);
+		x1 = std::max(x1, x + 1);
+		y1 = std::max(y1, y + 1);
+	}
+	if (enemy_positions.empty()) {
+		return;
+	}
+
+	// Cells out of reach of the enemies' bounds are left without one
+	int margin = static_cast<int>(std::ceil(reach)) + 1;
+	x0 = std::max(x0 - margin, 0);
+	y0 = std::max(y0 - margin, 0);
+	x1 = std::min(x1 + margin, width);
+	y1 = std::min(y1 + margin, height);
+
+	// Up the map taking from the row below and the left, then back along
+	// the row taking from the right. Down the map mirrors it.
+	for (int y = y0; y < y1; ++y) {
+		int row = y * width;
+		for (int x = x0; x < x1; ++x) {
+			if (x > x0) {
+				Take(row + x, x, y, row + x - 1);
+			}
+			if (y > y0) {
+				Take(row + x, x, y, row + x - width);
+				if (x > x0) {
+					Take(row + x, x, y, row + x - width - 1);
+				}
+				if (x + 1 < x1) {
+					Take(row + x, x, y, row + x - width + 1);
+				}
+			}
+		}
+		for (int x = x1 - 2; x >= x0; --x) {
+			Take(row + x, x, y, row + x + 1);
+		}
+	}
+	for (int y = y1 - 1; y >= y0; --y) {
+		int row = y * width;
+		for (int x = x1 - 1; x >= x0; --x) {
+			if (x + 1 < x1) {
+				Take(row + x, x, y, row + x + 1);
+			}
+			if (y + 1 < y1) {
+				Take(row + x, x, y, row + x + width);
+				if (x + 1 < x1) {
+					Take(row + x, x, y, row + x + width + 1);
+				}
+				if (x > x0) {
+					Take(row + x, x, y, row + x + width - 1);
+				}
+			}
+		}
+		for (int x = x0 + 1; x < x1; ++x) {
+			Take(row + x, x, y, row + x - 1);
+		}
+	}
+}
+
+float DangerField::Distance(const Point2D& p) const {
+	int cell = Cell(p);
+	if (cell < 0 || nearest[cell] < 0) {
+		return -1.0f;
+	}
+	return Distance2D(p, enemy_positions[nearest[cell]]);
+}
+
+bool DangerField::Clear(const Point2D& p, float safe_squared) const {
+	for (const auto& enemy : enemy_positions) {
+		if (DistanceSquared2D(p, enemy) <= safe_squared) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool DangerField::SafePosition(const Point2D& p, float safe_radius,
+	int max_steps, Point2D& safe) const {
+	safe = p;
+	int cell = Cell(p);
+	if (cell < 0 || nearest[cell] < 0) {
+		return cell >= 0;
+	}
+	const float safe_squared = safe_radius * safe_radius;
+	if (distance_squared[cell] > safe_squared && Clear(p, safe_squared)) {
+		return true;
+	}
+
+	// Stamp the cells of this search rather than clearing them all
+	if (++search == 0) {
+		std::fill(visited.begin(), visited.end(), 0);
+		search = 1;
+	}
+	queue.clear();
+	queue.emplace_back(cell, 0);
+	visited[cell] = search;
+	int furthest = cell;
+	for (size_t next = 0; next < queue.size(); ++next) {
+		int x = queue[next].first % width;
+		int y = queue[next].first / width;
+		int steps = queue[next].second;
+		if (steps >= max_steps) {
+			continue;
+		}
+		for (int i = 0; i < 8; ++i) {
+			int nx = x + kNeighbourX[i];
+			int ny = y + kNeighbourY[i];
+			int neighbour = nx + ny * width;
+			if (nx < 0 || ny < 0 || nx >= width || ny >= height ||
+				!pathable[neighbour] || visited[neighbour] == search) {
+				continue;
+			}
+			visited[neighbour] = search;
+			if (distance_squared[neighbour] > safe_squared &&
+				Clear(Point2D(nx + 0.5f, ny + 0.5f), safe_squared)) {
+				safe = Point2D(nx + 0.5f, ny + 0.5f);
+				return true;
+			}
+			if (distance_squared[neighbour] > distance_squared[furthest]) {
+				furthest = neighbour;
+			}
+			queue.emplace_back(neighbour, steps + 1);
+		}
+	}
+	safe = Point2D(furthest % width + 0.5f, furthest / width + 0.5f);
+	return false;
+}
@@ -0,0 +1,75 @@
+#ifndef DANGER_FIELD_H_
+#define DANGER_FIELD_H_
+
+#include "sc2api/sc2_common.h"
+#include "sc2api/sc2_gametypes.h"
+#include "sc2api/sc2_unit.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Distance from every map cell to the closest enemy.
+// Built with a forward and a backward sweep over the map, each cell taking
+// the closest enemy of the neighbours already swept, so the distances are
+// straight lines to real enemy positions rather than sums of steps. They
+// cross cliffs, since ranged enemies shoot across them. Retreats search
+// for a safe cell through pathable cells only.
+class DangerField {
+public:
+	// Decodes the pathing grid of the map
+	void Reset(const sc2::GameInfo& game_info);
+
+	// True once Reset() has been called
+	bool Initialized() const { return width > 0; }
+
+	// Game loop the enemies were seeded on
+	uint32_t GameLoop() const { return game_loop; }
+
+	// Seeds the enemies and rebuilds the field over their bounds grown by
+	// reach, cells beyond it count as having no enemy near
+	void Build(const sc2::Units& enemies, float reach, uint32_t game_loop);
+
+	// Distance in cells to the closest enemy, negative if none is near
+	float Distance(const sc2::Point2D& p) const;
+
+	// Closest pathable cell further than safe_radius from every enemy,
+	// searching outward from p at most max_steps steps. Returns false if
+	// there is none; safe is then the furthest cell searched.
+	bool SafePosition(const sc2::Point2D& p, float safe_radius,
+		int max_steps, sc2::Point2D& safe) const;
+
+private:
+	int Cell(const sc2::Point2D& p) const;
+
+	// True if no enemy is within the squared distance of p. The sweeps
+	// can be off by a fraction of a cell where enemies are close together.
+	bool Clear(const sc2::Point2D& p, float safe_squared) const;
+
+	// Takes the closest enemy of from if it beats the cell's own
+	void Take(int cell, int x, int y, int from);
+
+	int width = 0;
+	int height = 0;
+
+	// Row-major from the bottom left
+	std::vector<uint8_t> pathable;
+
+	// Positions of the enemies and the closest one to every cell, -1 if
+	// there are none
+	std::vector<sc2::Point2D> enemy_positions;
+	std::vector<int> nearest;
+
+	// Squared distance from the center of every cell to its closest enemy
+	std::vector<float> distance_squared;
+
+	// Scratch of the safe position search, the search a cell was last
+	// visited by and the cells to visit with their steps from the start
+	mutable std::vector<uint32_t> visited;
+	mutable uint32_t search = 0;
+	mutable std::vector<std::pair<int, int>> queue;
+
+	uint32_t game_loop = 0;
+};
+
+#endif
@@ -2,6 +2,7 @@
 
 // Defense Management
 void BasicSc2Bot::Defense() {
+	PROFILE_SCOPE("Defense");
 	EarlyDefense();
 	if (current_gameloop % 42 == 0) {
 		LateDefense();
@@ -9,17 +10,18 @@ void BasicSc2Bot::Defense() {
 }
 
 void BasicSc2Bot::EarlyDefense() {
+	PROFILE_SCOPE("EarlyDefense");
 	if (!IsAnyBaseUnderAttack()) { // No bases under attack
 		return;
 	}
 
 	Units our_bases =
-		Observation()->GetUnits(Unit::Alliance::Self, IsTownHall());
+		Index().GetTownHalls(Unit::Alliance::Self);
 
 	// Collect enemy units near our bases
 	Units enemy_units;
 	for (const auto& base : our_bases) {
-		Units enemies_near_base = Observation()->GetUnits(
+		Units enemies_near_base = Index().GetUnits(
 			Unit::Alliance::Enemy, [base](const Unit& unit) {
 				return Distance2D(unit.pos, base->pos) < 20.0f &&
 					unit.display_type == Unit::DisplayType::Visible;
@@ -42,8 +44,8 @@ void BasicSc2Bot::EarlyDefense() {
 	}
 
 	// Get and manage our combat units
-	Units marines = Observation()->GetUnits(Unit::Alliance::Self,
-		IsUnit(UNIT_TYPEID::TERRAN_MARINE));
+	Units marines = Index().GetUnits(
+		Unit::Alliance::Self, UNIT_TYPEID::TERRAN_MARINE);
 
 	// Command marines
 	for (const auto& marine : marines) {
@@ -58,16 +60,17 @@ void BasicSc2Bot::EarlyDefense() {
 
 // Builds additional defense structures like Missile Turrets.
 void BasicSc2Bot::LateDefense() {
+	PROFILE_SCOPE("LateDefense");
 	// Check if we have an Engineering Bay (required for Missile Turrets)
-	Units engineering_bays = Observation()->GetUnits(
-		Unit::Alliance::Self, IsUnit(UNIT_TYPEID::TERRAN_ENGINEERINGBAY));
+	Units engineering_bays = Index().GetUnits(
+		Unit::Alliance::Self, UNIT_TYPEID::TERRAN_ENGINEERINGBAY);
 	if (engineering_bays.empty()) {
 		return; // Can't build Missile Turrets without an Engineering Bay
 	}
 
 	// Build Missile Turrets near bases and important locations
-	Units missile_turrets = Observation()->GetUnits(
-		Unit::Alliance::Self, IsUnit(UNIT_TYPEID::TERRAN_MISSILETURRET));
+	Units missile_turrets = Index().GetUnits(
+		Unit::Alliance::Self, UNIT_TYPEID::TERRAN_MISSILETURRET);
 
 	std::vector<Point2D> turret_locations;
 	std::vector<Point2D> mineral_convexhull = main_mineral_convexHull;
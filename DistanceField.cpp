@@ -0,0 +1,365 @@
+#include "DistanceField.h"
+
+#include "BitGrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace sc2;
+
+namespace {
+
+const int kStraight = 10;
+const int kDiagonal = 14;
+
+// Sources further than this from a pathable cell are unreachable
+const int kMaxSourceSearch = 8;
+
+// Fields computed on demand beyond this replace the oldest one
+const size_t kMaxFields = 64;
+
+const int kNeighbourX[8] = { 1, -1, 0, 0, 1, 1, -1, -1 };
+const int kNeighbourY[8] = { 0, 0, 1, -1, 1, -1, 1, -1 };
+const int kNeighbourCost[8] = { kStraight, kStraight, kStraight, kStraight,
+	kDiagonal, kDiagonal, kDiagonal, kDiagonal };
+
+uint16_t AddCost(uint16_t distance, int cost) {
+	return static_cast<uint16_t>(
+		std::min<int>(distance + cost, DistanceField::kUnreachable - 1));
+}
+
+} // namespace
+
+const uint16_t DistanceField::kUnreachable;
+const int DistanceField::kBuckets;
+
+void DistanceField::Reset(const std::vector<uint8_t>* pathable_mask,
+	int field_width, int field_height, const Point2D& source_point) {
+	pathable = pathable_mask;
+	width = field_width;
+	height = field_height;
+	source = source_point;
+	distances.assign(static_cast<size_t>(width) * height, kUnreachable);
+	orphaned.assign(distances.size(), 0);
+	seeds.clear();
+
+	// Seed the closest ring of pathable cells around the source
+	int sx = static_cast<int>(source.x);
+	int sy = static_cast<int>(source.y);
+	for (int r = 0; r <= kMaxSourceSearch && seeds.empty(); ++r) {
+		for (int y = sy - r; y <= sy + r; ++y) {
+			for (int x = sx - r; x <= sx + r; ++x) {
+				if (std::max(std::abs(x - sx), std::abs(y - sy)) != r ||
+					x < 0 || y < 0 || x >= width || y >= height ||
+					!Pathable(x + y * width)) {
+					continue;
+				}
+				int cell = x + y * width;
+				float dx = x + 0.5f - source.x;
+				float dy = y + 0.5f - source.y;
+				distances[cell] = static_cast<uint16_t>(
+					kStraight * std::sqrt(dx * dx + dy * dy) + 0.5f);
+				seeds.emplace_back(distances[cell], cell);
+			}
+		}
+	}
+	Propagate();
+}
+
+void DistanceField::Propagate() {
+	// Dial's algorithm: settle the distances in increasing order, taking the
+	// seeds in sorted order and the relaxed cells from circular buckets
+	std::sort(seeds.begin(), seeds.end());
+	size_t next_seed = 0;
+	size_t pending = 0;
+	int current = 0;
+	while (next_seed < seeds.size() || pending > 0) {
+		if (pending == 0) {
+			current = seeds[next_seed].first;
+		}
+		std::vector<int>& bucket = buckets[current % kBuckets];
+		for (; next_seed < seeds.size() && seeds[next_seed].first == current;
+			++next_seed) {
+			bucket.push_back(seeds[next_seed].second);
+			++pending;
+		}
+		while (!bucket.empty()) {
+			int cell = bucket.back();
+			bucket.pop_back();
+			--pending;
+			if (distances[cell] != current) {
+				continue;
+			}
+			int x = cell % width;
+			int y = cell / width;
+			for (int i = 0; i < 8; ++i) {
+				int nx = x + kNeighbourX[i];
+				int ny = y + kNeighbourY[i];
+				if (nx < 0 || ny < 0 || nx >= width || ny >= height) {
+					continue;
+				}
+				int neighbour = nx + ny * width;
+				uint16_t distance = AddCost(distances[cell], kNeighbourCost[i]);
+				if (Pathable(neighbour) && distance < distances[neighbour]) {
+					distances[neighbour] = distance;
+					buckets[distance % kBuckets].push_back(neighbour);
+					++pending;
+				}
+			}
+		}
+		++current;
+	}
+	seeds.clear();
+}
+
+void DistanceField::Reseed(int cell) {
+	int x = cell % width;
+	int y = cell / width;
+	uint16_t best = kUnreachable;
+	for (int i = 0; i < 8; ++i) {
+		int nx = x + kNeighbourX[i];
+		int ny = y + kNeighbourY[i];
+		if (nx < 0 || ny < 0 || nx >= width || ny >= height) {
+			continue;
+		}
+		uint16_t distance = distances[nx + ny * width];
+		if (distance != kUnreachable) {
+			best = std::min(best, AddCost(distance, kNeighbourCost[i]));
+		}
+	}
+	distances[cell] = best;
+	if (distances[cell] != kUnreachable) {
+		seeds.emplace_back(distances[cell], cell);
+	}
+}
+
+bool DistanceField::NearSource(const std::vector<int>& cells) const {
+	int sx = static_cast<int>(source.x);
+	int sy = static_cast<int>(source.y);
+	for (int cell : cells) {
+		if (std::abs(cell % width - sx) <= kMaxSourceSearch &&
+			std::abs(cell / width - sy) <= kMaxSourceSearch) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void DistanceField::Block(const std::vector<int>& cells) {
+	// The cells seeded around the source may change, start over
+	if (NearSource(cells)) {
+		Reset(pathable, width, height, source);
+		return;
+	}
+
+	// Find the cells whose shortest path went through the blocked ones.
+	// A cell is orphaned when no neighbour outside the orphans still gives
+	// it its distance.
+	std::vector<int> stack;
+	std::vector<int> orphans;
+	for (int cell : cells) {
+		if (!orphaned[cell]) {
+			orphaned[cell] = 1;
+			orphans.push_back(cell);
+			if (distances[cell] != kUnreachable) {
+				stack.push_back(cell);
+			}
+		}
+	}
+	while (!stack.empty()) {
+		int cell = stack.back();
+		stack.pop_back();
+		int x = cell % width;
+		int y = cell / width;
+		for (int i = 0; i < 8; ++i) {
+			int nx = x + kNeighbourX[i];
+			int ny = y + kNeighbourY[i];
+			if (nx < 0 || ny < 0 || nx >= width || ny >= height) {
+				continue;
+			}
+			int neighbour = nx + ny * width;
+			uint16_t distance = distances[neighbour];
+			if (orphaned[neighbour] || distance == kUnreachable ||
+				distance != AddCost(distances[cell], kNeighbourCost[i])) {
+				continue;
+			}
+			bool supported = false;
+			for (int j = 0; j < 8 && !supported; ++j) {
+				int mx = nx + kNeighbourX[j];
+				int my = ny + kNeighbourY[j];
+				if (mx < 0 || my < 0 || mx >= width || my >= height) {
+					continue;
+				}
+				int support = mx + my * width;
+				supported = !orphaned[support] && Pathable(support) &&
+					distances[support] != kUnreachable &&
+					AddCost(distances[support], kNeighbourCost[j]) == distance;
+			}
+			if (!supported) {
+				orphaned[neighbour] = 1;
+				orphans.push_back(neighbour);
+				stack.push_back(neighbour);
+			}
+		}
+	}
+
+	for (int cell : orphans) {
+		distances[cell] = kUnreachable;
+	}
+	for (int cell : orphans) {
+		orphaned[cell] = 0;
+		if (Pathable(cell)) {
+			Reseed(cell);
+		}
+	}
+	Propagate();
+}
+
+void DistanceField::Unblock(const std::vector<int>& cells) {
+	if (NearSource(cells)) {
+		Reset(pathable, width, height, source);
+		return;
+	}
+	for (int cell : cells) {
+		Reseed(cell);
+	}
+	Propagate();
+}
+
+float DistanceField::Distance(const Point2D& p) const {
+	int px = static_cast<int>(p.x);
+	int py = static_cast<int>(p.y);
+	uint16_t distance = Raw(px, py);
+	if (distance != kUnreachable) {
+		return distance / static_cast<float>(kStraight);
+	}
+	// Inside a structure or off the pathing grid, go through the closest
+	// reachable cell around it
+	const int max_search = 3;
+	float best = -1.0f;
+	for (int r = 1; r <= max_search && best < 0.0f; ++r) {
+		for (int y = py - r; y <= py + r; ++y) {
+			for (int x = px - r; x <= px + r; ++x) {
+				if (std::max(std::abs(x - px), std::abs(y - py)) != r) {
+					continue;
+				}
+				distance = Raw(x, y);
+				if (distance == kUnreachable) {
+					continue;
+				}
+				float candidate = distance / static_cast<float>(kStraight) +
+					Distance2D(p, Point2D(x + 0.5f, y + 0.5f));
+				if (best < 0.0f || candidate < best) {
+					best = candidate;
+				}
+			}
+		}
+	}
+	return best;
+}
+
+void GroundDistances::Reset(const GameInfo& game_info) {
+	BitGrid grid;
+	grid.Decode(game_info.pathing_grid);
+	width = grid.Width();
+	height = grid.Height();
+	terrain = grid.Bytes();
+	pathable = terrain;
+	stamped.assign(terrain.size(), 0);
+	footprints.clear();
+	applied.clear();
+	fields.clear();
+	pending.clear();
+	game_loop = 0;
+}
+
+void GroundDistances::Clear(uint32_t loop) {
+	footprints.clear();
+	game_loop = loop;
+}
+
+void GroundDistances::Stamp(const Point2D& center, float footprint_radius) {
+	int x0 = static_cast<int>(std::floor(center.x - footprint_radius + 0.5f));
+	int y0 = static_cast<int>(std::floor(center.y - footprint_radius + 0.5f));
+	int size = static_cast<int>(2.0f * footprint_radius + 0.5f);
+	footprints.push_back({ x0, y0, size, size });
+}
+
+void GroundDistances::StampMineral(const Point2D& center) {
+	// Mineral fields are two cells wide and one high
+	int x0 = static_cast<int>(std::floor(center.x - 0.5f));
+	int y0 = static_cast<int>(std::floor(center.y));
+	footprints.push_back({ x0, y0, 2, 1 });
+}
+
+void GroundDistances::Apply() {
+	// Most frames stamp the same structures as the last one
+	if (footprints == applied) {
+		return;
+	}
+	applied = footprints;
+
+	std::fill(stamped.begin(), stamped.end(), 0);
+	for (const auto& footprint : footprints) {
+		int x0 = footprint[0];
+		int y0 = footprint[1];
+		for (int y = std::max(y0, 0);
+			y < std::min(y0 + footprint[3], height); ++y) {
+			for (int x = std::max(x0, 0);
+				x < std::min(x0 + footprint[2], width); ++x) {
+				stamped[x + y * width] = 1;
+			}
+		}
+	}
+
+	std::vector<int> blocked;
+	std::vector<int> unblocked;
+	for (size_t i = 0; i < terrain.size(); ++i) {
+		uint8_t value = terrain[i] && !stamped[i] ? 1 : 0;
+		if (value != pathable[i]) {
+			pathable[i] = value;
+			(value ? unblocked : blocked).push_back(static_cast<int>(i));
+		}
+	}
+	if (blocked.empty() && unblocked.empty()) {
+		return;
+	}
+	for (auto& field : fields) {
+		if (!blocked.empty()) {
+			field->Block(blocked);
+		}
+		if (!unblocked.empty()) {
+			field->Unblock(unblocked);
+		}
+	}
+}
+
+void GroundDistances::Prepare(const Point2D& source) {
+	pending.push_back(source);
+}
+
+bool GroundDistances::PrepareNext() {
+	if (pending.empty()) {
+		return false;
+	}
+	Field(pending.front());
+	pending.erase(pending.begin());
+	return true;
+}
+
+const DistanceField& GroundDistances::Field(const Point2D& source) {
+	int x = static_cast<int>(source.x);
+	int y = static_cast<int>(source.y);
+	for (const auto& field : fields) {
+		if (static_cast<int>(field->Source().x) == x &&
+			static_cast<int>(field->Source().y) == y) {
+			return *field;
+		}
+	}
+	if (fields.size() >= kMaxFields) {
+		fields.erase(fields.begin());
+	}
+	fields.emplace_back(new DistanceField());
+	fields.back()->Reset(&pathable, width, height, source);
+	return *fields.back();
+}
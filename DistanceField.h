@@ -0,0 +1,140 @@
+#ifndef DISTANCE_FIELD_H_
+#define DISTANCE_FIELD_H_
+
+#include "sc2api/sc2_common.h"
+#include "sc2api/sc2_gametypes.h"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Ground distance from a source to every pathable cell, in tenths of a
+// cell. Straight steps cost 10 and diagonal steps 14; diagonals may cut
+// corners, so distances are slightly optimistic around cliffs.
+// Block() and Unblock() repair the field in place when structures change
+// the pathing, only touching the cells whose distance changes.
+class DistanceField {
+public:
+	static const uint16_t kUnreachable = 0xFFFF;
+
+	// Computes the field over a row-major pathable mask from the bottom left.
+	// The mask must outlive the field. An unpathable source is replaced by
+	// the closest pathable cells around it.
+	void Reset(const std::vector<uint8_t>* pathable, int width, int height,
+		const sc2::Point2D& source);
+
+	// Cell the field was computed from
+	const sc2::Point2D& Source() const { return source; }
+
+	// Repairs the field after the cells were removed from the mask
+	void Block(const std::vector<int>& cells);
+
+	// Repairs the field after the cells were added to the mask
+	void Unblock(const std::vector<int>& cells);
+
+	// Distance to the cell in tenths of a cell, kUnreachable if there is no
+	// ground path
+	uint16_t Raw(int x, int y) const {
+		if (x < 0 || y < 0 || x >= width || y >= height) {
+			return kUnreachable;
+		}
+		return distances[x + y * width];
+	}
+
+	// Ground distance to the point in cells, negative if there is no ground
+	// path. Points inside structures use the closest reachable cell around
+	// them.
+	float Distance(const sc2::Point2D& p) const;
+
+private:
+	bool Pathable(int cell) const { return (*pathable)[cell] != 0; }
+
+	// Lowers the distances reachable from the queued cells
+	void Propagate();
+
+	// Pushes the cell with its best distance through a reachable neighbour
+	void Reseed(int cell);
+
+	// True if the cells are close enough to change how the source is seeded
+	bool NearSource(const std::vector<int>& cells) const;
+
+	const std::vector<uint8_t>* pathable = nullptr;
+	int width = 0;
+	int height = 0;
+	sc2::Point2D source;
+	std::vector<uint16_t> distances;
+
+	// Edges cost at most 14, so the pending distances always fit in this
+	// many buckets past the one being settled
+	static const int kBuckets = 16;
+
+	// Scratch space of the searches, cells to settle from with their
+	// distance and the cells waiting to be settled by distance
+	std::vector<std::pair<uint16_t, int>> seeds;
+	std::vector<int> buckets[kBuckets];
+	std::vector<uint8_t> orphaned;
+};
+
+// Ground distance fields over the map's pathing grid with structures
+// stamped on it, keyed by source cell. Fields are computed the first time a
+// source is used and repaired when the stamped structures change.
+class GroundDistances {
+public:
+	// Decodes the pathing grid of the map and drops every field
+	void Reset(const sc2::GameInfo& game_info);
+
+	// True once Reset() has been called
+	bool Initialized() const { return width > 0; }
+
+	// Game loop the structures were stamped on
+	uint32_t GameLoop() const { return game_loop; }
+
+	// Starts a new set of structure footprints
+	void Clear(uint32_t game_loop);
+
+	// Marks the square footprint of a structure as unpathable once applied
+	void Stamp(const sc2::Point2D& center, float footprint_radius);
+
+	// Marks the 2x1 footprint of a mineral field as unpathable once applied
+	void StampMineral(const sc2::Point2D& center);
+
+	// Applies the footprints stamped since Clear(), repairing the fields
+	// where the pathing changed
+	void Apply();
+
+	// Computes the field of the source now if it doesn't exist yet
+	const DistanceField& Field(const sc2::Point2D& source);
+
+	// Queues the source to be computed by a later PrepareNext()
+	void Prepare(const sc2::Point2D& source);
+
+	// Computes the oldest queued field, false if none is left
+	bool PrepareNext();
+
+	// Ground distance in cells from the source to the point, negative if
+	// there is no ground path
+	float Distance(const sc2::Point2D& source, const sc2::Point2D& p) {
+		return Field(source).Distance(p);
+	}
+
+private:
+	int width = 0;
+	int height = 0;
+
+	// Pathing grid of the map, and with the structures removed
+	std::vector<uint8_t> terrain;
+	std::vector<uint8_t> pathable;
+
+	// Footprints stamped since Clear() and at the last Apply() as
+	// { x, y, width, height } of their lower left cell, and their cells
+	std::vector<std::array<int, 4>> footprints;
+	std::vector<std::array<int, 4>> applied;
+	std::vector<uint8_t> stamped;
+
+	std::vector<std::unique_ptr<DistanceField>> fields;
+	std::vector<sc2::Point2D> pending;
+	uint32_t game_loop = 0;
+};
+
+#endif
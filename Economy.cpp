@@ -3,6 +3,7 @@
 using namespace sc2;
 
 void BasicSc2Bot::ManageEconomy() {
+	PROFILE_SCOPE("ManageEconomy");
 	TrainSCVs();
 	AssignWorkers();
 	TryBuildSupplyDepot();
@@ -18,10 +19,11 @@ void BasicSc2Bot::ManageEconomy() {
 }
 
 void BasicSc2Bot::TrainSCVs() {
+	PROFILE_SCOPE("TrainSCVs");
 	const ObservationInterface* obs = Observation();
 
 	// Get all bases
-	Units command_centers = obs->GetUnits(Unit::Alliance::Self, IsTownHall());
+	Units command_centers = Index().GetTownHalls(Unit::Alliance::Self);
 	if (command_centers.empty())
 		return;
 
@@ -36,12 +38,12 @@ void BasicSc2Bot::TrainSCVs() {
 
 	// If we have enough SCVs, return
 	Units scvs =
-		obs->GetUnits(Unit::Alliance::Self, IsUnit(UNIT_TYPEID::TERRAN_SCV));
+		Index().GetUnits(Unit::Alliance::Self, UNIT_TYPEID::TERRAN_SCV);
 	if (scvs.size() >= desired_scv_count)
 		return;
 
 	// Get all completed Supply Depots
-	Units dps = obs->GetUnits(Unit::Alliance::Self, [](const Unit& unit) {
+	Units dps = Index().GetUnits(Unit::Alliance::Self, [](const Unit& unit) {
 		return unit.unit_type == UNIT_TYPEID::TERRAN_SUPPLYDEPOT &&
 			!(unit.build_progress < 0.5f);
 		});
@@ -72,11 +74,10 @@ void BasicSc2Bot::TrainSCVs() {
 }
 
 void BasicSc2Bot::UseMULE() {
-	const ObservationInterface* observation = Observation();
-
+	PROFILE_SCOPE("UseMULE");
 	// Find all Orbital Commands
-	Units orbital_commands = observation->GetUnits(
-		Unit::Alliance::Self, IsUnit(UNIT_TYPEID::TERRAN_ORBITALCOMMAND));
+	Units orbital_commands = Index().GetUnits(
+		Unit::Alliance::Self, UNIT_TYPEID::TERRAN_ORBITALCOMMAND);
 
 	// No Orbital Commands found
 	if (orbital_commands.empty()) {
@@ -96,7 +97,7 @@ void BasicSc2Bot::UseMULE() {
 	for (const auto& orbital : orbital_commands) {
 		if (orbital->energy >= energy_cost) {
 			// Find the nearest mineral patch to the Orbital Command
-			Units mineral_patches = observation->GetUnits(
+			Units mineral_patches = Index().GetUnits(
 				Unit::Alliance::Neutral, IsMineralPatch());
 			const Unit* closest_mineral = nullptr;
 			float min_distance = std::numeric_limits<float>::max();
@@ -120,11 +121,10 @@ void BasicSc2Bot::UseMULE() {
 }
 
 void BasicSc2Bot::UseScan() {
-	const ObservationInterface* observation = Observation();
-
+	PROFILE_SCOPE("UseScan");
 	// Find all Orbital Commands
-	Units orbital_commands = observation->GetUnits(
-		Unit::Alliance::Self, IsUnit(UNIT_TYPEID::TERRAN_ORBITALCOMMAND));
+	Units orbital_commands = Index().GetUnits(
+		Unit::Alliance::Self, UNIT_TYPEID::TERRAN_ORBITALCOMMAND);
 
 	// No Orbital Commands found
 	if (orbital_commands.empty()) {
@@ -132,7 +132,7 @@ void BasicSc2Bot::UseScan() {
 	}
 
 	// Find all cloacked enemies
-	Units enemies = observation->GetUnits(Unit::Alliance::Enemy);
+	Units enemies = Index().GetUnits(Unit::Alliance::Enemy);
 	const Unit* cloacked_enemy = nullptr;
 	for (const auto& enemy : enemies) {
 		if (enemy->cloak == 1) {
@@ -155,7 +155,6 @@ void BasicSc2Bot::UseScan() {
 
 bool BasicSc2Bot::TryBuildStructure(ABILITY_ID ability_type_for_structure,
 	UNIT_TYPEID unit_type) {
-	const ObservationInterface* obs = Observation();
 	if (!CanBuild(100)) {
 		return false; // Not enough minerals to build
 	}
@@ -168,7 +167,7 @@ bool BasicSc2Bot::TryBuildStructure(ABILITY_ID ability_type_for_structure,
 
 	// Find an SCV to build with
 	Units scvs =
-		obs->GetUnits(Unit::Alliance::Self, IsUnit(UNIT_TYPEID::TERRAN_SCV));
+		Index().GetUnits(Unit::Alliance::Self, UNIT_TYPEID::TERRAN_SCV);
 	Units scvs_gas = GetAllSCVsGettingGas();
 
 	// Check if we have a builder
@@ -234,7 +233,7 @@ bool BasicSc2Bot::TryBuildStructure(ABILITY_ID ability_type_for_structure,
 					Query()->Placement(ABILITY_ID::BUILD_SUPPLYDEPOT,
 						mainBase_depot_points[i])) {
 					scv_building = builder;
-					Actions()->UnitCommand(builder, ability_type_for_structure,
+					OrderBuild(builder, ability_type_for_structure,
 						mainBase_depot_points[i], true);
 					return true;
 				}
@@ -246,7 +245,7 @@ bool BasicSc2Bot::TryBuildStructure(ABILITY_ID ability_type_for_structure,
 
 		else if (ability_type_for_structure == ABILITY_ID::BUILD_BARRACKS) {
 			Units barracks =
-				obs->GetUnits(Unit::Alliance::Self, [this](const Unit& unit) {
+				Index().GetUnits(Unit::Alliance::Self, [this](const Unit& unit) {
 				return unit.unit_type == UNIT_TYPEID::TERRAN_BARRACKS &&
 					ALLBuildingsFilter(unit);
 					});
@@ -256,7 +255,7 @@ bool BasicSc2Bot::TryBuildStructure(ABILITY_ID ability_type_for_structure,
 				if (phase == 0) {
 					if (Query()->Placement(ABILITY_ID::BUILD_BARRACKS,
 						mainBase_barrack_point)) {
-						Actions()->UnitCommand(scv_building,
+						OrderBuild(scv_building,
 							ability_type_for_structure,
 							mainBase_barrack_point, true);
 						return true;
@@ -269,7 +268,7 @@ bool BasicSc2Bot::TryBuildStructure(ABILITY_ID ability_type_for_structure,
 						ramp_mid_destroyed->unit_type ==
 						UNIT_TYPEID::TERRAN_BARRACKS &&
 						!EnemyNearby(mainBase_barrack_point, false)) {
-						Actions()->UnitCommand(scv_building,
+						OrderBuild(scv_building,
 							ability_type_for_structure,
 							mainBase_barrack_point, true);
 						return true;
@@ -278,12 +277,12 @@ bool BasicSc2Bot::TryBuildStructure(ABILITY_ID ability_type_for_structure,
 					// possibly
 					else {
 						// if addons are still there, build around the addons
-						Units addons_t = obs->GetUnits(
+						Units addons_t = Index().GetUnits(
 							Unit::Alliance::Self, [](const Unit& unit) {
 								return unit.unit_type ==
 									UNIT_TYPEID::TERRAN_TECHLAB;
 							});
-						Units addons_r = obs->GetUnits(
+						Units addons_r = Index().GetUnits(
 							Unit::Alliance::Self, [](const Unit& unit) {
 								return unit.unit_type ==
 									UNIT_TYPEID::TERRAN_REACTOR;
@@ -299,21 +298,20 @@ bool BasicSc2Bot::TryBuildStructure(ABILITY_ID ability_type_for_structure,
 							if (!EnemyNearby(tl_p, false) &&
 								Query()->Placement(ability_type_for_structure,
 									tl_p)) {
-								Actions()->UnitCommand(
+								OrderBuild(
 									builder, ability_type_for_structure, tl_p);
 								return true;
 							}
 						}
 					}
 					return build33_after_check(builder,
-						ability_type_for_structure,
-						base_location, true);
+						ability_type_for_structure, true);
 				}
 			}
 		}
 		else if (ability_type_for_structure == ABILITY_ID::BUILD_FACTORY) {
 			Units factory =
-				obs->GetUnits(Unit::Alliance::Self, [this](const Unit& unit) {
+				Index().GetUnits(Unit::Alliance::Self, [this](const Unit& unit) {
 				return unit.unit_type == UNIT_TYPEID::TERRAN_FACTORY &&
 					ALLBuildingsFilter(unit);
 					});
@@ -321,14 +319,13 @@ bool BasicSc2Bot::TryBuildStructure(ABILITY_ID ability_type_for_structure,
 				// check if ramp is blocked
 				if (phase < 2) {
 					return build33_after_check(builder,
-						ability_type_for_structure,
-						base_location, true);
+						ability_type_for_structure, true);
 				}
 				else if (!ramp_middle[0] &&
 					ramp_mid_destroyed->unit_type ==
 					UNIT_TYPEID::TERRAN_FACTORY &&
 					!EnemyNearby(mainBase_barrack_point)) {
-					Actions()->UnitCommand(scv_building,
+					OrderBuild(scv_building,
 						ability_type_for_structure,
 						mainBase_barrack_point, true);
 					return true;
@@ -336,7 +333,7 @@ bool BasicSc2Bot::TryBuildStructure(ABILITY_ID ability_type_for_structure,
 				// this factory is not a ramp building but it was destroyed
 				// possibly
 				else {
-					Units addons_t = obs->GetUnits(
+					Units addons_t = Index().GetUnits(
 						Unit::Alliance::Self, [](const Unit& unit) {
 							return unit.unit_type ==
 								UNIT_TYPEID::TERRAN_TECHLAB;
@@ -349,19 +346,19 @@ bool BasicSc2Bot::TryBuildStructure(ABILITY_ID ability_type_for_structure,
 						if (!EnemyNearby(tl_p, false) &&
 							Query()->Placement(ability_type_for_structure,
 								tl_p)) {
-							Actions()->UnitCommand(
+							OrderBuild(
 								builder, ability_type_for_structure, tl_p);
 							return true;
 						}
 					}
 				}
-				return build33_after_check(builder, ability_type_for_structure,
-					base_location, true);
+				return build33_after_check(builder,
+					ability_type_for_structure, true);
 			}
 		}
 		else if (ability_type_for_structure == ABILITY_ID::BUILD_STARPORT) {
 			Units starport =
-				obs->GetUnits(Unit::Alliance::Self, [this](const Unit& unit) {
+				Index().GetUnits(Unit::Alliance::Self, [this](const Unit& unit) {
 				return unit.unit_type == UNIT_TYPEID::TERRAN_STARPORT &&
 					ALLBuildingsFilter(unit);
 					});
@@ -369,13 +366,12 @@ bool BasicSc2Bot::TryBuildStructure(ABILITY_ID ability_type_for_structure,
 				// check if ramp is blocked
 				if (phase == 2) {
 					return build33_after_check(builder,
-						ability_type_for_structure,
-						base_location, true);
+						ability_type_for_structure, true);
 				}
 
 				// after phase 2, this means possibly starport is destroyed
 				else {
-					Units addons_t = obs->GetUnits(
+					Units addons_t = Index().GetUnits(
 						Unit::Alliance::Self, [](const Unit& unit) {
 							return unit.unit_type ==
 								UNIT_TYPEID::TERRAN_TECHLAB;
@@ -388,27 +384,27 @@ bool BasicSc2Bot::TryBuildStructure(ABILITY_ID ability_type_for_structure,
 						if (!EnemyNearby(tl_p, false) &&
 							Query()->Placement(ability_type_for_structure,
 								tl_p)) {
-							Actions()->UnitCommand(
+							OrderBuild(
 								builder, ability_type_for_structure, tl_p);
 							return true;
 						}
 					}
 				}
-				return build33_after_check(builder, ability_type_for_structure,
-					base_location, true);
+				return build33_after_check(builder,
+					ability_type_for_structure, true);
 			}
 		}
 		else {
-			// check far away from the ramp first around the edge of the base
-			// for 3x3 buildings
-			return build33_after_check(builder, ability_type_for_structure,
-				base_location, false);
+			// other 3x3 buildings go in the slots 10 to 15 from the base
+			return build33_after_check(builder,
+				ability_type_for_structure, false);
 		}
 	}
 	return false;
 }
 
 bool BasicSc2Bot::TryBuildSupplyDepot() {
+	PROFILE_SCOPE("TryBuildSupplyDepot");
 	// Get supply used and supply cap
 	const ObservationInterface* obs = Observation();
 	int32_t supply_used = obs->GetFoodUsed();
@@ -425,8 +421,8 @@ bool BasicSc2Bot::TryBuildSupplyDepot() {
 	}
 
 	// block ramp right while building barracks
-	Units barracks = obs->GetUnits(Unit::Alliance::Self,
-		IsUnit(UNIT_TYPEID::TERRAN_BARRACKS));
+	Units barracks = Index().GetUnits(
+		Unit::Alliance::Self, UNIT_TYPEID::TERRAN_BARRACKS);
 	if (ramp_depots[0] && phase == 0 && !barracks.empty()) {
 		if (!ramp_depots[1]) {
 			return TryBuildStructure(ABILITY_ID::BUILD_SUPPLYDEPOT,
@@ -448,7 +444,7 @@ bool BasicSc2Bot::TryBuildSupplyDepot() {
 	if (supply_used >= supply_cap - supply_surplus) {
 		// Check if a supply depot is already under construction
 		Units supply_depots_building =
-			obs->GetUnits(Unit::Self, [this](const Unit& unit) {
+			Index().GetUnits(Unit::Self, [this](const Unit& unit) {
 			return unit.unit_type == UNIT_TYPEID::TERRAN_SUPPLYDEPOT &&
 				(!unit.tag || unit.build_progress < 1.0f ||
 					unit.display_type == 4);
@@ -473,15 +469,14 @@ bool BasicSc2Bot::TryBuildSupplyDepot() {
 }
 
 void BasicSc2Bot::AssignWorkers() {
-	const ObservationInterface* obs = Observation();
-
+	PROFILE_SCOPE("AssignWorkers");
 	// Get idle SCVs
-	Units idle_scvs = obs->GetUnits(Unit::Alliance::Self, [](const Unit& unit) {
+	Units idle_scvs = Index().GetUnits(Unit::Alliance::Self, [](const Unit& unit) {
 		return unit.unit_type == UNIT_TYPEID::TERRAN_SCV && unit.orders.empty();
 		});
 
 	Units scvs_not_holding =
-		obs->GetUnits(Unit::Alliance::Self, [](const Unit& unit) {
+		Index().GetUnits(Unit::Alliance::Self, [](const Unit& unit) {
 		return unit.unit_type == UNIT_TYPEID::TERRAN_SCV &&
 			!unit.orders.empty() &&
 			unit.orders.front().ability_id ==
@@ -490,9 +485,9 @@ void BasicSc2Bot::AssignWorkers() {
 			});
 
 	// Get bases and refineries
-	Units bases = obs->GetUnits(Unit::Alliance::Self, IsTownHall());
+	Units bases = Index().GetTownHalls(Unit::Alliance::Self);
 	Units refineries =
-		obs->GetUnits(Unit::Alliance::Self, [](const Unit& unit) {
+		Index().GetUnits(Unit::Alliance::Self, [](const Unit& unit) {
 		return unit.unit_type == UNIT_TYPEID::TERRAN_REFINERY &&
 			unit.build_progress == 1.0f;
 			});
@@ -508,7 +503,7 @@ void BasicSc2Bot::AssignWorkers() {
 	std::map<const Unit*, Units> base_minerals_map;
 	for (const auto& base : bases) {
 		Units nearby_minerals =
-			obs->GetUnits(Unit::Alliance::Neutral, [base](const Unit& unit) {
+			Index().GetUnits(Unit::Alliance::Neutral, [base](const Unit& unit) {
 			return IsMineralPatch()(unit) &&
 				Distance2D(unit.pos, base->pos) < 10.0f;
 				});
@@ -577,11 +572,10 @@ void BasicSc2Bot::AssignWorkers() {
 }
 
 void BasicSc2Bot::ReassignWorkers() {
-	const ObservationInterface* obs = Observation();
-
-	Units bases = obs->GetUnits(Unit::Alliance::Self, IsTownHall());
-	Units refineries = obs->GetUnits(Unit::Alliance::Self,
-		IsUnit(UNIT_TYPEID::TERRAN_REFINERY));
+	PROFILE_SCOPE("ReassignWorkers");
+	Units bases = Index().GetTownHalls(Unit::Alliance::Self);
+	Units refineries = Index().GetUnits(
+		Unit::Alliance::Self, UNIT_TYPEID::TERRAN_REFINERY);
 
 	// Collect under-saturated and over-saturated bases
 	std::vector<const Unit*> under_saturated_bases;
@@ -607,7 +601,7 @@ void BasicSc2Bot::ReassignWorkers() {
 			over_base->assigned_harvesters - over_base->ideal_harvesters;
 
 		Units workers_at_base =
-			obs->GetUnits(Unit::Alliance::Self, [over_base](const Unit& unit) {
+			Index().GetUnits(Unit::Alliance::Self, [over_base](const Unit& unit) {
 			return unit.unit_type == UNIT_TYPEID::TERRAN_SCV &&
 				!unit.orders.empty() &&
 				Distance2D(unit.pos, over_base->pos) < 10.0f;
@@ -631,7 +625,7 @@ void BasicSc2Bot::ReassignWorkers() {
 			if (closest_base) {
 				// Assign worker to a mineral patch near the under-saturated
 				// base
-				Units minerals = obs->GetUnits(
+				Units minerals = Index().GetUnits(
 					Unit::Alliance::Neutral, [closest_base](const Unit& unit) {
 						return IsMineralPatch()(unit) &&
 							Distance2D(unit.pos, closest_base->pos) < 10.0f;
@@ -658,7 +652,7 @@ void BasicSc2Bot::ReassignWorkers() {
 			refinery->assigned_harvesters - refinery->ideal_harvesters;
 
 		if (excess_workers > 0) {
-			Units gas_workers = obs->GetUnits(
+			Units gas_workers = Index().GetUnits(
 				Unit::Alliance::Self, [refinery](const Unit& unit) {
 					return unit.unit_type == UNIT_TYPEID::TERRAN_SCV &&
 						!unit.orders.empty() &&
@@ -669,7 +663,7 @@ void BasicSc2Bot::ReassignWorkers() {
 				const Unit* worker = gas_workers[i];
 
 				// Assign worker to the closest mineral patch
-				Units minerals = obs->GetUnits(
+				Units minerals = Index().GetUnits(
 					Unit::Alliance::Neutral, [worker](const Unit& unit) {
 						return IsMineralPatch()(unit);
 					});
@@ -691,82 +685,93 @@ void BasicSc2Bot::ReassignWorkers() {
 }
 
 void BasicSc2Bot::BuildRefineries() {
+	PROFILE_SCOPE("BuildRefineries");
 
 	const ObservationInterface* obs = Observation();
 	Units cc = bases;
 
-	// Build refineries near each base
+	// Geysers near each base that need a refinery
+	Units free_geysers;
 	for (const auto& base : cc) {
 		Units geysers =
-			obs->GetUnits(Unit::Alliance::Neutral, [base](const Unit& unit) {
+			Index().GetUnits(Unit::Alliance::Neutral, [base](const Unit& unit) {
 			return IsGeyser()(unit) &&
 				Distance2D(unit.pos, base->pos) < 15.0f;
 				});
 
-		// Build a refinery on top of each geyser
 		for (const auto& geyser : geysers) {
 			Units refineries =
-				obs->GetUnits(Unit::Alliance::Self, [geyser](const Unit& unit) {
+				Index().GetUnits(Unit::Alliance::Self, [geyser](const Unit& unit) {
 				return unit.unit_type == UNIT_TYPEID::TERRAN_REFINERY &&
 					Distance2D(unit.pos, geyser->pos) < 1.0f;
 					});
 			Units barracks =
-				obs->GetUnits(Unit::Alliance::Self, [](const Unit& unit) {
+				Index().GetUnits(Unit::Alliance::Self, [](const Unit& unit) {
 				return unit.unit_type == UNIT_TYPEID::TERRAN_BARRACKS &&
 					unit.build_progress < 1.0f;
 					});
 
 			// Check if a refinery is already being built
 			if (refineries.empty() && obs->GetMinerals() >= 75 &&
-				(!barracks.empty() || phase)) {
-				Units scvs = obs->GetUnits(Unit::Alliance::Self,
-					IsUnit(UNIT_TYPEID::TERRAN_SCV));
-				Units scvs_gas = GetAllSCVsGettingGas();
-				const Unit* builder = nullptr;
-
-				// Find an idle SCV to build the refinery
-				for (const auto& scv : scvs) {
-					auto it = FindInVector(scvs_gas, scv);
-					if (scvs_repairing.find(scv->tag) != scvs_repairing.end() ||
-						it != scvs_gas.end()) {
-						continue;
-					}
-					bool is_constructing = false;
-					for (const auto& order : scv->orders) {
-						if (order.ability_id == ABILITY_ID::BUILD_SUPPLYDEPOT ||
-							order.ability_id == ABILITY_ID::BUILD_REFINERY ||
-							order.ability_id == ABILITY_ID::BUILD_BARRACKS ||
-							order.ability_id ==
-							ABILITY_ID::BUILD_COMMANDCENTER) {
-							is_constructing = true;
-							break;
-						}
-					}
+				(!barracks.empty() || phase) &&
+				FindInVector(free_geysers, geyser) == free_geysers.end()) {
+				free_geysers.push_back(geyser);
+			}
+		}
+	}
+	if (free_geysers.empty()) {
+		return;
+	}
 
-					// Check if the SCV is idle (has no orders)
-					if (!is_constructing && scv != scv_scout &&
-						scvs_repairing.find(scv->tag) == scvs_repairing.end()) {
-						builder = scv;
-						break;
-					}
-				}
+	Units scvs = Index().GetUnits(Unit::Alliance::Self, UNIT_TYPEID::TERRAN_SCV);
+	Units scvs_gas = GetAllSCVsGettingGas();
+	const Unit* builder = nullptr;
 
-				// Build the refinery
-				if (builder) {
-					if (Query()->Placement(ABILITY_ID::BUILD_REFINERY,
-						geyser->pos)) {
-						Actions()->UnitCommand(
-							builder, ABILITY_ID::BUILD_REFINERY, geyser);
-					}
-				}
+	// Find an idle SCV to build the refinery
+	for (const auto& scv : scvs) {
+		auto it = FindInVector(scvs_gas, scv);
+		if (scvs_repairing.find(scv->tag) != scvs_repairing.end() ||
+			it != scvs_gas.end()) {
+			continue;
+		}
+		bool is_constructing = false;
+		for (const auto& order : scv->orders) {
+			if (order.ability_id == ABILITY_ID::BUILD_SUPPLYDEPOT ||
+				order.ability_id == ABILITY_ID::BUILD_REFINERY ||
+				order.ability_id == ABILITY_ID::BUILD_BARRACKS ||
+				order.ability_id == ABILITY_ID::BUILD_COMMANDCENTER) {
+				is_constructing = true;
+				break;
 			}
 		}
+
+		// Check if the SCV is idle (has no orders)
+		if (!is_constructing && scv != scv_scout &&
+			scvs_repairing.find(scv->tag) == scvs_repairing.end()) {
+			builder = scv;
+			break;
+		}
+	}
+	if (!builder) {
+		return;
+	}
+
+	// Build a refinery on top of each geyser, checked in one request
+	std::vector<QueryInterface::PlacementQuery> candidates;
+	for (const auto& geyser : free_geysers) {
+		candidates.emplace_back(ABILITY_ID::BUILD_REFINERY, geyser->pos);
+	}
+	std::vector<bool> valid = Query()->Placement(candidates);
+	for (size_t i = 0; i < valid.size(); ++i) {
+		if (valid[i]) {
+			Actions()->UnitCommand(
+				builder, ABILITY_ID::BUILD_REFINERY, free_geysers[i]);
+		}
 	}
 }
 
 void BasicSc2Bot::BuildExpansion() {
-	const ObservationInterface* observation = Observation();
-
+	PROFILE_SCOPE("BuildExpansion");
 	// Check if the first battlecruiser is in production
 	if (!first_battlecruiser) {
 		return;
@@ -784,7 +789,7 @@ void BasicSc2Bot::BuildExpansion() {
 
 	// Check if a Command Center is already being built
 	Units command_centers_building =
-		observation->GetUnits(Unit::Self, [](const Unit& unit) {
+		Index().GetUnits(Unit::Self, [](const Unit& unit) {
 		return (unit.unit_type == UNIT_TYPEID::TERRAN_COMMANDCENTER ||
 			unit.unit_type == UNIT_TYPEID::TERRAN_COMMANDCENTERFLYING ||
 			unit.unit_type == UNIT_TYPEID::TERRAN_ORBITALCOMMAND ||
@@ -808,8 +813,8 @@ void BasicSc2Bot::BuildExpansion() {
 		return; // Don't expand to a location that's under threat
 	}
 
-	Units scvs = observation->GetUnits(Unit::Alliance::Self,
-		IsUnit(UNIT_TYPEID::TERRAN_SCV));
+	Units scvs = Index().GetUnits(
+		Unit::Alliance::Self, UNIT_TYPEID::TERRAN_SCV);
 	Units scvs_gas = GetAllSCVsGettingGas();
 	const Unit* builder = nullptr;
 
@@ -834,7 +839,7 @@ void BasicSc2Bot::BuildExpansion() {
 		if (!EnemyNearby(next_expansion, false, 20) &&
 			Query()->Placement(ABILITY_ID::BUILD_COMMANDCENTER,
 				next_expansion)) {
-			Actions()->UnitCommand(builder, ABILITY_ID::BUILD_COMMANDCENTER,
+			OrderBuild(builder, ABILITY_ID::BUILD_COMMANDCENTER,
 				next_expansion);
 		}
 		return;
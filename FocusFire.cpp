@@ -0,0 +1,86 @@
+#include "FocusFire.h"
+
+#include "SpatialGrid.h"
+
+#include <algorithm>
+
+using namespace sc2;
+
+namespace {
+
+// Radius of the largest targets, the reach of a search around a shooter
+const float kMaxTargetRadius = 3.0f;
+
+} // namespace
+
+const std::vector<const Unit*>& FocusFire::Assign(const Units& shooters,
+	const SpatialGrid& targets, float range, const Filter& filter,
+	const Damage& damage) {
+	candidates.clear();
+	offsets.assign(1, 0);
+	remaining.clear();
+	target_index.clear();
+	target_units.clear();
+	assigned.assign(shooters.size(), nullptr);
+
+	// Targets within range of each shooter's edge to their own edge
+	for (const auto& shooter : shooters) {
+		for (const auto& target : targets.GetUnitsWithin(shooter->pos,
+			range + shooter->radius + kMaxTargetRadius)) {
+			float distance = Distance2D(shooter->pos, target->pos);
+			if (distance > range + shooter->radius + target->radius ||
+				!filter(*target)) {
+				continue;
+			}
+			auto inserted = target_index.emplace(target, target_units.size());
+			if (inserted.second) {
+				target_units.push_back(target);
+				remaining.push_back(target->health + target->shield);
+			}
+			candidates.push_back({ inserted.first->second,
+				damage(*shooter, *target), distance });
+		}
+		offsets.push_back(candidates.size());
+	}
+
+	// Shooters with fewer choices pick first
+	order.clear();
+	for (size_t i = 0; i < shooters.size(); ++i) {
+		if (offsets[i + 1] > offsets[i]) {
+			order.push_back(i);
+		}
+	}
+	std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+		return offsets[a + 1] - offsets[a] < offsets[b + 1] - offsets[b];
+		});
+
+	for (size_t shooter : order) {
+		const Candidate* best = nullptr;
+		for (size_t i = offsets[shooter]; i < offsets[shooter + 1]; ++i) {
+			const Candidate& candidate = candidates[i];
+			if (!best) {
+				best = &candidate;
+				continue;
+			}
+			float left = remaining[candidate.target];
+			float best_left = remaining[best->target];
+			bool better;
+			if ((left > 0.0f) != (best_left > 0.0f)) {
+				better = left > 0.0f;
+			}
+			else if (left != best_left) {
+				// Finish off the weakest, or overkill the least
+				better = left > 0.0f ? left < best_left : left > best_left;
+			}
+			else {
+				better = candidate.distance < best->distance;
+			}
+			if (better) {
+				best = &candidate;
+			}
+		}
+		remaining[best->target] -= best->damage;
+		assigned[shooter] = target_units[best->target];
+	}
+	return assigned;
+}
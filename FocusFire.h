@@ -0,0 +1,55 @@
+#ifndef FOCUS_FIRE_H_
+#define FOCUS_FIRE_H_
+
+#include "sc2api/sc2_common.h"
+#include "sc2api/sc2_unit.h"
+#include "sc2api/sc2_unit_filters.h"
+
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class SpatialGrid;
+
+// Spreads the next shots of a group of shooters over the targets in their
+// range. Shooters with the fewest targets pick first, each one the target
+// with the least health left after the shots already assigned to it, so
+// the group kills one target after another instead of all shooting the
+// closest. Once every target in range is already dealt with, the shooter
+// takes the one with the most health left to waste the least damage.
+class FocusFire {
+public:
+	// Expected damage of one attack of the shooter on the target
+	using Damage =
+		std::function<float(const sc2::Unit& shooter, const sc2::Unit& target)>;
+
+	// Target for every shooter, in the order of the shooters, nullptr if no
+	// target passing the filter is within range of it
+	const std::vector<const sc2::Unit*>& Assign(const sc2::Units& shooters,
+		const SpatialGrid& targets, float range, const sc2::Filter& filter,
+		const Damage& damage);
+
+private:
+	struct Candidate {
+		size_t target;
+		float damage;
+		float distance;
+	};
+
+	// Targets in range of shooter i are candidates[offsets[i] .. offsets[i + 1])
+	std::vector<Candidate> candidates;
+	std::vector<size_t> offsets;
+
+	// Health and shields of every target left after the assigned attacks
+	std::vector<float> remaining;
+	std::unordered_map<const sc2::Unit*, size_t> target_index;
+	std::vector<const sc2::Unit*> target_units;
+
+	// Shooters in the order they pick
+	std::vector<size_t> order;
+
+	std::vector<const sc2::Unit*> assigned;
+};
+
+#endif
@@ -0,0 +1,86 @@
+#include "GridComponents.h"
+
+#include <cstdlib>
+
+using namespace sc2;
+
+int GridComponents::Find(int cell) {
+	while (parent[cell] != cell) {
+		parent[cell] = parent[parent[cell]];
+		cell = parent[cell];
+	}
+	return cell;
+}
+
+void GridComponents::Label(const std::vector<uint8_t>& cells, int width,
+	int height, const std::vector<int>& max_distance) {
+	groups.clear();
+	classes.clear();
+	parent.resize(cells.size());
+	for (size_t i = 0; i < parent.size(); ++i) {
+		parent[i] = static_cast<int>(i);
+	}
+
+	// Neighbours visited before the cell in raster order, per class
+	std::vector<std::vector<Point2DI>> earlier(max_distance.size());
+	for (size_t c = 1; c < max_distance.size(); ++c) {
+		int d = max_distance[c];
+		for (int dy = -d; dy <= 0; ++dy) {
+			for (int dx = -d; dx <= d; ++dx) {
+				if ((dy < 0 || dx < 0) && std::abs(dx) + std::abs(dy) <= d) {
+					earlier[c].emplace_back(dx, dy);
+				}
+			}
+		}
+	}
+
+	// First pass: join each cell with its earlier neighbours. The smaller
+	// index becomes the root, so a root is the first cell of its group.
+	for (int y = 0; y < height; ++y) {
+		for (int x = 0; x < width; ++x) {
+			int cell = x + y * width;
+			uint8_t c = cells[cell];
+			if (c == 0) {
+				continue;
+			}
+			for (const auto& offset : earlier[c]) {
+				int nx = x + offset.x;
+				int ny = y + offset.y;
+				if (nx < 0 || ny < 0 || nx >= width) {
+					continue;
+				}
+				int neighbour = nx + ny * width;
+				if (cells[neighbour] != c) {
+					continue;
+				}
+				int a = Find(cell);
+				int b = Find(neighbour);
+				if (a < b) {
+					parent[b] = a;
+				}
+				else if (b < a) {
+					parent[a] = b;
+				}
+			}
+		}
+	}
+
+	// Second pass: number the roots and collect the cells
+	std::vector<int> group_of(cells.size(), -1);
+	for (int y = 0; y < height; ++y) {
+		for (int x = 0; x < width; ++x) {
+			int cell = x + y * width;
+			if (cells[cell] == 0) {
+				continue;
+			}
+			int root = Find(cell);
+			if (root == cell) {
+				group_of[cell] = static_cast<int>(groups.size());
+				groups.emplace_back();
+				classes.push_back(cells[cell]);
+			}
+			groups[group_of[root]].emplace_back(
+				static_cast<float>(x), static_cast<float>(y));
+		}
+	}
+}
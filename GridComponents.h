@@ -0,0 +1,42 @@
+#ifndef GRID_COMPONENTS_H_
+#define GRID_COMPONENTS_H_
+
+#include "sc2api/sc2_common.h"
+
+#include <cstdint>
+#include <vector>
+
+// Connected groups of map cells, labelled with a two pass union-find.
+// Every cell has a class; class 0 cells are ignored and the others join the
+// cells of the same class within the Manhattan distance set for that class.
+// Labelling is linear in the number of cells, so several kinds of groups
+// (ramps, build regions) can be found in one pass over the map.
+class GridComponents {
+public:
+	// Labels a row-major grid of classes from the bottom left.
+	// max_distance is indexed by class.
+	void Label(const std::vector<uint8_t>& cells, int width, int height,
+		const std::vector<int>& max_distance);
+
+	// Number of groups found
+	size_t Count() const { return groups.size(); }
+
+	// Class of the cells of the group
+	uint8_t Class(size_t group) const { return classes[group]; }
+
+	// Cells of the group in raster order, groups are numbered by their
+	// first cell
+	const std::vector<sc2::Point2D>& Cells(size_t group) const {
+		return groups[group];
+	}
+
+private:
+	// Root of the cell's set, halving the path on the way
+	int Find(int cell);
+
+	std::vector<int> parent;
+	std::vector<std::vector<sc2::Point2D>> groups;
+	std::vector<uint8_t> classes;
+};
+
+#endif
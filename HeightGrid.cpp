@@ -0,0 +1,22 @@
+#include "HeightGrid.h"
+
+#include "sc2api/sc2_map_info.h"
+
+using namespace sc2;
+
+void HeightGrid::Reset(const GameInfo& game_info) {
+	width = game_info.width;
+	height = game_info.height;
+	heights.resize(static_cast<size_t>(width) * height);
+	levels.resize(heights.size());
+
+	// Let HeightMap do the decoding so the values match it exactly
+	HeightMap h_map(game_info);
+	for (int y = 0; y < height; ++y) {
+		for (int x = 0; x < width; ++x) {
+			float z = h_map.TerrainHeight(Point2DI(x, y));
+			heights[x + y * width] = z;
+			levels[x + y * width] = static_cast<int8_t>(z);
+		}
+	}
+}
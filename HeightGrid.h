@@ -0,0 +1,42 @@
+#ifndef HEIGHT_GRID_H_
+#define HEIGHT_GRID_H_
+
+#include "sc2api/sc2_gametypes.h"
+
+#include <cstdint>
+#include <vector>
+
+// Terrain height of every map cell, decoded once from
+// GameInfo::terrain_height. Level() is the height truncated to a whole
+// number, which is what the ramp and cliff checks compare.
+class HeightGrid {
+public:
+	// Decodes the terrain height of the map
+	void Reset(const sc2::GameInfo& game_info);
+
+	// Height of the cell, 0 outside of the map
+	float Height(int x, int y) const {
+		if (x < 0 || y < 0 || x >= width || y >= height) {
+			return 0.0f;
+		}
+		return heights[x + y * width];
+	}
+
+	// Whole height level of the cell, 0 outside of the map
+	int Level(int x, int y) const {
+		if (x < 0 || y < 0 || x >= width || y >= height) {
+			return 0;
+		}
+		return levels[x + y * width];
+	}
+
+private:
+	int width = 0;
+	int height = 0;
+
+	// Row-major from the bottom left
+	std::vector<float> heights;
+	std::vector<int8_t> levels;
+};
+
+#endif
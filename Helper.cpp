@@ -3,7 +3,7 @@
 // Returns the starting base location
 const Unit* BasicSc2Bot::GetMainBase() const {
 	// Get the main Command Center, Orbital Command, or Planetary Fortress
-	Units command_centers = Observation()->GetUnits(Unit::Self, IsTownHall());
+	Units command_centers = Index().GetTownHalls(Unit::Self);
 	if (!command_centers.empty()) {
 		return command_centers.front();
 	}
@@ -22,18 +22,10 @@ bool BasicSc2Bot::CanBuild(const int32_t mineral, const int32_t gas,
 bool BasicSc2Bot::EnemyNearby(const Point2D& pos, const bool worker,
 	const int32_t distance) {
 	// if enemy units are within a certain radius (run!!!!)
-	const ObservationInterface* obs = Observation();
-	Units enemy_units = obs->GetUnits(Unit::Alliance::Enemy);
-	bool enemy_nearby = false;
-	for (const auto& e : enemy_units) {
-		if (IsTrivialUnit(e) || (worker * IsWorkerUnit(e)))
-			continue;
-		if (Distance2D(e->pos, pos) < 15) {
-			enemy_nearby = true;
-			break;
-		}
-	}
-	return enemy_nearby;
+	return EnemyGrid().AnyWithin(pos, static_cast<float>(distance),
+		[this, worker](const Unit& e) {
+			return !IsTrivialUnit(&e) && !(worker && IsWorkerUnit(&e));
+		});
 }
 
 // Returns how close the current resources are to the resource goal
@@ -51,9 +43,9 @@ float BasicSc2Bot::HowClosetoFinishCurrentJob(const Unit* b) const {
 
 // Check if the building is still under construction
 void BasicSc2Bot::IsBuildingProgress() {
-	const ObservationInterface* obs = Observation();
+	PROFILE_SCOPE("IsBuildingProgress");
 	Units buildings =
-		obs->GetUnits(Unit::Alliance::Self, [this](const Unit& b) {
+		Index().GetUnits(Unit::Alliance::Self, [this](const Unit& b) {
 		return BuildingsBeingBuiltFilter(b);
 			});
 
@@ -85,8 +77,8 @@ void BasicSc2Bot::IsBuildingProgress() {
 
 // Check if the builder is getting damaged
 void BasicSc2Bot::IsBuilderGettingDamaged() {
-	const ObservationInterface* obs = Observation();
-	Units scvs = obs->GetUnits(Unit::Alliance::Self, [this](const Unit& u) {
+	PROFILE_SCOPE("IsBuilderGettingDamaged");
+	Units scvs = Index().GetUnits(Unit::Alliance::Self, [this](const Unit& u) {
 		return !u.orders.empty() && IsBuildingOrder(u.orders.front());
 		});
 	for (const auto& scv : scvs) {
@@ -109,10 +101,8 @@ void BasicSc2Bot::IsBuilderGettingDamaged() {
 
 // Main base is complete and need expanding
 bool BasicSc2Bot::NeedExpansion() const {
-	const ObservationInterface* observation = Observation();
-
 	// Check if we have any bases
-	Units all_bases = observation->GetUnits(Unit::Self, IsTownHall());
+	Units all_bases = Index().GetTownHalls(Unit::Self);
 	Units bases;
 
 	// Filter out completed bases
@@ -140,8 +130,7 @@ bool BasicSc2Bot::NeedExpansion() const {
 
 	// Get current number of SCVs
 	size_t num_scvs =
-		observation
-		->GetUnits(Unit::Alliance::Self, IsUnit(UNIT_TYPEID::TERRAN_SCV))
+		Index().GetUnits(Unit::Alliance::Self, UNIT_TYPEID::TERRAN_SCV)
 		.size();
 
 	// Expand when we have enough SCVs to saturate our current bases
@@ -157,7 +146,7 @@ Point3D BasicSc2Bot::GetNextExpansion() const {
 	}
 
 	const std::vector<Point3D>& expansions = expansion_locations;
-	Units townhalls = observation->GetUnits(Unit::Alliance::Self, IsTownHall());
+	Units townhalls = Index().GetTownHalls(Unit::Alliance::Self);
 
 	if (townhalls.empty() || GetMainBase() == nullptr) {
 		return Point3D(0.0f, 0.0f, 0.0f);
@@ -183,8 +172,8 @@ Point3D BasicSc2Bot::GetNextExpansion() const {
 			continue;
 		}
 
-		// Find the closest expansion to the main base
-		float distance = DistanceSquared3D(expansion_pos, main_base_location);
+		// Find the closest expansion to the main base by ground
+		float distance = GroundDistance(main_base_location, expansion_pos);
 
 		// Update the closest expansion if the current one is closer
 		if (distance < closest_distance) {
@@ -204,7 +193,7 @@ Point2D BasicSc2Bot::GetSafePosition() {
 // Find the closest damaged unit for repair
 const Unit* BasicSc2Bot::FindDamagedUnit() {
 	Units damaged_units =
-		Observation()->GetUnits(Unit::Alliance::Self, [](const Unit& unit) {
+		Index().GetUnits(Unit::Alliance::Self, [](const Unit& unit) {
 		return unit.health < unit.health_max &&
 			(unit.unit_type == UNIT_TYPEID::TERRAN_BATTLECRUISER ||
 				unit.unit_type == UNIT_TYPEID::TERRAN_SIEGETANK ||
@@ -215,7 +204,7 @@ const Unit* BasicSc2Bot::FindDamagedUnit() {
 
 // Find the closest damaged structure for repair
 const Unit* BasicSc2Bot::FindDamagedStructure() {
-	const auto& units = Observation()->GetUnits(Unit::Alliance::Self);
+	const auto& units = Index().GetUnits(Unit::Alliance::Self);
 
 	const Unit* highest_priority_target = nullptr;
 	int highest_priority = std::numeric_limits<int>::max();
@@ -315,7 +304,7 @@ bool BasicSc2Bot::IsMainBaseUnderAttack() {
 	}
 
 	// Check if there are enemy combat units near our main base
-	Units enemy_units_near_base = Observation()->GetUnits(
+	Units enemy_units_near_base = Index().GetUnits(
 		Unit::Alliance::Enemy, [this, main_base](const Unit& unit) {
 			float distance = Distance2D(unit.pos, main_base->pos);
 			if (distance < 25.0f && !IsWorkerUnit(&unit) &&
@@ -330,24 +319,14 @@ bool BasicSc2Bot::IsMainBaseUnderAttack() {
 
 // Find the closest enemy unit to a given position
 const Unit* BasicSc2Bot::FindClosestEnemy(const Point2D& pos) {
-	const Unit* closest_enemy = nullptr;
-	float closest_distance = std::numeric_limits<float>::max();
-
-	for (const auto& unit : Observation()->GetUnits(Unit::Alliance::Enemy)) {
-		float distance = Distance2D(pos, unit->pos);
-		if (distance < closest_distance) {
-			closest_distance = distance;
-			closest_enemy = unit;
-		}
-	}
-	return closest_enemy;
+	Units closest_enemy = EnemyGrid().KNearest(pos, 1);
+	return closest_enemy.empty() ? nullptr : closest_enemy.front();
 }
 
 // Check if the unit has a specific ability
 const Unit* BasicSc2Bot::FindUnit(sc2::UnitTypeID unit_type) const {
-	const ObservationInterface* observation = Observation();
 	Units units =
-		observation->GetUnits(Unit::Alliance::Self, IsUnit(unit_type));
+		Index().GetUnits(Unit::Alliance::Self, unit_type);
 	for (const auto& unit : units) {
 		// Exclude SCVs that are currently constructing
 		if (unit->orders.empty() ||
@@ -368,8 +347,14 @@ bool BasicSc2Bot::TryBuildStructureAtLocation(
 
 	if (builder && it == gas_scvs.end() &&
 		scvs_repairing.find(builder->tag) == scvs_repairing.end()) {
+		// Only ask the game when the spot isn't known to be taken. The
+		// location is chosen by the caller, so mining lanes are allowed.
+		if (!PlacementMap().CanPlace(location,
+			BuildFootprint(ability_type_for_structure), true)) {
+			return false;
+		}
 		if (Query()->Placement(ability_type_for_structure, location, builder)) {
-			Actions()->UnitCommand(builder, ability_type_for_structure,
+			OrderBuild(builder, ability_type_for_structure,
 				location);
 			return true;
 		}
@@ -377,6 +362,76 @@ bool BasicSc2Bot::TryBuildStructureAtLocation(
 	return false;
 }
 
+// Structure built by the ability, INVALID if it doesn't build one
+UNIT_TYPEID BasicSc2Bot::BuildStructure(ABILITY_ID ability) const {
+	UNIT_TYPEID structure;
+	switch (ability) {
+	case ABILITY_ID::BUILD_COMMANDCENTER:
+		structure = UNIT_TYPEID::TERRAN_COMMANDCENTER;
+		break;
+	case ABILITY_ID::BUILD_SUPPLYDEPOT:
+		structure = UNIT_TYPEID::TERRAN_SUPPLYDEPOT;
+		break;
+	case ABILITY_ID::BUILD_BARRACKS:
+		structure = UNIT_TYPEID::TERRAN_BARRACKS;
+		break;
+	case ABILITY_ID::BUILD_ENGINEERINGBAY:
+		structure = UNIT_TYPEID::TERRAN_ENGINEERINGBAY;
+		break;
+	case ABILITY_ID::BUILD_MISSILETURRET:
+		structure = UNIT_TYPEID::TERRAN_MISSILETURRET;
+		break;
+	case ABILITY_ID::BUILD_BUNKER:
+		structure = UNIT_TYPEID::TERRAN_BUNKER;
+		break;
+	case ABILITY_ID::BUILD_FACTORY:
+		structure = UNIT_TYPEID::TERRAN_FACTORY;
+		break;
+	case ABILITY_ID::BUILD_STARPORT:
+		structure = UNIT_TYPEID::TERRAN_STARPORT;
+		break;
+	case ABILITY_ID::BUILD_ARMORY:
+		structure = UNIT_TYPEID::TERRAN_ARMORY;
+		break;
+	case ABILITY_ID::BUILD_FUSIONCORE:
+		structure = UNIT_TYPEID::TERRAN_FUSIONCORE;
+		break;
+	default:
+		return UNIT_TYPEID::INVALID;
+	}
+	return structure;
+}
+
+// Footprint radius of the structure built by the ability, 0 if unknown
+float BasicSc2Bot::BuildFootprint(ABILITY_ID ability) const {
+	UNIT_TYPEID structure = BuildStructure(ability);
+	return structure == UNIT_TYPEID::INVALID ? 0.0f
+		: footprint_r.at(structure);
+}
+
+// Order a build and hold its site until the structure is placed
+void BasicSc2Bot::OrderBuild(const Unit* builder, AbilityID ability,
+	const Point2D& location, bool queued_command) {
+	Actions()->UnitCommand(builder, ability, location, queued_command);
+	reserve_build_map(builder, ability.ToType(), location);
+}
+
+// Checks all candidates in one placement request, returns the index of the
+// first valid one or -1
+int BasicSc2Bot::FirstValidPlacement(
+	const std::vector<QueryInterface::PlacementQuery>& candidates) {
+	if (candidates.empty()) {
+		return -1;
+	}
+	std::vector<bool> valid = Query()->Placement(candidates);
+	for (size_t i = 0; i < valid.size(); ++i) {
+		if (valid[i]) {
+			return static_cast<int>(i);
+		}
+	}
+	return -1;
+}
+
 // Returns the count of units of a given type
 Point2D BasicSc2Bot::GetRallyPoint() {
 	const Unit* main_base = GetMainBase();
@@ -394,8 +449,7 @@ void BasicSc2Bot::SetRallyPoint(const Unit* b, const Point2D& p) {
 }
 
 const Unit* BasicSc2Bot::GetLeastSaturatedBase() const {
-	const ObservationInterface* observation = Observation();
-	Units bases = observation->GetUnits(Unit::Alliance::Self, IsTownHall());
+	Units bases = Index().GetTownHalls(Unit::Alliance::Self);
 	const Unit* least_saturated_base = nullptr;
 	int max_worker_need = 0;
 
@@ -418,53 +472,24 @@ const Unit* BasicSc2Bot::GetLeastSaturatedBase() const {
 Point2D BasicSc2Bot::GetNearestSafePosition(const Point2D& pos) {
 	const float safe_radius =
 		15.0f; // Radius within which enemies make a position unsafe
-	const float search_radius = 50.0f; // Search range to find safe positions
-	const int grid_steps = 5;          // Granularity of the search grid
+	const int max_steps = 50; // Cells to walk looking for a safe position
 
-	// Get all enemy units
-	Units enemy_units = Observation()->GetUnits(Unit::Alliance::Enemy);
-	if (enemy_units.empty()) {
-		return pos; // Return the original position if there are no enemies
+	// Return the original position if there are no enemies
+	if (!EnemyGrid().Size()) {
+		return pos;
 	}
 
-	// Check if a position is safe
-	auto is_safe = [&enemy_units, safe_radius](const Point2D& candidate) {
-		for (const auto& enemy : enemy_units) {
-			if (enemy && Distance2D(enemy->pos, candidate) <
-				safe_radius) { // Ensure enemy is not null
-				return false; // Unsafe if an enemy is within the safe_radius
-			}
-		}
-		return true; // Safe if no enemies are within the safe_radius
-		};
-
-	// Start searching for the nearest safe position
+	// Every retreating SCV searches the same field, built once per frame.
+	// Without a safe cell in reach, the furthest one searched is still
+	// safer than staying.
 	Point2D nearest_safe_position = pos;
-	float min_distance = std::numeric_limits<float>::max();
-
-	// Search within a grid around the position
-	for (float dx = -search_radius; dx <= search_radius; dx += grid_steps) {
-		for (float dy = -search_radius; dy <= search_radius; dy += grid_steps) {
-			Point2D candidate = pos + Point2D(dx, dy);
-			if (is_safe(candidate)) {
-				float distance = Distance2D(pos, candidate);
-				if (distance < min_distance) {
-					min_distance = distance;
-					nearest_safe_position = candidate;
-				}
-			}
-		}
-	}
-
-	// Return the nearest safe position (defaults to the original position if no
-	// safe position is found)
+	Danger().SafePosition(pos, safe_radius, max_steps, nearest_safe_position);
 	return nearest_safe_position;
 }
 
 // Returns true if any base is not full hp
 bool BasicSc2Bot::IsAnyBaseUnderAttack() {
-	const ObservationInterface* observation = Observation();
-	Units bases = observation->GetUnits(Unit::Alliance::Self, IsTownHall());
+	Units bases = Index().GetTownHalls(Unit::Alliance::Self);
 	for (const auto& base : bases) {
 		if (base->health < base->health_max) {
 			return true;
@@ -475,22 +500,12 @@ bool BasicSc2Bot::IsAnyBaseUnderAttack() {
 
 // Move our units to the enemy
 void BasicSc2Bot::MoveToEnemy(const Units& marines, const Units& siege_tanks) {
-	Units enemy_units = Observation()->GetUnits(Unit::Alliance::Enemy);
-
 	// Find the closest enemy unit to the first marine
 	if (marines.empty()) {
 		return;
 	}
 	const Unit* first_marine = marines.front();
-	const Unit* closest_enemy = nullptr;
-	float closest_distance = std::numeric_limits<float>::max();
-	for (const auto& enemy : enemy_units) {
-		float distance = Distance2D(first_marine->pos, enemy->pos);
-		if (distance < closest_distance) {
-			closest_distance = distance;
-			closest_enemy = enemy;
-		}
-	}
+	const Unit* closest_enemy = FindClosestEnemy(first_marine->pos);
 
 	// If no closest enemy is found, do nothing
 	if (!closest_enemy) {
@@ -529,26 +544,13 @@ int BasicSc2Bot::UnitsInCombat(UNIT_TYPEID unit_type) {
 
 	// Get all units of the specified type
 	for (const auto& unit :
-		Observation()->GetUnits(Unit::Alliance::Self, IsUnit(unit_type))) {
+		Index().GetUnits(Unit::Alliance::Self, unit_type)) {
 
-		bool is_near_enemy = false;
-
-		// Check proximity to enemy units
-		for (const auto& enemy_unit :
-			Observation()->GetUnits(Unit::Alliance::Enemy)) {
-
-			// Do not count trivial units
-			if (IsTrivialUnit(enemy_unit)) {
-				continue;
-			}
-
-			// Check if the unit is near an enemy
-			float distance_to_enemy = Distance2D(unit->pos, enemy_unit->pos);
-			if (distance_to_enemy <= 15.0f) {
-				is_near_enemy = true;
-				break;
-			}
-		}
+		// Check proximity to enemy units, not counting trivial units
+		bool is_near_enemy = EnemyGrid().AnyWithin(unit->pos, 15.0f,
+			[this](const Unit& enemy_unit) {
+				return !IsTrivialUnit(&enemy_unit);
+			});
 
 		// Count unit if it is near at least one enemy
 		if (is_near_enemy) {
@@ -561,8 +563,8 @@ int BasicSc2Bot::UnitsInCombat(UNIT_TYPEID unit_type) {
 
 const Unit* BasicSc2Bot::FindNearestMineralPatch() {
 	// Find closest mineral patches
-	Units mineral_patches = Observation()->GetUnits(
-		Unit::Alliance::Neutral, IsUnit(UNIT_TYPEID::NEUTRAL_MINERALFIELD));
+	Units mineral_patches = Index().GetUnits(
+		Unit::Alliance::Neutral, UNIT_TYPEID::NEUTRAL_MINERALFIELD);
 	const Unit* closest_mineral = nullptr;
 	float min_distance = std::numeric_limits<float>::max();
 
@@ -582,8 +584,8 @@ const Unit* BasicSc2Bot::FindNearestMineralPatch() {
 
 const Unit* BasicSc2Bot::FindRefinery() {
 	// Find all refineries
-	Units refineries = Observation()->GetUnits(
-		Unit::Alliance::Self, IsUnit(UNIT_TYPEID::TERRAN_REFINERY));
+	Units refineries = Index().GetUnits(
+		Unit::Alliance::Self, UNIT_TYPEID::TERRAN_REFINERY);
 
 	// Find a refinery with fewer than 3 workers
 	const Unit* target_refinery = nullptr;
@@ -629,11 +631,10 @@ void BasicSc2Bot::HarvestIdleWorkers(const Unit* unit) {
 
 // Returns all SCVs that are currently gathering gas
 Units BasicSc2Bot::GetAllSCVsGettingGas() const {
-	const ObservationInterface* obs = Observation();
-	Units gas_buildings = obs->GetUnits(Unit::Alliance::Self,
-		IsUnit(UNIT_TYPEID::TERRAN_REFINERY));
+	Units gas_buildings = Index().GetUnits(
+		Unit::Alliance::Self, UNIT_TYPEID::TERRAN_REFINERY);
 	Units scvs =
-		obs->GetUnits(Unit::Alliance::Self, IsUnit(UNIT_TYPEID::TERRAN_SCV));
+		Index().GetUnits(Unit::Alliance::Self, UNIT_TYPEID::TERRAN_SCV);
 	;
 	// Find all SCVs that are currently gathering gas
 	Units gas_scvs;
@@ -0,0 +1,89 @@
+#include "InfluenceGrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace sc2;
+
+void InfluenceGrid::Reset(int grid_width, int grid_height) {
+	width = std::max(grid_width, 0);
+	height = std::max(grid_height, 0);
+	values.assign(static_cast<size_t>(width) * height, 0.0f);
+	across_squared.assign(width, 0.0f);
+	game_loop = 0;
+}
+
+void InfluenceGrid::Clear(uint32_t loop) {
+	std::fill(values.begin(), values.end(), 0.0f);
+	game_loop = loop;
+}
+
+void InfluenceGrid::Splat(const Point2D& center, float weight,
+	float inner_radius, float outer_radius) {
+	outer_radius = std::max(outer_radius, inner_radius);
+	int x0 = std::max(static_cast<int>(std::floor(center.x - outer_radius)), 0);
+	int y0 = std::max(static_cast<int>(std::floor(center.y - outer_radius)), 0);
+	int x1 = std::min(static_cast<int>(center.x + outer_radius) + 1, width);
+	int y1 = std::min(static_cast<int>(center.y + outer_radius) + 1, height);
+	if (x0 >= x1 || y0 >= y1) {
+		return;
+	}
+
+	// The squared distance is the sum of one across and one up, take the
+	// ones across once for every row. Only the cells of the ring between
+	// the radii need a square root.
+	const float inner_squared = inner_radius * inner_radius;
+	const float outer_squared = outer_radius * outer_radius;
+	const float fade = outer_radius > inner_radius
+		? weight / (outer_radius - inner_radius) : 0.0f;
+	for (int x = x0; x < x1; ++x) {
+		float dx = x + 0.5f - center.x;
+		across_squared[x] = dx * dx;
+	}
+	for (int y = y0; y < y1; ++y) {
+		float dy = y + 0.5f - center.y;
+		float dy_squared = dy * dy;
+		if (dy_squared >= outer_squared) {
+			continue;
+		}
+		float* row = &values[static_cast<size_t>(y) * width];
+		for (int x = x0; x < x1; ++x) {
+			float distance_squared = dy_squared + across_squared[x];
+			if (distance_squared <= inner_squared) {
+				row[x] += weight;
+			}
+			else if (distance_squared < outer_squared) {
+				row[x] += fade * (outer_radius - std::sqrt(distance_squared));
+			}
+		}
+	}
+}
+
+Point2D InfluenceGrid::Lowest(const Point2D& center, float radius) const {
+	Point2D best = center;
+	float best_value = At(center);
+	float best_distance = 0.0f;
+	bool moved = false;
+	int x0 = std::max(static_cast<int>(std::floor(center.x - radius)), 0);
+	int y0 = std::max(static_cast<int>(std::floor(center.y - radius)), 0);
+	int x1 = std::min(static_cast<int>(center.x + radius) + 1, width);
+	int y1 = std::min(static_cast<int>(center.y + radius) + 1, height);
+	for (int y = y0; y < y1; ++y) {
+		for (int x = x0; x < x1; ++x) {
+			Point2D cell(x + 0.5f, y + 0.5f);
+			float distance = DistanceSquared2D(cell, center);
+			if (distance > radius * radius) {
+				continue;
+			}
+			float value = values[x + y * width];
+			if (value < best_value ||
+				(value == best_value && moved && distance < best_distance)) {
+				best = cell;
+				moved = true;
+				best_value = value;
+				best_distance = distance;
+			}
+		}
+	}
+	return best;
+}
@@ -0,0 +1,59 @@
+#ifndef INFLUENCE_GRID_H_
+#define INFLUENCE_GRID_H_
+
+#include "sc2api/sc2_common.h"
+
+#include <cstdint>
+#include <vector>
+
+// Weighted influence of units over the map, one float per cell.
+// A unit spreads its weight over a round kernel: full weight within the
+// inner radius, fading linearly to nothing at the outer one, the same in
+// every direction. Splatting costs an add per covered cell, plus a square
+// root in the fading ring, and reading a point is one lookup.
+class InfluenceGrid {
+public:
+	// Sizes the grid with no influence
+	void Reset(int width, int height);
+
+	// True once Reset() has been called
+	bool Initialized() const { return width > 0; }
+
+	// Game loop the units were splatted on
+	uint32_t GameLoop() const { return game_loop; }
+
+	// Drops all influence
+	void Clear(uint32_t game_loop);
+
+	// Adds weight around center
+	void Splat(const sc2::Point2D& center, float weight, float inner_radius,
+		float outer_radius);
+
+	// Influence at the point, 0 outside of the map
+	float At(const sc2::Point2D& p) const {
+		int x = static_cast<int>(p.x);
+		int y = static_cast<int>(p.y);
+		if (p.x < 0.0f || p.y < 0.0f || x >= width || y >= height) {
+			return 0.0f;
+		}
+		return values[x + y * width];
+	}
+
+	// Least influenced point within radius of center, center itself unless
+	// a cell has strictly less, otherwise the closest such cell
+	sc2::Point2D Lowest(const sc2::Point2D& center, float radius) const;
+
+private:
+	int width = 0;
+	int height = 0;
+
+	// Row-major from the bottom left
+	std::vector<float> values;
+
+	// Squared distances across of the kernel being splatted
+	std::vector<float> across_squared;
+
+	uint32_t game_loop = 0;
+};
+
+#endif
@@ -82,6 +82,9 @@ struct ConnectionOptions
 	sc2::Race ComputerRace;
 	std::string OpponentId;
 	std::string Map;
+	std::string RecordPath;
+	std::string TracePath;
+	std::string MapCacheDir = "data";
 };
 
 static void ParseArguments(int argc, char* argv[], ConnectionOptions& connect_options)
@@ -95,7 +98,10 @@ static void ParseArguments(int argc, char* argv[], ConnectionOptions& connect_op
 		{ "-a", "--ComputerRace", "Race of computer oppent"},
 		{ "-d", "--ComputerDifficulty", "Difficulty of computer oppenent"},
 		{ "-m", "--Map", "Map to play on against computer opponent", },
-		{ "-x", "--OpponentId", "PlayerId of opponent"}
+		{ "-x", "--OpponentId", "PlayerId of opponent"},
+		{ "-r", "--Record", "File to record the game's observations to"},
+		{ "-t", "--Trace", "File to write a Chrome trace of every step to"},
+		{ "-k", "--MapCache", "Directory to cache the map analysis in, data by default"}
 		});
 	arg_parser.Parse(argc, argv);
 	std::string GamePortStr;
@@ -135,12 +141,37 @@ static void ParseArguments(int argc, char* argv[], ConnectionOptions& connect_op
 		connect_options.ComputerOpponent = false;
 	}
 	arg_parser.Get("OpponentId", connect_options.OpponentId);
+	arg_parser.Get("Record", connect_options.RecordPath);
+	arg_parser.Get("Trace", connect_options.TracePath);
+	arg_parser.Get("MapCache", connect_options.MapCacheDir);
 }
 
-static void RunBot(int argc, char* argv[], sc2::Agent* Agent, sc2::Race race)
+static void RunBot(int argc, char* argv[], sc2::Agent* Agent, sc2::Race race,
+	FrameRecorder* Recorder = nullptr, MapCache* Cache = nullptr)
 {
 	ConnectionOptions Options;
 	ParseArguments(argc, argv, Options);
+	if (Recorder && !Options.RecordPath.empty()) {
+		if (Recorder->Open(Options.RecordPath)) {
+			std::cout << "Recording to " << Options.RecordPath << std::endl;
+		}
+		else {
+			std::cout << "Could not open " << Options.RecordPath
+				<< " for recording" << std::endl;
+		}
+	}
+	if (Cache) {
+		Cache->SetDirectory(Options.MapCacheDir);
+	}
+	if (!Options.TracePath.empty()) {
+		if (TraceWriter::Get().Open(Options.TracePath)) {
+			std::cout << "Tracing to " << Options.TracePath << std::endl;
+		}
+		else {
+			std::cout << "Could not open " << Options.TracePath
+				<< " for tracing" << std::endl;
+		}
+	}
 
 	/*class Human : public sc2::Agent {
 	public:
@@ -0,0 +1,177 @@
+#include "MapCache.h"
+
+#include "MappedFile.h"
+#include "Recording.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+using namespace sc2;
+using recording::ByteReader;
+using recording::ByteWriter;
+
+namespace {
+
+const char kMagic[8] = { 'U', 'E', 'D', 'B', 'O', 'T', 'M', 'C' };
+const uint32_t kVersion = 2;
+
+const uint64_t kFnvOffset = 14695981039346656037ull;
+const uint64_t kFnvPrime = 1099511628211ull;
+
+uint64_t Fnv1a(uint64_t hash, const void* data, size_t size) {
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	for (size_t i = 0; i < size; ++i) {
+		hash ^= bytes[i];
+		hash *= kFnvPrime;
+	}
+	return hash;
+}
+
+uint64_t HashImage(uint64_t hash, const ImageData& image) {
+	int32_t size[3] = { image.width, image.height, image.bits_per_pixel };
+	hash = Fnv1a(hash, size, sizeof(size));
+	return Fnv1a(hash, image.data.data(), image.data.size());
+}
+
+// Replaces to with from in one step
+bool ReplaceFile(const std::string& from, const std::string& to) {
+#ifdef _WIN32
+	return MoveFileExA(from.c_str(), to.c_str(),
+		MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+	return std::rename(from.c_str(), to.c_str()) == 0;
+#endif
+}
+
+} // namespace
+
+uint64_t MapCache::MapHash(const GameInfo& game_info) {
+	uint64_t hash = Fnv1a(kFnvOffset, game_info.map_name.data(),
+		game_info.map_name.size());
+	hash = HashImage(hash, game_info.pathing_grid);
+	return HashImage(hash, game_info.placement_grid);
+}
+
+std::string MapCache::Path(const GameInfo& game_info,
+	const Point2D& start) const {
+	std::ostringstream path;
+	path << dir << "/map_" << std::hex << std::setw(16) << std::setfill('0')
+		<< MapHash(game_info) << std::dec << "_"
+		<< static_cast<int>(start.x) << "_" << static_cast<int>(start.y)
+		<< ".cache";
+	return path.str();
+}
+
+bool MapCache::Load(const GameInfo& game_info, const Point2D& start,
+	MapAnalysis& analysis) const {
+	if (!Enabled()) {
+		return false;
+	}
+	MappedFile file;
+	if (!file.Open(Path(game_info, start))) {
+		return false;
+	}
+	ByteReader in(file.Data(), file.Data() + file.Size());
+	char magic[8];
+	for (char& c : magic) {
+		c = in.Read<char>();
+	}
+	if (!std::equal(magic, magic + 8, kMagic) ||
+		in.Read<uint32_t>() != kVersion ||
+		in.Read<uint64_t>() != MapHash(game_info)) {
+		return false;
+	}
+	Point2D cached_start = in.Read<Point2D>();
+	if (cached_start.x != start.x || cached_start.y != start.y) {
+		return false;
+	}
+
+	uint32_t count = in.Read<uint32_t>();
+	analysis.expansion_locations.clear();
+	for (uint32_t i = 0; i < count && in.Ok(); ++i) {
+		analysis.expansion_locations.push_back(in.Read<Point3D>());
+	}
+	count = in.Read<uint32_t>();
+	analysis.ramps.clear();
+	for (uint32_t i = 0; i < count && in.Ok(); ++i) {
+		analysis.ramps.emplace_back();
+		recording::ReadPoints(in, analysis.ramps.back());
+	}
+	recording::ReadPoints(in, analysis.main_base_depot_points);
+	analysis.main_base_barrack_point = in.Read<Point2D>();
+	count = in.Read<uint32_t>();
+	analysis.build_map.clear();
+	for (uint32_t i = 0; i < count && in.Ok(); ++i) {
+		analysis.build_map.emplace_back();
+		if (!analysis.build_map.back().Read(in)) {
+			return false;
+		}
+	}
+	recording::ReadPoints(in, analysis.main_mineral_convex_hull);
+	if (!analysis.regions.Read(in)) {
+		return false;
+	}
+	return in.Ok() && !analysis.build_map.empty();
+}
+
+bool MapCache::Save(const GameInfo& game_info, const Point2D& start,
+	const MapAnalysis& analysis) const {
+	if (!Enabled()) {
+		return false;
+	}
+	ByteWriter out;
+	for (char c : kMagic) {
+		out.Write(c);
+	}
+	out.Write(kVersion);
+	out.Write(MapHash(game_info));
+	out.Write(start);
+
+	out.Write(static_cast<uint32_t>(analysis.expansion_locations.size()));
+	for (const auto& location : analysis.expansion_locations) {
+		out.Write(location);
+	}
+	out.Write(static_cast<uint32_t>(analysis.ramps.size()));
+	for (const auto& ramp : analysis.ramps) {
+		recording::WritePoints(out, ramp);
+	}
+	recording::WritePoints(out, analysis.main_base_depot_points);
+	out.Write(analysis.main_base_barrack_point);
+	out.Write(static_cast<uint32_t>(analysis.build_map.size()));
+	for (const auto& region : analysis.build_map) {
+		region.Write(out);
+	}
+	recording::WritePoints(out, analysis.main_mineral_convex_hull);
+	analysis.regions.Write(out);
+
+	// Readers only ever see the old file or the complete new one
+	std::string path = Path(game_info, start);
+	std::string temp_path = path + ".tmp";
+	{
+		std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+		if (!file) {
+			return false;
+		}
+		file.write(out.Data().data(),
+			static_cast<std::streamsize>(out.Size()));
+		file.close();
+		if (!file) {
+			std::remove(temp_path.c_str());
+			return false;
+		}
+	}
+	if (!ReplaceFile(temp_path, path)) {
+		std::remove(temp_path.c_str());
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,66 @@
+#ifndef MAP_CACHE_H_
+#define MAP_CACHE_H_
+
+#include "sc2api/sc2_common.h"
+#include "sc2api/sc2_gametypes.h"
+
+#include "BuildMap.h"
+#include "RegionGraph.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Map analysis done in on_start that only depends on the map and our start
+// location
+struct MapAnalysis {
+	std::vector<sc2::Point3D> expansion_locations;
+	std::vector<std::vector<sc2::Point2D>> ramps;
+	std::vector<sc2::Point2D> main_base_depot_points;
+	sc2::Point2D main_base_barrack_point;
+	// Before any structure is stamped
+	std::vector<BuildMap> build_map;
+	std::vector<sc2::Point2D> main_mineral_convex_hull;
+	RegionGraph regions;
+};
+
+// Keeps the map analysis on disk so later games on the same map skip it.
+//
+// There is one file per map and start location, named after a hash of the
+// map name and its pathing and placement grids. Files are memory mapped to
+// load them and written to a temporary file that is renamed over the old
+// one, so a game never reads a half written cache.
+//
+// Layout (little endian):
+//   header   magic "UEDBOTMC", version, map hash, start location
+//   body     expansions, ramps, wall points, build regions, mineral hull,
+//            region graph
+//
+// Bump kVersion whenever MapAnalysis or the analysis itself changes.
+class MapCache {
+public:
+	// Directory to keep the cache files in, empty disables the cache
+	void SetDirectory(const std::string& directory) { dir = directory; }
+
+	bool Enabled() const { return !dir.empty(); }
+
+	// Fills analysis from the cache, false if there is no valid entry
+	bool Load(const sc2::GameInfo& game_info, const sc2::Point2D& start,
+		MapAnalysis& analysis) const;
+
+	// Writes the analysis, false if the file can't be written
+	bool Save(const sc2::GameInfo& game_info, const sc2::Point2D& start,
+		const MapAnalysis& analysis) const;
+
+	// FNV-1a hash of the map name and its pathing and placement grids
+	static uint64_t MapHash(const sc2::GameInfo& game_info);
+
+	// Cache file of the map and start location
+	std::string Path(const sc2::GameInfo& game_info,
+		const sc2::Point2D& start) const;
+
+private:
+	std::string dir;
+};
+
+#endif
@@ -1,5 +1,17 @@
 #include "BasicSc2Bot.h"
 
+// Candidates accepted by the local placement grid that are confirmed with
+// the game per search
+static const size_t kPlacementConfirms = 4;
+
+// Cell classes for labelling the ramps and build regions
+static const uint8_t kNoCell = 0;
+static const uint8_t kRampCell = 1;
+static const uint8_t kBuildCell = 2;
+
+// Smaller groups of unplaceable cells are not ramps
+static const size_t kMinRampCells = 8;
+
 // return (A.x - O.x) * (B.y - O.y) - (A.y - O.y) * (B.x - O.x)
 float BasicSc2Bot::cross_product(const Point2D& O, const Point2D& A,
 	const Point2D& B) const {
@@ -80,18 +92,6 @@ Point2D BasicSc2Bot::Point2D_mean(const std::vector<Point2D>& points) const {
 	return mean;
 }
 
-// Return mean of map of points
-Point2D BasicSc2Bot::Point2D_mean(
-	const std::map<Point2D, bool, Point2DComparator>& map_points) const {
-	Point2D mean;
-	for (const auto& p : map_points) {
-		mean += p.first;
-	}
-	mean /= map_points.size();
-
-	return mean;
-}
-
 // Find the intersection points of two circles
 std::vector<Point2D> BasicSc2Bot::circle_intersection(const Point2D& p1,
 	const Point2D& p2,
@@ -141,255 +141,323 @@ Point2D BasicSc2Bot::towards(const Point2D& p1, const Point2D& p2,
 	return p;
 }
 
-// update buildable map (if it is built or not?) 
-// destoryed_building is optional for the case of building destroyed
-void BasicSc2Bot::update_build_map(const bool built,
-	const Unit* destroyed_building) {
-
+// footprint of a structure in the build map
+bool BasicSc2Bot::build_map_stamp(UNIT_TYPEID type, const Point2D& pos,
+	BuildMapStamp& stamp) {
 	const Point2D offset(0.5, 0.5);
-	Point2D building_point;
-
-	// 0: main_base_build_map
-	auto& base_build_map = build_map[0];
 
-	// building footprint radius
-	const auto b_bool = built ? false : true;
+	// structure positions are whole or half cells, round to the cell corner
+	auto cell = [](float v) { return static_cast<int>(std::floor(v + 0.5f)); };
+
+	// 2x2
+	if (type == UNIT_TYPEID::TERRAN_SUPPLYDEPOT ||
+		type == UNIT_TYPEID::TERRAN_SUPPLYDEPOTLOWERED ||
+		type == UNIT_TYPEID::TERRAN_MISSILETURRET) {
+		// I need to check 0,0, 0,-1, -1,0, -1,-1
+		stamp.x = cell(pos.x) - 1;
+		stamp.y = cell(pos.y) - 1;
+		stamp.w = stamp.h = 2;
+	}
+	// 3x3 + 2x2 (3.5) add_on ->
+	else if (type == UNIT_TYPEID::TERRAN_BARRACKS ||
+		type == UNIT_TYPEID::TERRAN_FACTORY ||
+		type == UNIT_TYPEID::TERRAN_STARPORT) {
+		Point2D center_point = pos - offset;
+		stamp.x = cell(center_point.x) - 1;
+		stamp.y = cell(center_point.y) - 1;
+		stamp.w = stamp.h = 3;
+	}
+	else if (type == UNIT_TYPEID::TERRAN_BARRACKSTECHLAB ||
+		type == UNIT_TYPEID::TERRAN_BARRACKSREACTOR ||
+		type == UNIT_TYPEID::TERRAN_FACTORYTECHLAB ||
+		type == UNIT_TYPEID::TERRAN_FACTORYREACTOR ||
+		type == UNIT_TYPEID::TERRAN_STARPORTTECHLAB ||
+		type == UNIT_TYPEID::TERRAN_STARPORTREACTOR) {
+		// the actual building size is 2x2
+		// check 6x6
+		stamp.x = cell(pos.x) - 3;
+		stamp.y = cell(pos.y) - 3;
+		stamp.w = stamp.h = 7;
+	}
+	// 3x3  +2 = 5x3
+	else if (type == UNIT_TYPEID::TERRAN_ENGINEERINGBAY ||
+		type == UNIT_TYPEID::TERRAN_ARMORY ||
+		type == UNIT_TYPEID::TERRAN_FUSIONCORE ||
+		type == UNIT_TYPEID::TERRAN_BUNKER) {
+		Point2D center_point = pos - offset;
+		stamp.x = cell(center_point.x) - 1;
+		stamp.y = cell(center_point.y) - 1;
+		stamp.w = stamp.h = 3;
+	}
+	// 5x5
+	else if (type == UNIT_TYPEID::TERRAN_COMMANDCENTER ||
+		type == UNIT_TYPEID::TERRAN_ORBITALCOMMAND ||
+		type == UNIT_TYPEID::TERRAN_PLANETARYFORTRESS) {
+		Point2D center_point = pos - offset;
+		stamp.x = cell(center_point.x) - 2;
+		stamp.y = cell(center_point.y) - 2;
+		stamp.w = stamp.h = 5;
+	}
+	else {
+		return false;
+	}
+	return true;
+}
 
-	const ObservationInterface* obs = Observation();
-	Units buildings =
-		destroyed_building
-		? Units{ destroyed_building }
-		: obs->GetUnits(Unit::Alliance::Self, [this](const Unit& b) {
-		return IsFriendlyStructure(b);
-			});
+// stamp the footprint of a structure placed, completed or landed
+void BasicSc2Bot::stamp_structure(const Unit* structure) {
+	BuildMapStamp stamp;
+	if (build_map.empty() || structure->is_flying ||
+		!build_map_stamp(structure->unit_type, structure->pos, stamp)) {
+		return;
+	}
+	auto stamped = structure_stamps.find(structure->tag);
+	if (stamped != structure_stamps.end()) {
+		if (stamped->second == stamp) {
+			return;
+		}
+		unstamp_structure(structure->tag);
+	}
+	structure_stamps[structure->tag] = stamp;
+	build_map[0].Set(stamp.x, stamp.y, stamp.w, stamp.h, false);
+	build_slots.Refresh(build_map[0], stamp.x, stamp.y, stamp.w, stamp.h);
 
-	for (auto& b : buildings) {
-		auto b_type = b->unit_type.ToType();
-		building_point = Point2D(b->pos.x, b->pos.y);
+	// the builder's reservation is now the structure
+	for (auto it = build_reservations.begin(); it != build_reservations.end();) {
+		if (it->second.stamp == stamp) {
+			it = build_reservations.erase(it);
+		}
+		else {
+			++it;
+		}
+	}
+}
 
-		// 2x2
-		if (b_type == UNIT_TYPEID::TERRAN_SUPPLYDEPOT ||
-			b_type == UNIT_TYPEID::TERRAN_SUPPLYDEPOTLOWERED ||
-			b_type == UNIT_TYPEID::TERRAN_MISSILETURRET) {
-			// b_radius = 1.0f;
+// free the footprint of a destroyed or lifted structure
+void BasicSc2Bot::unstamp_structure(Tag tag) {
+	auto stamped = structure_stamps.find(tag);
+	if (stamped == structure_stamps.end()) {
+		return;
+	}
+	BuildMapStamp stamp = stamped->second;
+	structure_stamps.erase(stamped);
+	free_build_map(stamp);
+}
 
-			// I need to check 0,0, 0,-1, -1,0, -1,-1
-			for (int dx = -1; dx <= 0; ++dx) {
-				for (int dy = -1; dy <= 0; ++dy) {
-					base_build_map[building_point + Point2D(dx, dy)] = b_bool;
-				}
-			}
+// reserve the footprint of the structure a builder was ordered to build
+void BasicSc2Bot::reserve_build_map(const Unit* builder, ABILITY_ID ability,
+	const Point2D& location) {
+	BuildMapStamp stamp;
+	if (!builder || build_map.empty() ||
+		!build_map_stamp(BuildStructure(ability), location, stamp)) {
+		return;
+	}
+#ifdef UEDBOT_CHECK_BUILD_MAP
+	for (const auto& other : build_reservations) {
+		if (other.first != builder->tag && other.second.stamp.Overlaps(stamp)) {
+			std::cout << "Build site at " << location.x << ", " << location.y
+				<< " already reserved at game loop " << current_gameloop
+				<< std::endl;
 		}
-		// 3x3 + 2x2 (3.5) add_on ->
-		else if (b_type == UNIT_TYPEID::TERRAN_BARRACKS ||
-			b_type == UNIT_TYPEID::TERRAN_FACTORY ||
-			b_type == UNIT_TYPEID::TERRAN_STARPORT) {
+	}
+#endif
+	release_build_map(builder->tag);
+	build_reservations[builder->tag] =
+		BuildReservation{ stamp, ability, location, current_gameloop };
+	build_map[0].Set(stamp.x, stamp.y, stamp.w, stamp.h, false);
+	build_slots.Refresh(build_map[0], stamp.x, stamp.y, stamp.w, stamp.h);
+}
 
-			// b_radius = 1.5f;
+// drop the reservation of a builder
+void BasicSc2Bot::release_build_map(Tag builder) {
+	auto reserved = build_reservations.find(builder);
+	if (reserved == build_reservations.end()) {
+		return;
+	}
+	BuildMapStamp stamp = reserved->second.stamp;
+	build_reservations.erase(reserved);
+	free_build_map(stamp);
+}
 
-			Point2D center_point = building_point - offset;
-			for (int dx = -1; dx <= 1; ++dx) {
-				for (int dy = -1; dy <= 1; ++dy) {
-					base_build_map[center_point + Point2D(dx, dy)] = b_bool;
-				}
-			}
+// put the map's own cells back under the footprint, keeping the cells of
+// the footprints overlapping it
+void BasicSc2Bot::free_build_map(const BuildMapStamp& stamp) {
+	BuildMap& base_build_map = build_map[0];
+	base_build_map.Restore(stamp.x, stamp.y, stamp.w, stamp.h,
+		build_map_terrain);
+	for (const auto& other : structure_stamps) {
+		if (other.second.Overlaps(stamp)) {
+			base_build_map.Set(other.second.x, other.second.y,
+				other.second.w, other.second.h, false);
 		}
-		else if (b_type == UNIT_TYPEID::TERRAN_BARRACKSTECHLAB ||
-			b_type == UNIT_TYPEID::TERRAN_BARRACKSREACTOR ||
-			b_type == UNIT_TYPEID::TERRAN_FACTORYTECHLAB ||
-			b_type == UNIT_TYPEID::TERRAN_FACTORYREACTOR ||
-			b_type == UNIT_TYPEID::TERRAN_STARPORTTECHLAB ||
-			b_type == UNIT_TYPEID::TERRAN_STARPORTREACTOR) {
-
-			// the actual building size is 2x2
-			// b_radius = 3.5f;
-
-			// check 6x6
-			for (int dx = -3; dx <= 3; ++dx) {
-				for (int dy = -3; dy <= 3; ++dy) {
-					Point2D grid_point = building_point + Point2D(dx, dy);
-					base_build_map[grid_point] = b_bool;
-				}
-			}
+	}
+	for (const auto& other : build_reservations) {
+		if (other.second.stamp.Overlaps(stamp)) {
+			base_build_map.Set(other.second.stamp.x, other.second.stamp.y,
+				other.second.stamp.w, other.second.stamp.h, false);
 		}
+	}
+	build_slots.Refresh(base_build_map, stamp.x, stamp.y, stamp.w, stamp.h);
+}
 
-		// 3x3  +2 = 5x3
-		else if (b_type == UNIT_TYPEID::TERRAN_ENGINEERINGBAY ||
-			b_type == UNIT_TYPEID::TERRAN_ARMORY ||
-			b_type == UNIT_TYPEID::TERRAN_FUSIONCORE ||
-			b_type == UNIT_TYPEID::TERRAN_BUNKER) {
+// follow lifted and landed structures, and drop reservations of builders
+// that gave up
+void BasicSc2Bot::update_build_map() {
+	PROFILE_SCOPE("update_build_map");
+	const ObservationInterface* obs = Observation();
 
-			// b_radius = 1.5f;
+	std::vector<Tag> changed;
+	for (const auto& stamped : structure_stamps) {
+		const Unit* structure = obs->GetUnit(stamped.first);
+		if (structure && (structure->is_flying ||
+			!IsFriendlyStructure(*structure))) {
+			changed.push_back(stamped.first);
+		}
+	}
+	for (Tag tag : changed) {
+		unstamp_structure(tag);
+		lifted_structures.insert(tag);
+	}
 
-			Point2D center_point = building_point - offset;
-			for (int dx = -1; dx <= 1; ++dx) {
-				for (int dy = -1; dy <= 1; ++dy) {
-					base_build_map[center_point + Point2D(dx, dy)] = b_bool;
-				}
-			}
+	for (auto it = lifted_structures.begin(); it != lifted_structures.end();) {
+		const Unit* structure = obs->GetUnit(*it);
+		if (!structure) {
+			it = lifted_structures.erase(it);
 		}
-		// 5x5
-		else if (b_type == UNIT_TYPEID::TERRAN_COMMANDCENTER ||
-			b_type == UNIT_TYPEID::TERRAN_ORBITALCOMMAND ||
-			b_type == UNIT_TYPEID::TERRAN_PLANETARYFORTRESS) {
-
-			// b_radius = 2.5f;
-
-			Point2D center_point = building_point - offset;
-			for (int dx = -2; dx <= 2; ++dx) {
-				for (int dy = -2; dy <= 2; ++dy) {
-					Point2D grid_point = center_point + Point2D(dx, dy);
-					base_build_map[grid_point] = b_bool;
-				}
-			}
+		else if (!structure->is_flying && IsFriendlyStructure(*structure)) {
+			stamp_structure(structure);
+			it = lifted_structures.erase(it);
+		}
+		else {
+			++it;
 		}
 	}
-}
 
-// With the given point, check if there is a building in the area
-// if addon is true, check 3x3 + 2x2
-bool BasicSc2Bot::area33_check(const Point2D& b, const bool addon) {
-	auto& base_build_map = build_map[0];
-	Point2D offset(0.5, 0.5);
-	Point2D b_offset = b - offset;
-	Point2D grid_point;
-	float distance_to_base = Distance2D(b, start_location);
+	// the build order shows up on the builder a few frames after it was
+	// sent, give it time before dropping the reservation
+	const uint32_t grace_loops = 16;
+	changed.clear();
+	for (const auto& reserved : build_reservations) {
+		if (current_gameloop < reserved.second.game_loop + grace_loops) {
+			continue;
+		}
+		const Unit* builder = obs->GetUnit(reserved.first);
+		bool building = builder && std::any_of(builder->orders.begin(),
+			builder->orders.end(), [&reserved](const UnitOrder& order) {
+				return order.ability_id == reserved.second.ability;
+			});
+		if (!building) {
+			changed.push_back(reserved.first);
+		}
+	}
+	for (Tag tag : changed) {
+		release_build_map(tag);
+	}
 
-	// in case of the building 3x3, should not be too close or too far
-	if (!addon && (distance_to_base < 10.0f || distance_to_base > 15.0f)) {
-		return false;
+#ifdef UEDBOT_CHECK_BUILD_MAP
+	if (!check_build_map()) {
+		std::cout << "Build map out of sync at game loop "
+			<< current_gameloop << std::endl;
 	}
+#endif
+}
 
-	for (int dx = -1; dx <= 1; ++dx) {
-		for (int dy = -1; dy <= 1; ++dy) {
-			grid_point = b_offset + Point2D(dx, dy);
-			if (base_build_map.find(grid_point) != base_build_map.end() &&
-				base_build_map[grid_point]) {
-				continue;
-			}
-			return false;
+// rebuild the build map from our structures and reservations, and compare
+bool BasicSc2Bot::check_build_map() const {
+	if (build_map.empty()) {
+		return true;
+	}
+	BuildMap expected = build_map_terrain;
+	for (const auto& structure : Index().GetUnits(Unit::Alliance::Self)) {
+		BuildMapStamp stamp;
+		if (!structure->is_flying && IsFriendlyStructure(*structure) &&
+			build_map_stamp(structure->unit_type, structure->pos, stamp)) {
+			expected.Set(stamp.x, stamp.y, stamp.w, stamp.h, false);
 		}
 	}
-	// if addon is true, check 2x2 more
-	if (addon) {
-		Point2D addon_point = b_offset + Point2D(3, 0);
-		for (int dx = -1; dx <= 0; ++dx) {
-			for (int dy = -1; dy <= 0; ++dy) {
-				grid_point = addon_point + Point2D(dx, dy);
-				if (base_build_map.find(grid_point) != base_build_map.end() &&
-					base_build_map[grid_point]) {
-					continue;
-				}
-				return false;
-			}
-		}
+	for (const auto& reserved : build_reservations) {
+		const BuildMapStamp& stamp = reserved.second.stamp;
+		expected.Set(stamp.x, stamp.y, stamp.w, stamp.h, false);
 	}
-	return true;
+	return expected == build_map[0];
 }
 
-// build 3x3 + addon
-bool BasicSc2Bot::build33_after_check(
-	const Unit* builder, const AbilityID& build_ability,
-	const BasicSc2Bot::BaseLocation whereismybase, const bool addon) {
-	// limit check for 3x3 buildings
-	Point2D left_limit = main_mineral_convexHull.front();
-	Point2D right_limit = main_mineral_convexHull.back();
-	float distance_to_left = Distance2D(left_limit, start_location);
-	float distance_to_right = Distance2D(right_limit, start_location);
-
-	// different setting depending on the base location
-	switch (whereismybase) {
-	case BaseLocation::lefttop:
-		// I need to check to the top and to the left and to the bottom
-		for (float j = mainBase_barrack_point.y + 5.0f;
-			j < build_map_minmax[1].y; j += 5.0f) {
-			for (float i = mainBase_barrack_point.x - 6.0f;
-				i > build_map_minmax[0].x; i -= 6.0f) {
-				// Travel to the bottom
-				for (float k = j; k > build_map_minmax[0].y; k -= 5.0f) {
-					if (addon && InDepotArea(Point2D(i, k), whereismybase)) {
-						continue;
-					}
-					if (area33_check(Point2D(i, k), addon)) {
-						if (EnemyNearby(Point2D(i, k))) {
-							return false;
-						}
-						Actions()->UnitCommand(builder, build_ability,
-							Point2D(i, k));
-						return true;
-					}
-				}
+// lay the 3x3 slots over the main base. Structures with an addon stay out
+// of the depot area, the others go 10 to 15 from the base, and both take
+// the slots closest to the base along the ground first.
+void BasicSc2Bot::plan_build_slots() {
+	if (build_map.empty()) {
+		return;
+	}
+	build_slots.Plan(build_map_terrain, mainBase_barrack_point,
+		[this](const Point2D& center, BuildSlots::Kind kind) {
+			float distance_to_base = GroundDistance(start_location, center);
+			if (kind == BuildSlots::kAddon) {
+				return InDepotArea(center, base_location) ? -1.0f
+					: distance_to_base;
 			}
+			float straight = Distance2D(center, start_location);
+			return straight < 10.0f || straight > 15.0f ? -1.0f
+				: distance_to_base;
+		});
+	build_slots.Refresh(build_map[0]);
+}
+
+// build 3x3 + addon in the best open slot
+bool BasicSc2Bot::build33_after_check(const Unit* builder,
+	const AbilityID& build_ability, const bool addon) {
+	// a builder sent again keeps the slot it reserved
+	auto reserved = builder ? build_reservations.find(builder->tag)
+		: build_reservations.end();
+	if (reserved != build_reservations.end() &&
+		reserved->second.ability == build_ability.ToType()) {
+		Point2D location = reserved->second.location;
+		if (EnemyNearby(location)) {
+			return false;
 		}
-		break;
-	case BaseLocation::righttop:
-		for (float j = mainBase_barrack_point.y + 5.0f;
-			j < build_map_minmax[1].y; j += 5.0f) {
-			for (float i = mainBase_barrack_point.x; i > build_map_minmax[0].x;
-				i -= 6.0f) {
-				// Travel to the bottom
-				for (float k = j; k > build_map_minmax[0].y; k -= 5.0f) {
-					if (addon && InDepotArea(Point2D(i, k), whereismybase)) {
-						continue;
-					}
-					if (area33_check(Point2D(i, k), addon)) {
-						if (EnemyNearby(Point2D(i, k))) {
-							return false;
-						}
-						Actions()->UnitCommand(builder, build_ability,
-							Point2D(i, k));
-						return true;
-					}
-				}
-			}
+		OrderBuild(builder, build_ability, location);
+		return true;
+	}
+
+	// the slots only know our own structures, rule out the ones the local
+	// placement grid knows are taken and confirm the best few with the
+	// game. Slots the game rejects are blocked by something the build map
+	// doesn't know about and are closed for a while, the next call goes on
+	// with the slots after them.
+	const BuildSlots::Kind kind = addon ? BuildSlots::kAddon
+		: BuildSlots::kPlain;
+	build_slots.Reopen(build_map[0], current_gameloop);
+	const PlacementGrid& placement = PlacementMap();
+	std::vector<size_t> slots;
+	for (const auto& slot : build_slots.Open(kind)) {
+		Point2D center = build_slots.Center(slot.second);
+		if (addon ? !placement.CanPlaceWithAddon(center)
+			: !placement.CanPlace(center, 1.5f)) {
+			continue;
 		}
-		break;
-	case BaseLocation::leftbottom:
-		for (float j = mainBase_barrack_point.y - 5.0f;
-			j < build_map_minmax[1].y; j += 5.0f) {
-			for (float i = mainBase_barrack_point.x; i < build_map_minmax[1].x;
-				i += 6.0f) {
-				// Travel to the bottom
-				for (float k = j; k > build_map_minmax[0].y; k -= 5.0f) {
-					if (addon && InDepotArea(Point2D(i, k), whereismybase)) {
-						continue;
-					}
-					if (area33_check(Point2D(i, k), addon)) {
-						if (EnemyNearby(Point2D(i, k))) {
-							return false;
-						}
-						Actions()->UnitCommand(builder, build_ability,
-							Point2D(i, k));
-						return true;
-					}
-				}
-			}
+		if (slots.empty() && EnemyNearby(center)) {
+			return false;
 		}
-		break;
-	case BaseLocation::rightbottom:
-		for (float j = mainBase_barrack_point.y - 5.0f;
-			j < build_map_minmax[1].y; j += 5.0f) {
-			for (float i = mainBase_barrack_point.x; i < build_map_minmax[1].x;
-				i += 6.0f) {
-				// Travel to the bottom
-				for (float k = j; k > build_map_minmax[0].y; k -= 5.0f) {
-					if (addon && InDepotArea(Point2D(i, k), whereismybase)) {
-						continue;
-					}
-					if (area33_check(Point2D(i, k), addon)) {
-						if (EnemyNearby(Point2D(i, k))) {
-							return false;
-						}
-						Actions()->UnitCommand(builder, build_ability,
-							Point2D(i, k));
-						return true;
-					}
-				}
-			}
+		slots.push_back(slot.second);
+		if (slots.size() == kPlacementConfirms) {
+			break;
 		}
-		break;
 	}
-	return false;
+
+	std::vector<QueryInterface::PlacementQuery> candidates;
+	for (size_t slot : slots) {
+		candidates.emplace_back(build_ability, build_slots.Center(slot));
+	}
+	int valid = FirstValidPlacement(candidates);
+	for (int i = 0; i < (valid < 0 ? static_cast<int>(candidates.size())
+		: valid); ++i) {
+		build_slots.Close(slots[i], kind, current_gameloop);
+	}
+	if (valid < 0) {
+		return false;
+	}
+	OrderBuild(builder, build_ability, candidates[valid].target_pos);
+	return true;
 }
 
 // check the area for the depot
@@ -403,92 +471,74 @@ bool BasicSc2Bot::depot_area_check(const Unit* builder,
 	float distance_to_right = Distance2D(right_limit, start_location);
 	float distance_to_query;
 
+	// search rows away from the mineral line
+	int j_begin, i_begin;
+	float j_end, i_end;
 	switch (whereismybase) {
 	case BaseLocation::lefttop:
-		for (int j = left_limit.y; j < build_map_minmax[1].y; ++j) {
-			for (int i = build_map_minmax[0].x; i < right_limit.x; ++i) {
-				distance_to_query = Distance2D(Point2D(i, j), start_location);
-
-				if (distance_to_query <= distance_to_right ||
-					distance_to_query <= distance_to_left ||
-					build_map[0].find(Point2D(i, j)) == build_map[0].end()) {
-					continue;
-				}
-				// DrawBoxAtLocation(debug, Point3D(i + 0.5f, j + 0.5f,
-				// height_at(Point2DI(i, j)) + 0.1f), 1.0f, sc2::Colors::Red);
-				if (Query()->Placement(build_ability, Point2D(i, j))) {
-					Actions()->UnitCommand(builder, build_ability,
-						Point2D(i, j), false);
-					return true;
-				}
-			}
-		}
+		j_begin = left_limit.y;
+		j_end = build_map_minmax[1].y;
+		i_begin = build_map_minmax[0].x;
+		i_end = right_limit.x;
 		break;
-
 	case BaseLocation::righttop:
-		for (int j = right_limit.y; j < build_map_minmax[1].y; ++j) {
-			for (int i = left_limit.x; i < build_map_minmax[1].x; ++i) {
-				distance_to_query = Distance2D(Point2D(i, j), start_location);
-
-				if (distance_to_query <= distance_to_right ||
-					distance_to_query <= distance_to_left ||
-					build_map[0].find(Point2D(i, j)) == build_map[0].end()) {
-					continue;
-				}
-				// DrawBoxAtLocation(debug, Point3D(i + 0.5f, j + 0.5f,
-				// height_at(Point2DI(i, j)) + 0.1f), 1.0f, sc2::Colors::Red);
-				if (Query()->Placement(build_ability, Point2D(i, j))) {
-					Actions()->UnitCommand(builder, build_ability,
-						Point2D(i, j), false);
-					return true;
-				}
-			}
-		}
+		j_begin = right_limit.y;
+		j_end = build_map_minmax[1].y;
+		i_begin = left_limit.x;
+		i_end = build_map_minmax[1].x;
 		break;
-
 	case BaseLocation::leftbottom:
-		for (int j = build_map_minmax[0].y; j < left_limit.y; ++j) {
-			for (int i = build_map_minmax[0].x; i < right_limit.x; ++i) {
-				distance_to_query = Distance2D(Point2D(i, j), start_location);
-
-				if (distance_to_query <= distance_to_right ||
-					distance_to_query <= distance_to_left ||
-					build_map[0].find(Point2D(i, j)) == build_map[0].end()) {
-					continue;
-				}
-				// DrawBoxAtLocation(debug, Point3D(i + 0.5f, j + 0.5f,
-				// height_at(Point2DI(i, j)) + 0.1f), 1.0f, sc2::Colors::Red);
-				if (Query()->Placement(build_ability, Point2D(i, j))) {
-					Actions()->UnitCommand(builder, build_ability,
-						Point2D(i, j), false);
-					return true;
-				}
-			}
-		}
+		j_begin = build_map_minmax[0].y;
+		j_end = left_limit.y;
+		i_begin = build_map_minmax[0].x;
+		i_end = right_limit.x;
 		break;
 	case BaseLocation::rightbottom:
-		for (int j = build_map_minmax[0].y; j < right_limit.y; ++j) {
-			for (int i = left_limit.x; i < build_map_minmax[1].x; ++i) {
-				distance_to_query = Distance2D(Point2D(i, j), start_location);
-
-				if (distance_to_query <= distance_to_right ||
-					distance_to_query <= distance_to_left ||
-					build_map[0].find(Point2D(i, j)) == build_map[0].end()) {
-					continue;
-				}
-				// DrawBoxAtLocation(debug, Point3D(i + 0.5f, j + 0.5f,
-				// height_at(Point2DI(i, j)) + 0.1f), 1.0f, sc2::Colors::Red);
-				if (Query()->Placement(build_ability, Point2D(i, j))) {
-					Actions()->UnitCommand(builder, build_ability,
-						Point2D(i, j), false);
-					return true;
-				}
+		j_begin = build_map_minmax[0].y;
+		j_end = right_limit.y;
+		i_begin = left_limit.x;
+		i_end = build_map_minmax[1].x;
+		break;
+	default:
+		return false;
+	}
+
+	// gather the candidates the local placement grid accepts and confirm
+	// a few of them with the game. When the game rejects them all the next
+	// call goes on with the few after them.
+	const PlacementGrid& placement = PlacementMap();
+	std::vector<QueryInterface::PlacementQuery> candidates;
+	for (int j = j_begin; j < j_end; ++j) {
+		for (int i = i_begin; i < i_end; ++i) {
+			distance_to_query = Distance2D(Point2D(i, j), start_location);
+
+			if (distance_to_query <= distance_to_right ||
+				distance_to_query <= distance_to_left ||
+				!build_map[0].IsBuildable(i - 1, j - 1, 2, 2) ||
+				!placement.CanPlace(Point2D(i, j), 1.0f)) {
+				continue;
 			}
+			// DrawBoxAtLocation(debug, Point3D(i + 0.5f, j + 0.5f,
+			// height_at(Point2DI(i, j)) + 0.1f), 1.0f, sc2::Colors::Red);
+			candidates.emplace_back(build_ability, Point2D(i, j));
 		}
-		break;
 	}
 
-	return false;
+	if (depot_candidate_offset >= candidates.size()) {
+		depot_candidate_offset = 0;
+	}
+	size_t first = depot_candidate_offset;
+	std::vector<QueryInterface::PlacementQuery> batch(
+		candidates.begin() + first, candidates.begin() +
+		std::min(first + kPlacementConfirms, candidates.size()));
+	int valid = FirstValidPlacement(batch);
+	if (valid < 0) {
+		depot_candidate_offset = first + batch.size();
+		return false;
+	}
+	depot_candidate_offset = 0;
+	OrderBuild(builder, build_ability, batch[valid].target_pos, false);
+	return true;
 }
 
 // check if the given point is in the depot area
@@ -551,9 +601,8 @@ BasicSc2Bot::BaseLocation BasicSc2Bot::GetBaseLocation() const {
 // with the given point, find the closest mineral points
 std::vector<Point2D>
 BasicSc2Bot::get_close_mineral_points(Point2D& unit_pos) const {
-	const ObservationInterface* obs = Observation();
 	Units mineral_patches =
-		obs->GetUnits(Unit::Alliance::Neutral, [unit_pos](const Unit& unit) {
+		Index().GetUnits(Unit::Alliance::Neutral, [unit_pos](const Unit& unit) {
 		return IsMineralPatch()(unit) &&
 			Distance2D(unit.pos, unit_pos) < 10.0f;
 			});
@@ -611,169 +660,102 @@ BasicSc2Bot::find_terret_location_btw(std::vector<Point2D>& mineral_patches,
 	return turret_locations;
 }
 
-// return highet at the given point
-int BasicSc2Bot::height_at(const Point2DI& p) const {
-	HeightMap h_map(Observation()->GetGameInfo());
-	return static_cast<int>(h_map.TerrainHeight(p));
-}
-
-// return highet at the given point
-float BasicSc2Bot::height_at_float(const Point2DI& p) const {
-	HeightMap h_map(Observation()->GetGameInfo());
-	return h_map.TerrainHeight(p);
-}
-
-// find groups of points
-// either it is for ramps or buildable map
-// if minimum_points_per_group is -1, it is for buildable map
-void BasicSc2Bot::find_groups(std::vector<Point2D>& points,
-	int minimum_points_per_group,
-	int max_distance_between_points) {
-	const ObservationInterface* obs = Observation();
-	const int NOT_INTERESTED = -2;
-	const int NOT_COLORED_YET = -1;
-	int currentColor = NOT_COLORED_YET;
-	const float step = minimum_points_per_group == -1 ? 0.5f : 1.0f;
-	const unsigned int height =
-		static_cast<unsigned int>(obs->GetGameInfo().height / step);
-	const unsigned int width =
-		static_cast<unsigned int>(obs->GetGameInfo().width / step);
-	std::vector<std::vector<int>> picture(
-		height, std::vector<int>(width, NOT_INTERESTED));
-
-	auto paint = [&picture, &currentColor, step](const Point2D& pt) {
-		int x = static_cast<int>(pt.x / step);
-		int y = static_cast<int>(pt.y / step);
-		picture[y][x] = currentColor;
-		if (step == 0.5f) {
-			picture[y + 1][x] = currentColor;
-			picture[y][x + 1] = currentColor;
-			picture[y + 1][x + 1] = currentColor;
-		}
-		};
-
-	std::vector<Point2DI> nearby;
-	for (int dx = -max_distance_between_points;
-		dx <= max_distance_between_points; ++dx) {
-		for (int dy = -max_distance_between_points;
-			dy <= max_distance_between_points; ++dy) {
-			if (abs(dx) + abs(dy) <= max_distance_between_points) {
-				nearby.emplace_back(Point2DI(dx, dy));
-			}
-		}
-	}
-	for (const auto& point : points) {
-		paint(point);
-	}
-
-	std::vector<Point2D> remaining(points.begin(), points.end());
-	std::deque<Point2D> queue;
-
-	// flood fill
-	while (!remaining.empty()) {
-		std::vector<Point2D> currentGroup;
-		if (queue.empty()) {
-			++currentColor;
-			auto start = remaining.back();
-			remaining.pop_back();
-			paint(start);
-			queue.emplace_back(start);
-			currentGroup.emplace_back(start);
-		}
-		while (!queue.empty()) {
-			Point2D base = queue.front();
-			queue.pop_front();
-			for (const auto& offset : nearby) {
-				float px = base.x + offset.x * step;
-				float py = base.y + offset.y * step;
-				if (px < 0 || py < 0 || px >= width * step ||
-					py >= height * step) {
-					continue;
-				}
-				Point2D point(px, py);
-				auto it = std::find(remaining.begin(), remaining.end(), point);
-				if (it != remaining.end()) {
-					remaining.erase(it);
-					paint(point);
-					queue.emplace_back(point);
-					currentGroup.emplace_back(point);
-				}
-			}
-		}
-		if (minimum_points_per_group != -1) {
-			if (currentGroup.size() >= minimum_points_per_group) {
-				std::sort(currentGroup.begin(), currentGroup.end(),
-					[this](const Point2D& a, const Point2D& b) {
-						return height_at(Point2DI(a)) >
-							height_at(Point2DI(b));
+// find the ramps and the buildable map in one pass over the map
+// ramps are pathable but not placeable cells, at most 2 apart
+// build regions are placeable cells next to each other
+// only reads game_info, so it can run on a worker thread
+BasicSc2Bot::MapLayout BasicSc2Bot::find_ramps_build_map(
+	const GameInfo& game_info, const Point2D& start) {
+	MapLayout layout;
+	layout.terrain_height.Reset(game_info);
+
+	BitGrid pathable;
+	pathable.Decode(game_info.pathing_grid);
+	pathable.Crop(static_cast<int>(game_info.playable_min.x),
+		static_cast<int>(game_info.playable_min.y),
+		static_cast<int>(game_info.playable_max.x),
+		static_cast<int>(game_info.playable_max.y));
+	BitGrid placeable;
+	placeable.Decode(game_info.placement_grid);
+
+	// Both classes come from whole words of the two grids
+	BitGrid ramp_cells = pathable;
+	ramp_cells.AndNot(placeable);
+	BitGrid build_cells = pathable;
+	build_cells &= placeable;
+
+	const int width = pathable.Width();
+	const int height = pathable.Height();
+	std::vector<uint8_t> cells(static_cast<size_t>(width) * height, kNoCell);
+	ramp_cells.ForEach([&](int x, int y) { cells[x + y * width] = kRampCell; });
+	build_cells.ForEach([&](int x, int y) { cells[x + y * width] = kBuildCell; });
+
+	GridComponents components;
+	components.Label(cells, width, height, { 0, 2, 1 });
+
+	const HeightGrid& heights = layout.terrain_height;
+	for (size_t g = 0; g < components.Count(); ++g) {
+		const std::vector<Point2D>& group = components.Cells(g);
+		if (components.Class(g) == kRampCell) {
+			if (group.size() >= kMinRampCells) {
+				// highest cells first
+				std::vector<Point2D> ramp = group;
+				std::stable_sort(ramp.begin(), ramp.end(),
+					[&heights](const Point2D& a, const Point2D& b) {
+						return heights.Level(a.x, a.y) >
+							heights.Level(b.x, b.y);
 					});
-				ramps.emplace_back(currentGroup);
+				layout.ramps.emplace_back(std::move(ramp));
 			}
 		}
-		else {
-			std::map<Point2D, bool, Point2DComparator> groups;
-			if (currentGroup.size() != 1) {
-				for (const auto& point : currentGroup) {
-					groups.insert({ point, true });
-				}
-				build_map.emplace_back(groups);
-			}
+		else if (group.size() != 1) {
+			layout.build_map.emplace_back();
+			layout.build_map.back().Reset(group);
 		}
 	}
-	// This means I am trying to build a buildable map
-	if (minimum_points_per_group == -1) {
-		std::sort(
-			build_map.begin(), build_map.end(),
-			[this](const std::map<Point2D, bool, Point2DComparator>& map1,
-				const std::map<Point2D, bool, Point2DComparator>& map2) {
-					return Distance2D(Point2D_mean(map1), start_location) <
-						Distance2D(Point2D_mean(map2), start_location);
-			});
 
-		Point2D build_max;
-		Point2D build_min;
+	std::sort(
+		layout.build_map.begin(), layout.build_map.end(),
+		[&start](const BuildMap& map1, const BuildMap& map2) {
+			return Distance2D(map1.Mean(), start) <
+				Distance2D(map2.Mean(), start);
+		});
 
-		float minY = std::numeric_limits<float>::max();
-		float maxY = std::numeric_limits<float>::lowest();
+	layout.regions.Build(game_info);
+	return layout;
+}
 
-		// Iterate through the build_map to find min and max y values
-		for (const auto& p : build_map[0]) {
-			if (p.first.y < minY) {
-				minY = p.first.y;
-			}
-			if (p.first.y > maxY) {
-				maxY = p.first.y;
+// grid points across the entire map for scouting
+std::vector<Point2D> BasicSc2Bot::find_scout_points(const GameInfo& game_info) {
+	std::vector<Point2D> points;
+	BitGrid pathable;
+	pathable.Decode(game_info.pathing_grid);
+	const int step_size = 15;
+	for (int x = 0; x < game_info.width; x += step_size) {
+		for (int y = 0; y < game_info.height; y += step_size) {
+			if (pathable.Get(x, y)) {
+				points.emplace_back(static_cast<float>(x),
+					static_cast<float>(y));
 			}
 		}
-		build_min.x = build_map[0].begin()->first.x;  // x min
-		build_max.x = build_map[0].rbegin()->first.x; // x max
-		// Now minY and maxY hold the minimum and maximum y values respectively
-		build_min.y = minY;
-		build_max.y = maxY;
-
-		build_map_minmax = { build_min, build_max };
 	}
-	return;
+	return points;
 }
 
-// find the ramps or the buildable map
-void BasicSc2Bot::find_ramps_build_map(bool isRamp) {
-	const ObservationInterface* obs = Observation();
-	std::vector<Point2D> mapVec;
-	unsigned int width = playable_max.x;
-	unsigned int height = playable_max.y;
-	int max_num_points = isRamp ? 8 : -1;
-
-	for (unsigned int j = playable_min.y; j < height; ++j) {
-		for (unsigned int i = playable_min.x; i < width; ++i) {
-			Point2D temp(i, j);
-			if (obs->IsPathable(temp) &&
-				(isRamp ? !obs->IsPlacable(temp) : obs->IsPlacable(temp))) {
-				mapVec.emplace_back(temp);
-			}
-		}
+// start the map analysis, cached or on worker threads
+void BasicSc2Bot::start_map_analysis() {
+	map_snapshot = Observation()->GetGameInfo();
+	map_snapshot_start = Observation()->GetStartLocation();
+	map_analysis_cached =
+		map_cache.Load(map_snapshot, map_snapshot_start, cached_analysis);
+	if (!map_analysis_cached) {
+		map_layout = std::async(std::launch::async, [this]() {
+			return find_ramps_build_map(map_snapshot, map_snapshot_start);
+			});
 	}
-	find_groups(mapVec, max_num_points, 2);
+	scout_grid = std::async(std::launch::async, [this]() {
+		return find_scout_points(map_snapshot);
+		});
 }
 
 // return the points of upper or lower part of the ramp
@@ -907,7 +889,6 @@ Point2D BasicSc2Bot::barracks_correct_placement(
 // find the right ramp vector
 // For proxima map, the right ramp is not the closeest one
 void BasicSc2Bot::find_right_ramp(const Point2D& location) {
-	find_ramps_build_map(true);
 	// location could be start location or any other command center location
 	//  find the ramp set that is closest to the location
 
@@ -918,9 +899,31 @@ void BasicSc2Bot::find_right_ramp(const Point2D& location) {
 					Distance2D(Point2D_mean(b), location);
 		});
 
+	// the closest ramp at a choke leading out of the region of the location
 	std::vector<Point2D> main_ramp;
-	ramps[0].size() < ramps[1].size() ? main_ramp = ramps[0]
-		: main_ramp = ramps[1];
+	uint16_t home = map_regions.RegionNear(location, 8);
+	if (home != RegionGraph::kNoRegion) {
+		const auto& home_chokes = map_regions.Regions()[home].chokes;
+		for (size_t i = 0; i < ramps.size() && main_ramp.empty(); ++i) {
+			for (size_t c : home_chokes) {
+				const Point2D& choke = map_regions.Chokes()[c].center;
+				if (std::any_of(ramps[i].begin(), ramps[i].end(),
+					[&choke](const Point2D& p) {
+						return DistanceSquared2D(p, choke) <= 9.0f;
+					})) {
+					main_ramp = ramps[i];
+					break;
+				}
+			}
+		}
+	}
+
+	// no region information, the main ramp is the smaller of the two
+	// closest ones
+	if (main_ramp.empty()) {
+		ramps[0].size() < ramps[1].size() ? main_ramp = ramps[0]
+			: main_ramp = ramps[1];
+	}
 
 	//! right_ramp.size() == 2 and they are correct
 	mainBase_depot_points = corner_depots(main_ramp);
@@ -934,18 +937,17 @@ void BasicSc2Bot::find_right_ramp(const Point2D& location) {
 // Raise depots when enemies are nearby
 // Lower depots when no enemies are nearby
 void BasicSc2Bot::depot_control() {
-	const ObservationInterface* obs = Observation();
-
+	PROFILE_SCOPE("depot_control");
 	// checking the ramp depots
 	Units dp_being_built_1 =
-		obs->GetUnits(Unit::Self, [this](const Unit& unit) {
+		Index().GetUnits(Unit::Self, [this](const Unit& unit) {
 		// display_type == 4 means the unit is Placeholder(?)
 		return unit.unit_type == UNIT_TYPEID::TERRAN_SUPPLYDEPOT &&
 			Point2D(unit.pos) == mainBase_depot_points[0] &&
 			unit.display_type != 4;
 			});
 	Units dp_being_built_2 =
-		obs->GetUnits(Unit::Self, [this](const Unit& unit) {
+		Index().GetUnits(Unit::Self, [this](const Unit& unit) {
 		// display_type == 4 means the unit is Placeholder(?)
 		return unit.unit_type == UNIT_TYPEID::TERRAN_SUPPLYDEPOT &&
 			Point2D(unit.pos) == mainBase_depot_points[1] &&
@@ -960,11 +962,11 @@ void BasicSc2Bot::depot_control() {
 		ramp_depots[1] = const_cast<Unit*>(dp_being_built_2.front());
 	}
 
-	Units depots = obs->GetUnits(Unit::Alliance::Self,
-		IsUnit(UNIT_TYPEID::TERRAN_SUPPLYDEPOT));
-	Units lowered_depots = obs->GetUnits(
-		Unit::Alliance::Self, IsUnit(UNIT_TYPEID::TERRAN_SUPPLYDEPOTLOWERED));
-	Units enemy_units = obs->GetUnits(Unit::Alliance::Enemy);
+	Units depots = Index().GetUnits(
+		Unit::Alliance::Self, UNIT_TYPEID::TERRAN_SUPPLYDEPOT);
+	Units lowered_depots = Index().GetUnits(
+		Unit::Alliance::Self, UNIT_TYPEID::TERRAN_SUPPLYDEPOTLOWERED);
+	Units enemy_units = Index().GetUnits(Unit::Alliance::Enemy);
 
 	// Raise depots when enemies are nearby
 	for (const auto& depo : depots) {
@@ -1,15 +1,16 @@
 #include "BasicSc2Bot.h"
 
 void BasicSc2Bot::Offense() {
+	PROFILE_SCOPE("Offense");
 	const ObservationInterface* observation = Observation();
-	Units marines = observation->GetUnits(Unit::Alliance::Self,
-		IsUnit(UNIT_TYPEID::TERRAN_MARINE));
-	Units siege_tanks = observation->GetUnits(
-		Unit::Alliance::Self, IsUnit(UNIT_TYPEID::TERRAN_SIEGETANK));
-	Units battlecruisers = observation->GetUnits(
-		Unit::Alliance::Self, IsUnit(UNIT_TYPEID::TERRAN_BATTLECRUISER));
-	Units starports = observation->GetUnits(
-		Unit::Alliance::Self, IsUnit(UNIT_TYPEID::TERRAN_STARPORT));
+	Units marines = Index().GetUnits(
+		Unit::Alliance::Self, UNIT_TYPEID::TERRAN_MARINE);
+	Units siege_tanks = Index().GetUnits(
+		Unit::Alliance::Self, UNIT_TYPEID::TERRAN_SIEGETANK);
+	Units battlecruisers = Index().GetUnits(
+		Unit::Alliance::Self, UNIT_TYPEID::TERRAN_BATTLECRUISER);
+	Units starports = Index().GetUnits(
+		Unit::Alliance::Self, UNIT_TYPEID::TERRAN_STARPORT);
 
 	// Check if we should start attacking
 	if (!is_attacking) {
@@ -119,15 +120,14 @@ void BasicSc2Bot::AllOutRush() {
 		return;
 	}
 
-	const ObservationInterface* obs = Observation();
 
 	// Get all our combat units
 	Units marines =
-		obs->GetUnits(Unit::Alliance::Self, IsUnit(UNIT_TYPEID::TERRAN_MARINE));
-	Units siege_tanks = obs->GetUnits(Unit::Alliance::Self,
-		IsUnit(UNIT_TYPEID::TERRAN_SIEGETANK));
-	Units battlecruisers = obs->GetUnits(
-		Unit::Alliance::Self, IsUnit(UNIT_TYPEID::TERRAN_BATTLECRUISER));
+		Index().GetUnits(Unit::Alliance::Self, UNIT_TYPEID::TERRAN_MARINE);
+	Units siege_tanks = Index().GetUnits(
+		Unit::Alliance::Self, UNIT_TYPEID::TERRAN_SIEGETANK);
+	Units battlecruisers = Index().GetUnits(
+		Unit::Alliance::Self, UNIT_TYPEID::TERRAN_BATTLECRUISER);
 
 	// Check if we have any units to attack with
 	if (marines.empty() && siege_tanks.empty()) {
@@ -138,12 +138,12 @@ void BasicSc2Bot::AllOutRush() {
 	Units tank_near_rally;
 
 	for (const auto& marine : marines) {
-		if (Distance2D(marine->pos, rally_barrack) < 7.5f) {
+		if (GroundDistance(rally_barrack, marine->pos) < 7.5f) {
 			marine_near_rally.emplace_back(marine);
 		}
 	}
 	for (const auto& tank : siege_tanks) {
-		if (Distance2D(tank->pos, rally_factory) < 7.5f) {
+		if (GroundDistance(rally_factory, tank->pos) < 7.5f) {
 			tank_near_rally.emplace_back(tank);
 		}
 	}
@@ -157,7 +157,7 @@ void BasicSc2Bot::AllOutRush() {
 	// Check for enemy units or structures near the attack target, including
 	// snapshots
 	Units enemy_units =
-		obs->GetUnits(Unit::Alliance::Enemy, [this](const Unit& unit) {
+		Index().GetUnits(Unit::Alliance::Enemy, [this](const Unit& unit) {
 		return (unit.display_type == Unit::DisplayType::Visible ||
 			unit.display_type == Unit::DisplayType::Snapshot) &&
 			unit.is_alive && Distance2D(unit.pos, attack_target) < 25.0f;
@@ -170,10 +170,10 @@ void BasicSc2Bot::AllOutRush() {
 		float min_distance = std::numeric_limits<float>::max();
 
 		// Search for any visible unit left on the map
-		for (const auto& enemy_unit : obs->GetUnits(Unit::Alliance::Enemy)) {
+		for (const auto& enemy_unit : Index().GetUnits(Unit::Alliance::Enemy)) {
 			if (enemy_unit->display_type == Unit::DisplayType::Visible &&
 				enemy_unit->is_alive) {
-				float distance = Distance2D(enemy_unit->pos, start_location);
+				float distance = GroundDistance(start_location, enemy_unit->pos);
 				if (distance < min_distance) {
 					min_distance = distance;
 					closest_unit = enemy_unit;
@@ -189,11 +189,11 @@ void BasicSc2Bot::AllOutRush() {
 		else {
 			// Search for the closest snapshot unit
 			for (const auto& enemy_unit :
-				obs->GetUnits(Unit::Alliance::Enemy)) {
+				Index().GetUnits(Unit::Alliance::Enemy)) {
 				if (enemy_unit->display_type == Unit::DisplayType::Snapshot &&
 					enemy_unit->is_alive) {
 					float distance =
-						Distance2D(enemy_unit->pos, start_location);
+						GroundDistance(start_location, enemy_unit->pos);
 					if (distance < min_distance) {
 						min_distance = distance;
 						closest_unit = enemy_unit;
@@ -257,20 +257,18 @@ void BasicSc2Bot::AllOutRush() {
 
 // Fanout to find the hidden enemy base
 void BasicSc2Bot::CleanUp() {
-	const ObservationInterface* observation = Observation();
-
 	// Get all our combat units
-	Units marines = observation->GetUnits(Unit::Alliance::Self,
-		IsUnit(UNIT_TYPEID::TERRAN_MARINE));
-	Units siege_tanks = observation->GetUnits(
-		Unit::Alliance::Self, IsUnit(UNIT_TYPEID::TERRAN_SIEGETANK));
+	Units marines = Index().GetUnits(
+		Unit::Alliance::Self, UNIT_TYPEID::TERRAN_MARINE);
+	Units siege_tanks = Index().GetUnits(
+		Unit::Alliance::Self, UNIT_TYPEID::TERRAN_SIEGETANK);
 
 	Point2D attack_target = enemy_start_location;
-	// sort scout locations by distance to the start location
+	// sort scout locations by ground distance to the start location
 	std::sort(scout_points.begin(), scout_points.end(),
 		[this](const Point2D& a, const Point2D& b) {
-			return Distance2D(a, enemy_start_location) <
-				Distance2D(b, enemy_start_location);
+			return GroundDistance(enemy_start_location, a) <
+				GroundDistance(enemy_start_location, b);
 		});
 
 	// set the attack target
@@ -282,7 +280,7 @@ void BasicSc2Bot::CleanUp() {
 	// Check for enemy units or structures near the attack target, including
 	// snapshots
 	for (const auto& enemy_unit :
-		observation->GetUnits(Unit::Alliance::Enemy)) {
+		Index().GetUnits(Unit::Alliance::Enemy)) {
 		if ((enemy_unit->display_type == Unit::DisplayType::Visible ||
 			enemy_unit->display_type == Unit::DisplayType::Snapshot) &&
 			enemy_unit->is_alive &&
@@ -309,12 +307,10 @@ void BasicSc2Bot::CleanUp() {
 
 //Determine if we have enough army to attack
 bool BasicSc2Bot::EnoughArmy() {
-	const ObservationInterface* observation = Observation();
-
-	Units marines = observation->GetUnits(Unit::Alliance::Self,
-		IsUnit(UNIT_TYPEID::TERRAN_MARINE));
-	Units siege_tanks = observation->GetUnits(
-		Unit::Alliance::Self, IsUnit(UNIT_TYPEID::TERRAN_SIEGETANK));
+	Units marines = Index().GetUnits(
+		Unit::Alliance::Self, UNIT_TYPEID::TERRAN_MARINE);
+	Units siege_tanks = Index().GetUnits(
+		Unit::Alliance::Self, UNIT_TYPEID::TERRAN_SIEGETANK);
 
 	if (marines.empty() && siege_tanks.empty()) {
 		return false;
@@ -326,14 +322,14 @@ bool BasicSc2Bot::EnoughArmy() {
 	// Count the number of marines and siege tanks near the rally points
 	if (!marines.empty()) {
 		for (const auto& marine : marines) {
-			if (Distance2D(marine->pos, rally_barrack) <= 5.0f) {
+			if (GroundDistance(rally_barrack, marine->pos) <= 5.0f) {
 				marine_count++;
 			}
 		}
 	}
 	if (!siege_tanks.empty()) {
 		for (const auto& tank : siege_tanks) {
-			if (Distance2D(tank->pos, rally_factory) <= 5.0f) {
+			if (GroundDistance(rally_factory, tank->pos) <= 5.0f) {
 				tank_count++;
 			}
 		}
@@ -349,12 +345,10 @@ bool BasicSc2Bot::EnoughArmy() {
 
 // Issue move command continously to all attacking units
 void BasicSc2Bot::ContinuousMove() {
-	const ObservationInterface* observation = Observation();
-
-	Units marines = observation->GetUnits(Unit::Alliance::Self,
-		IsUnit(UNIT_TYPEID::TERRAN_MARINE));
-	Units siege_tanks = observation->GetUnits(
-		Unit::Alliance::Self, IsUnit(UNIT_TYPEID::TERRAN_SIEGETANK));
+	Units marines = Index().GetUnits(
+		Unit::Alliance::Self, UNIT_TYPEID::TERRAN_MARINE);
+	Units siege_tanks = Index().GetUnits(
+		Unit::Alliance::Self, UNIT_TYPEID::TERRAN_SIEGETANK);
 
 	if (marines.empty() && siege_tanks.empty()) {
 		return;
@@ -381,10 +375,8 @@ void BasicSc2Bot::ContinuousMove() {
 
 // Determine whether attacking units need to retreat
 bool BasicSc2Bot::AllRetreating() {
-	const ObservationInterface* observation = Observation();
-
-	Units battlecruisers = observation->GetUnits(
-		Unit::Alliance::Self, IsUnit(UNIT_TYPEID::TERRAN_BATTLECRUISER));
+	Units battlecruisers = Index().GetUnits(
+		Unit::Alliance::Self, UNIT_TYPEID::TERRAN_BATTLECRUISER);
 
 	bool retreat = true;
 
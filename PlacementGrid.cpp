@@ -0,0 +1,112 @@
+#include "PlacementGrid.h"
+
+#include "BitGrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace sc2;
+
+namespace {
+
+// First cell and size of a square footprint around center
+void FootprintCells(const Point2D& center, float radius, int& x0, int& y0,
+	int& size) {
+	x0 = static_cast<int>(std::floor(center.x - radius + 0.5f));
+	y0 = static_cast<int>(std::floor(center.y - radius + 0.5f));
+	size = static_cast<int>(2.0f * radius + 0.5f);
+}
+
+} // namespace
+
+void PlacementGrid::Reset(const GameInfo& game_info) {
+	BitGrid grid;
+	grid.Decode(game_info.placement_grid);
+	width = grid.Width();
+	height = grid.Height();
+	terrain = grid.Bytes(kFree);
+	cells = terrain;
+	game_loop = 0;
+}
+
+void PlacementGrid::Clear(uint32_t loop) {
+	std::copy(terrain.begin(), terrain.end(), cells.begin());
+	game_loop = loop;
+}
+
+void PlacementGrid::Stamp(const Point2D& center, float footprint_radius) {
+	int x0, y0, size;
+	FootprintCells(center, footprint_radius, x0, y0, size);
+	int x1 = std::min(x0 + size, width);
+	int y1 = std::min(y0 + size, height);
+	for (int y = std::max(y0, 0); y < y1; ++y) {
+		for (int x = std::max(x0, 0); x < x1; ++x) {
+			cells[x + y * width] = kBlocked;
+		}
+	}
+}
+
+void PlacementGrid::StampMineral(const Point2D& center) {
+	// Mineral fields are two cells wide and one high
+	int x0 = static_cast<int>(std::floor(center.x - 0.5f));
+	int y = static_cast<int>(std::floor(center.y));
+	if (y < 0 || y >= height) {
+		return;
+	}
+	for (int x = std::max(x0, 0); x < std::min(x0 + 2, width); ++x) {
+		cells[x + y * width] = kBlocked;
+	}
+}
+
+void PlacementGrid::StampLane(const Point2D& from, const Point2D& to,
+	float half_width) {
+	int x0 = std::max(static_cast<int>(std::min(from.x, to.x) - half_width), 0);
+	int y0 = std::max(static_cast<int>(std::min(from.y, to.y) - half_width), 0);
+	int x1 = std::min(
+		static_cast<int>(std::max(from.x, to.x) + half_width) + 1, width);
+	int y1 = std::min(
+		static_cast<int>(std::max(from.y, to.y) + half_width) + 1, height);
+
+	Point2D direction = to - from;
+	float length_squared =
+		direction.x * direction.x + direction.y * direction.y;
+	for (int y = y0; y < y1; ++y) {
+		for (int x = x0; x < x1; ++x) {
+			// Distance from the cell center to the closest point of the segment
+			Point2D cell(x + 0.5f, y + 0.5f);
+			float t = 0.0f;
+			if (length_squared > 0.0f) {
+				Point2D offset = cell - from;
+				t = (offset.x * direction.x + offset.y * direction.y) /
+					length_squared;
+				t = std::max(0.0f, std::min(1.0f, t));
+			}
+			Point2D closest = from + direction * t;
+			uint8_t& value = cells[x + y * width];
+			if (value == kFree &&
+				DistanceSquared2D(cell, closest) <= half_width * half_width) {
+				value = kLane;
+			}
+		}
+	}
+}
+
+bool PlacementGrid::CanPlace(const Point2D& center, float footprint_radius,
+	bool allow_lanes) const {
+	int x0, y0, size;
+	FootprintCells(center, footprint_radius, x0, y0, size);
+	for (int y = y0; y < y0 + size; ++y) {
+		for (int x = x0; x < x0 + size; ++x) {
+			if (!IsFree(x, y, allow_lanes)) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+bool PlacementGrid::CanPlaceWithAddon(const Point2D& center) const {
+	// Addons sit to the right of the building, level with its lower rows
+	return CanPlace(center, 1.5f) &&
+		CanPlace(Point2D(center.x + 2.5f, center.y - 0.5f), 1.0f);
+}
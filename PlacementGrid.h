@@ -0,0 +1,75 @@
+#ifndef PLACEMENT_GRID_H_
+#define PLACEMENT_GRID_H_
+
+#include "sc2api/sc2_common.h"
+#include "sc2api/sc2_gametypes.h"
+
+#include <cstdint>
+#include <vector>
+
+// Local copy of where structures can go, one byte per map cell.
+// Seeded from GameInfo::placement_grid and rebuilt once per frame by
+// stamping the footprints of known structures and resources. It mirrors the
+// game's placement rules closely enough to reject most bad candidates
+// without a query; the final pick should still be confirmed with
+// QueryInterface::Placement.
+// The mining lanes between our town halls and their resources are marked
+// separately: the game allows building there, but most structures
+// shouldn't.
+class PlacementGrid {
+public:
+	// Decodes the placement grid of the map
+	void Reset(const sc2::GameInfo& game_info);
+
+	// True once Reset() has been called
+	bool Initialized() const { return width > 0; }
+
+	// Game loop the footprints were stamped on
+	uint32_t GameLoop() const { return game_loop; }
+
+	// Drops all footprints, leaving the map's placement grid
+	void Clear(uint32_t game_loop);
+
+	// Marks the square footprint of a structure as occupied
+	void Stamp(const sc2::Point2D& center, float footprint_radius);
+
+	// Marks the 2x1 footprint of a mineral field as occupied
+	void StampMineral(const sc2::Point2D& center);
+
+	// Marks the free cells within half_width of the segment as a lane
+	void StampLane(const sc2::Point2D& from, const sc2::Point2D& to,
+		float half_width);
+
+	// True if the cell is placeable terrain and not occupied. Lane cells
+	// only count when allow_lanes is set.
+	bool IsFree(int x, int y, bool allow_lanes = false) const {
+		if (x < 0 || y < 0 || x >= width || y >= height) {
+			return false;
+		}
+		uint8_t cell = cells[x + y * width];
+		return cell == kFree || (allow_lanes && cell == kLane);
+	}
+
+	// True if every cell of the square footprint is free
+	bool CanPlace(const sc2::Point2D& center, float footprint_radius,
+		bool allow_lanes = false) const;
+
+	// True if a 3x3 structure and its 2x2 addon both fit
+	bool CanPlaceWithAddon(const sc2::Point2D& center) const;
+
+private:
+	enum Cell : uint8_t { kBlocked = 0, kFree = 1, kLane = 2 };
+
+	int width = 0;
+	int height = 0;
+
+	// Placeable terrain from the map, row-major from the bottom left
+	std::vector<uint8_t> terrain;
+
+	// terrain with the footprints stamped over it
+	std::vector<uint8_t> cells;
+
+	uint32_t game_loop = 0;
+};
+
+#endif
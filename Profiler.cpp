@@ -0,0 +1,121 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <string>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+
+// Index of the highest set bit, value must not be zero
+int HighestBit(uint64_t value) {
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanReverse64(&index, value);
+	return static_cast<int>(index);
+#else
+	return 63 - __builtin_clzll(value);
+#endif
+}
+
+} // namespace
+
+int LatencyHistogram::BucketIndex(uint64_t value) {
+	if (value < 2 * kSubBuckets) {
+		return static_cast<int>(value);
+	}
+	int magnitude = HighestBit(value);
+	if (magnitude >= kMaxMagnitude) {
+		return kBuckets - 1;
+	}
+	// Keep the top five bits: 1 followed by the sub-bucket
+	int shift = magnitude - 4;
+	return shift * kSubBuckets + static_cast<int>(value >> shift);
+}
+
+uint64_t LatencyHistogram::BucketValue(int index) {
+	if (index < 2 * kSubBuckets) {
+		return static_cast<uint64_t>(index);
+	}
+	int shift = index / kSubBuckets - 1;
+	uint64_t sub_bucket = index % kSubBuckets + kSubBuckets;
+	return sub_bucket << shift;
+}
+
+void LatencyHistogram::Record(uint64_t nanoseconds) {
+	++buckets[BucketIndex(nanoseconds)];
+	++count;
+	total += nanoseconds;
+	max = std::max(max, nanoseconds);
+}
+
+uint64_t LatencyHistogram::Percentile(double fraction) const {
+	if (count == 0) {
+		return 0;
+	}
+	uint64_t wanted = static_cast<uint64_t>(fraction * count + 0.5);
+	wanted = std::max<uint64_t>(wanted, 1);
+	uint64_t seen = 0;
+	for (int i = 0; i < kBuckets; ++i) {
+		seen += buckets[i];
+		if (seen >= wanted) {
+			return std::min(BucketValue(i), max);
+		}
+	}
+	return max;
+}
+
+Profiler& Profiler::Get() {
+	static Profiler profiler;
+	return profiler;
+}
+
+size_t Profiler::Register(const char* name) {
+	size_t parent = kNoParent;
+	if (!active.empty()) {
+		parent = active.back();
+	}
+	sections.push_back({ name, parent, LatencyHistogram() });
+	return sections.size() - 1;
+}
+
+void Profiler::ReportSection(std::ostream& out, size_t section,
+	int depth) const {
+	const LatencyHistogram& h = sections[section].histogram;
+	if (h.Count() > 0) {
+		auto us = [](uint64_t nanoseconds) { return nanoseconds / 1000.0; };
+		std::string name =
+			std::string(2 * depth, ' ') + sections[section].name;
+		out << std::left << std::setw(32) << name << std::right
+			<< std::setw(9) << h.Count()
+			<< std::setw(11) << h.Total() / 1e6
+			<< std::setw(10) << us(h.Total() / h.Count())
+			<< std::setw(10) << us(h.Percentile(0.50))
+			<< std::setw(10) << us(h.Percentile(0.99))
+			<< std::setw(11) << us(h.Max()) << std::endl;
+	}
+	for (size_t child = section + 1; child < sections.size(); ++child) {
+		if (sections[child].parent == section) {
+			ReportSection(out, child, depth + 1);
+		}
+	}
+}
+
+void Profiler::Report(std::ostream& out) const {
+	std::ios_base::fmtflags flags = out.flags();
+	out << std::fixed << std::setprecision(1);
+	out << std::left << std::setw(32) << "Section" << std::right
+		<< std::setw(9) << "calls" << std::setw(11) << "total ms"
+		<< std::setw(10) << "mean us" << std::setw(10) << "p50 us"
+		<< std::setw(10) << "p99 us" << std::setw(11) << "max us"
+		<< std::endl;
+	for (size_t section = 0; section < sections.size(); ++section) {
+		if (sections[section].parent == kNoParent) {
+			ReportSection(out, section, 0);
+		}
+	}
+	out.flags(flags);
+}
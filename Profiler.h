@@ -0,0 +1,124 @@
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+#include "Tracing.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+// Scoped timers for the bot's subsystems.
+// PROFILE_SCOPE("Name") at the top of a function times the rest of the
+// scope and adds the duration to the section's histogram. The report is
+// printed from OnGameEnd. While a trace is open every timed scope is also
+// written to it as a span.
+// Built only when UEDBOT_PROFILER is defined (CMake option of the same
+// name), otherwise the macro expands to nothing.
+
+// Log-linear latency histogram with fixed buckets, like HdrHistogram:
+// values below 32 ns get their own bucket, above that each power of two is
+// split into 16 buckets, so any recorded value is within ~6% of its bucket.
+// Covers up to ~2^40 ns (18 minutes).
+class LatencyHistogram {
+public:
+	static const int kSubBuckets = 16;
+	static const int kMaxMagnitude = 40;
+	static const int kBuckets = (kMaxMagnitude - 3) * kSubBuckets;
+
+	void Record(uint64_t nanoseconds);
+
+	// Smallest bucket value at or above the given fraction of samples
+	uint64_t Percentile(double fraction) const;
+
+	uint64_t Count() const { return count; }
+	uint64_t Total() const { return total; }
+	uint64_t Max() const { return max; }
+
+private:
+	static int BucketIndex(uint64_t value);
+	static uint64_t BucketValue(int index);
+
+	std::array<uint32_t, kBuckets> buckets{};
+	uint64_t count = 0;
+	uint64_t total = 0;
+	uint64_t max = 0;
+};
+
+class Profiler {
+public:
+	static Profiler& Get();
+
+	// Adds a section, called once per PROFILE_SCOPE site
+	size_t Register(const char* name);
+
+	const char* Name(size_t section) const { return sections[section].name; }
+
+	void Enter(size_t section) { active.push_back(section); }
+	void Leave(size_t section, uint64_t nanoseconds) {
+		active.pop_back();
+		sections[section].histogram.Record(nanoseconds);
+	}
+
+	// Prints calls, total, mean, p50, p99 and max of every section, nested
+	// sections indented under the one that first called them
+	void Report(std::ostream& out) const;
+
+private:
+	static const size_t kNoParent = static_cast<size_t>(-1);
+
+	struct Section {
+		const char* name;
+		size_t parent;
+		LatencyHistogram histogram;
+	};
+
+	void ReportSection(std::ostream& out, size_t section, int depth) const;
+
+	std::vector<Section> sections;
+
+	// Sections currently being timed, innermost last
+	std::vector<size_t> active;
+};
+
+class ProfileTimer {
+public:
+	explicit ProfileTimer(size_t section)
+		: section(section), start(TraceWriter::Clock::now()) {
+		Profiler::Get().Enter(section);
+	}
+	~ProfileTimer() {
+		auto end = TraceWriter::Clock::now();
+		Profiler::Get().Leave(section, static_cast<uint64_t>(
+			std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+			.count()));
+		TraceWriter& trace = TraceWriter::Get();
+		if (trace.IsOpen()) {
+			trace.Span(Profiler::Get().Name(section), "step", start, end);
+		}
+	}
+	ProfileTimer(const ProfileTimer&) = delete;
+	ProfileTimer& operator=(const ProfileTimer&) = delete;
+
+private:
+	size_t section;
+	TraceWriter::Clock::time_point start;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#ifdef UEDBOT_PROFILER
+#define PROFILE_SCOPE(name)                                                   \
+	static const size_t PROFILE_CONCAT(profile_section_, __LINE__) =          \
+		Profiler::Get().Register(name);                                       \
+	ProfileTimer PROFILE_CONCAT(profile_timer_, __LINE__)(                    \
+		PROFILE_CONCAT(profile_section_, __LINE__))
+#define PROFILE_REPORT(out) Profiler::Get().Report(out)
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_REPORT(out) ((void)0)
+#endif
+
+#endif
@@ -0,0 +1,610 @@
+#include "Recording.h"
+
+using namespace sc2;
+
+namespace recording {
+
+namespace {
+
+// Fields of a unit record, one bit each in the record's change mask
+enum UnitField : uint32_t {
+	kDisplayType = 1u << 0,
+	kAlliance = 1u << 1,
+	kUnitType = 1u << 2,
+	kOwner = 1u << 3,
+	kPosition = 1u << 4,
+	kFacing = 1u << 5,
+	kRadius = 1u << 6,
+	kBuildProgress = 1u << 7,
+	kCloak = 1u << 8,
+	kRanges = 1u << 9,
+	kFlags = 1u << 10,
+	kHealth = 1u << 11,
+	kHealthMax = 1u << 12,
+	kShield = 1u << 13,
+	kEnergy = 1u << 14,
+	kMineralContents = 1u << 15,
+	kVespeneContents = 1u << 16,
+	kOrders = 1u << 17,
+	kAddOn = 1u << 18,
+	kPassengers = 1u << 19,
+	kCargo = 1u << 20,
+	kHarvesters = 1u << 21,
+	kWeaponCooldown = 1u << 22,
+	kEngagedTarget = 1u << 23,
+	kBuffs = 1u << 24,
+	kLastSeen = 1u << 25,
+	kAllFields = (1u << 26) - 1
+};
+
+uint8_t PackFlags(const Unit& unit) {
+	return static_cast<uint8_t>(
+		(unit.is_selected ? 1 : 0) | (unit.is_on_screen ? 2 : 0) |
+		(unit.is_blip ? 4 : 0) | (unit.is_flying ? 8 : 0) |
+		(unit.is_burrowed ? 16 : 0) | (unit.is_hallucination ? 32 : 0) |
+		(unit.is_powered ? 64 : 0) | (unit.is_alive ? 128 : 0));
+}
+
+void UnpackFlags(uint8_t flags, Unit& unit) {
+	unit.is_selected = (flags & 1) != 0;
+	unit.is_on_screen = (flags & 2) != 0;
+	unit.is_blip = (flags & 4) != 0;
+	unit.is_flying = (flags & 8) != 0;
+	unit.is_burrowed = (flags & 16) != 0;
+	unit.is_hallucination = (flags & 32) != 0;
+	unit.is_powered = (flags & 64) != 0;
+	unit.is_alive = (flags & 128) != 0;
+}
+
+bool SameOrders(const std::vector<UnitOrder>& a,
+	const std::vector<UnitOrder>& b) {
+	if (a.size() != b.size()) {
+		return false;
+	}
+	for (size_t i = 0; i < a.size(); ++i) {
+		if (a[i].ability_id != b[i].ability_id ||
+			a[i].target_unit_tag != b[i].target_unit_tag ||
+			a[i].target_pos.x != b[i].target_pos.x ||
+			a[i].target_pos.y != b[i].target_pos.y ||
+			a[i].progress != b[i].progress) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool SamePassengers(const std::vector<PassengerUnit>& a,
+	const std::vector<PassengerUnit>& b) {
+	if (a.size() != b.size()) {
+		return false;
+	}
+	for (size_t i = 0; i < a.size(); ++i) {
+		if (a[i].tag != b[i].tag || a[i].health != b[i].health ||
+			a[i].unit_type != b[i].unit_type) {
+			return false;
+		}
+	}
+	return true;
+}
+
+uint32_t ChangedFields(const Unit& unit, const Unit& previous) {
+	uint32_t mask = 0;
+	if (unit.display_type != previous.display_type) mask |= kDisplayType;
+	if (unit.alliance != previous.alliance) mask |= kAlliance;
+	if (unit.unit_type != previous.unit_type) mask |= kUnitType;
+	if (unit.owner != previous.owner) mask |= kOwner;
+	if (unit.pos.x != previous.pos.x || unit.pos.y != previous.pos.y ||
+		unit.pos.z != previous.pos.z) {
+		mask |= kPosition;
+	}
+	if (unit.facing != previous.facing) mask |= kFacing;
+	if (unit.radius != previous.radius) mask |= kRadius;
+	if (unit.build_progress != previous.build_progress) {
+		mask |= kBuildProgress;
+	}
+	if (unit.cloak != previous.cloak) mask |= kCloak;
+	if (unit.detect_range != previous.detect_range ||
+		unit.radar_range != previous.radar_range) {
+		mask |= kRanges;
+	}
+	if (PackFlags(unit) != PackFlags(previous)) mask |= kFlags;
+	if (unit.health != previous.health) mask |= kHealth;
+	if (unit.health_max != previous.health_max) mask |= kHealthMax;
+	if (unit.shield != previous.shield ||
+		unit.shield_max != previous.shield_max) {
+		mask |= kShield;
+	}
+	if (unit.energy != previous.energy ||
+		unit.energy_max != previous.energy_max) {
+		mask |= kEnergy;
+	}
+	if (unit.mineral_contents != previous.mineral_contents) {
+		mask |= kMineralContents;
+	}
+	if (unit.vespene_contents != previous.vespene_contents) {
+		mask |= kVespeneContents;
+	}
+	if (!SameOrders(unit.orders, previous.orders)) mask |= kOrders;
+	if (unit.add_on_tag != previous.add_on_tag) mask |= kAddOn;
+	if (!SamePassengers(unit.passengers, previous.passengers)) {
+		mask |= kPassengers;
+	}
+	if (unit.cargo_space_taken != previous.cargo_space_taken ||
+		unit.cargo_space_max != previous.cargo_space_max) {
+		mask |= kCargo;
+	}
+	if (unit.assigned_harvesters != previous.assigned_harvesters ||
+		unit.ideal_harvesters != previous.ideal_harvesters) {
+		mask |= kHarvesters;
+	}
+	if (unit.weapon_cooldown != previous.weapon_cooldown) {
+		mask |= kWeaponCooldown;
+	}
+	if (unit.engaged_target_tag != previous.engaged_target_tag) {
+		mask |= kEngagedTarget;
+	}
+	if (unit.buffs != previous.buffs) mask |= kBuffs;
+	return mask;
+}
+
+void WriteImage(ByteWriter& out, const ImageData& image) {
+	out.Write(static_cast<int32_t>(image.width));
+	out.Write(static_cast<int32_t>(image.height));
+	out.Write(static_cast<int32_t>(image.bits_per_pixel));
+	out.WriteString(image.data);
+}
+
+void ReadImage(ByteReader& in, ImageData& image) {
+	image.width = in.Read<int32_t>();
+	image.height = in.Read<int32_t>();
+	image.bits_per_pixel = in.Read<int32_t>();
+	image.data = in.ReadString();
+}
+
+} // namespace
+
+void WritePoints(ByteWriter& out, const std::vector<Point2D>& points) {
+	out.Write(static_cast<uint32_t>(points.size()));
+	for (const auto& p : points) {
+		out.Write(p.x);
+		out.Write(p.y);
+	}
+}
+
+void ReadPoints(ByteReader& in, std::vector<Point2D>& points) {
+	uint32_t count = in.Read<uint32_t>();
+	points.clear();
+	for (uint32_t i = 0; i < count && in.Ok(); ++i) {
+		float x = in.Read<float>();
+		float y = in.Read<float>();
+		points.emplace_back(x, y);
+	}
+}
+
+void WriteGameInfo(ByteWriter& out, const GameInfo& game_info) {
+	out.Write(static_cast<int32_t>(game_info.width));
+	out.Write(static_cast<int32_t>(game_info.height));
+	out.WriteString(game_info.map_name);
+	out.Write(game_info.playable_min.x);
+	out.Write(game_info.playable_min.y);
+	out.Write(game_info.playable_max.x);
+	out.Write(game_info.playable_max.y);
+	WritePoints(out, game_info.start_locations);
+	WritePoints(out, game_info.enemy_start_locations);
+	WriteImage(out, game_info.pathing_grid);
+	WriteImage(out, game_info.placement_grid);
+	WriteImage(out, game_info.terrain_height);
+
+	out.Write(static_cast<uint32_t>(game_info.player_info.size()));
+	for (const auto& player : game_info.player_info) {
+		out.Write(player.player_id);
+		out.Write(static_cast<int32_t>(player.player_type));
+		out.Write(static_cast<int32_t>(player.race_requested));
+		out.Write(static_cast<int32_t>(player.race_actual));
+	}
+}
+
+bool ReadGameInfo(ByteReader& in, GameInfo& game_info) {
+	game_info.width = in.Read<int32_t>();
+	game_info.height = in.Read<int32_t>();
+	game_info.map_name = in.ReadString();
+	game_info.playable_min.x = in.Read<float>();
+	game_info.playable_min.y = in.Read<float>();
+	game_info.playable_max.x = in.Read<float>();
+	game_info.playable_max.y = in.Read<float>();
+	ReadPoints(in, game_info.start_locations);
+	ReadPoints(in, game_info.enemy_start_locations);
+	ReadImage(in, game_info.pathing_grid);
+	ReadImage(in, game_info.placement_grid);
+	ReadImage(in, game_info.terrain_height);
+
+	uint32_t players = in.Read<uint32_t>();
+	game_info.player_info.clear();
+	for (uint32_t i = 0; i < players && in.Ok(); ++i) {
+		PlayerInfo player;
+		player.player_id = in.Read<uint32_t>();
+		player.player_type = static_cast<PlayerType>(in.Read<int32_t>());
+		player.race_requested = static_cast<Race>(in.Read<int32_t>());
+		player.race_actual = static_cast<Race>(in.Read<int32_t>());
+		game_info.player_info.emplace_back(player);
+	}
+	return in.Ok();
+}
+
+// Only the parts of the unit type table the bot reads are kept
+void WriteUnitTypes(ByteWriter& out, const UnitTypes& unit_types) {
+	out.Write(static_cast<uint32_t>(unit_types.size()));
+	for (const auto& data : unit_types) {
+		out.Write(static_cast<uint32_t>(data.unit_type_id));
+		out.WriteString(data.name);
+		out.Write(static_cast<uint8_t>(data.available));
+		out.Write(static_cast<int32_t>(data.mineral_cost));
+		out.Write(static_cast<int32_t>(data.vespene_cost));
+		out.Write(data.food_required);
+		out.Write(data.food_provided);
+		out.Write(static_cast<uint32_t>(data.ability_id));
+		out.Write(data.build_time);
+		out.Write(data.sight_range);
+		out.Write(data.movement_speed);
+		out.Write(data.armor);
+		out.Write(static_cast<uint32_t>(data.tech_requirement));
+		out.Write(static_cast<uint8_t>(data.require_attached));
+
+		out.Write(static_cast<uint8_t>(data.attributes.size()));
+		for (const auto& attribute : data.attributes) {
+			out.Write(static_cast<int32_t>(attribute));
+		}
+		out.Write(static_cast<uint8_t>(data.weapons.size()));
+		for (const auto& weapon : data.weapons) {
+			out.Write(static_cast<int32_t>(weapon.type));
+			out.Write(weapon.damage_);
+			out.Write(static_cast<int32_t>(weapon.attacks));
+			out.Write(weapon.range);
+			out.Write(weapon.speed);
+		}
+	}
+}
+
+bool ReadUnitTypes(ByteReader& in, UnitTypes& unit_types) {
+	uint32_t count = in.Read<uint32_t>();
+	unit_types.clear();
+	unit_types.reserve(count);
+	for (uint32_t i = 0; i < count && in.Ok(); ++i) {
+		UnitTypeData data;
+		data.unit_type_id = static_cast<UNIT_TYPEID>(in.Read<uint32_t>());
+		data.name = in.ReadString();
+		data.available = in.Read<uint8_t>() != 0;
+		data.mineral_cost = in.Read<int32_t>();
+		data.vespene_cost = in.Read<int32_t>();
+		data.food_required = in.Read<float>();
+		data.food_provided = in.Read<float>();
+		data.ability_id = static_cast<ABILITY_ID>(in.Read<uint32_t>());
+		data.build_time = in.Read<float>();
+		data.sight_range = in.Read<float>();
+		data.movement_speed = in.Read<float>();
+		data.armor = in.Read<float>();
+		data.tech_requirement = static_cast<UNIT_TYPEID>(in.Read<uint32_t>());
+		data.require_attached = in.Read<uint8_t>() != 0;
+
+		uint8_t attributes = in.Read<uint8_t>();
+		for (uint8_t a = 0; a < attributes; ++a) {
+			data.attributes.emplace_back(
+				static_cast<Attribute>(in.Read<int32_t>()));
+		}
+		uint8_t weapons = in.Read<uint8_t>();
+		for (uint8_t w = 0; w < weapons; ++w) {
+			Weapon weapon;
+			weapon.type = static_cast<Weapon::TargetType>(in.Read<int32_t>());
+			weapon.damage_ = in.Read<float>();
+			weapon.attacks = in.Read<int32_t>();
+			weapon.range = in.Read<float>();
+			weapon.speed = in.Read<float>();
+			data.weapons.emplace_back(weapon);
+		}
+		unit_types.emplace_back(data);
+	}
+	return in.Ok();
+}
+
+void WriteUnit(ByteWriter& out, const Unit& unit, const Unit* previous,
+	uint32_t game_loop) {
+	uint32_t mask = previous ? ChangedFields(unit, *previous)
+		: kAllFields & ~kLastSeen;
+	if (unit.last_seen_game_loop != game_loop) {
+		mask |= kLastSeen;
+	}
+	out.Write(static_cast<uint64_t>(unit.tag));
+	out.Write(mask);
+
+	if (mask & kDisplayType) out.Write(static_cast<uint8_t>(unit.display_type));
+	if (mask & kAlliance) out.Write(static_cast<uint8_t>(unit.alliance));
+	if (mask & kUnitType) out.Write(static_cast<uint32_t>(unit.unit_type));
+	if (mask & kOwner) out.Write(static_cast<int32_t>(unit.owner));
+	if (mask & kPosition) {
+		out.Write(unit.pos.x);
+		out.Write(unit.pos.y);
+		out.Write(unit.pos.z);
+	}
+	if (mask & kFacing) out.Write(unit.facing);
+	if (mask & kRadius) out.Write(unit.radius);
+	if (mask & kBuildProgress) out.Write(unit.build_progress);
+	if (mask & kCloak) out.Write(static_cast<uint8_t>(unit.cloak));
+	if (mask & kRanges) {
+		out.Write(unit.detect_range);
+		out.Write(unit.radar_range);
+	}
+	if (mask & kFlags) out.Write(PackFlags(unit));
+	if (mask & kHealth) out.Write(unit.health);
+	if (mask & kHealthMax) out.Write(unit.health_max);
+	if (mask & kShield) {
+		out.Write(unit.shield);
+		out.Write(unit.shield_max);
+	}
+	if (mask & kEnergy) {
+		out.Write(unit.energy);
+		out.Write(unit.energy_max);
+	}
+	if (mask & kMineralContents) {
+		out.Write(static_cast<int32_t>(unit.mineral_contents));
+	}
+	if (mask & kVespeneContents) {
+		out.Write(static_cast<int32_t>(unit.vespene_contents));
+	}
+	if (mask & kOrders) {
+		out.Write(static_cast<uint8_t>(unit.orders.size()));
+		for (const auto& order : unit.orders) {
+			out.Write(static_cast<uint32_t>(order.ability_id));
+			out.Write(static_cast<uint64_t>(order.target_unit_tag));
+			out.Write(order.target_pos.x);
+			out.Write(order.target_pos.y);
+			out.Write(order.progress);
+		}
+	}
+	if (mask & kAddOn) out.Write(static_cast<uint64_t>(unit.add_on_tag));
+	if (mask & kPassengers) {
+		out.Write(static_cast<uint8_t>(unit.passengers.size()));
+		for (const auto& passenger : unit.passengers) {
+			out.Write(static_cast<uint64_t>(passenger.tag));
+			out.Write(passenger.health);
+			out.Write(static_cast<uint32_t>(passenger.unit_type));
+		}
+	}
+	if (mask & kCargo) {
+		out.Write(static_cast<int32_t>(unit.cargo_space_taken));
+		out.Write(static_cast<int32_t>(unit.cargo_space_max));
+	}
+	if (mask & kHarvesters) {
+		out.Write(static_cast<int32_t>(unit.assigned_harvesters));
+		out.Write(static_cast<int32_t>(unit.ideal_harvesters));
+	}
+	if (mask & kWeaponCooldown) out.Write(unit.weapon_cooldown);
+	if (mask & kEngagedTarget) {
+		out.Write(static_cast<uint64_t>(unit.engaged_target_tag));
+	}
+	if (mask & kBuffs) {
+		out.Write(static_cast<uint8_t>(unit.buffs.size()));
+		for (const auto& buff : unit.buffs) {
+			out.Write(static_cast<uint32_t>(buff));
+		}
+	}
+	if (mask & kLastSeen) {
+		out.Write(static_cast<uint32_t>(unit.last_seen_game_loop));
+	}
+}
+
+Tag ReadUnitTag(ByteReader& in) {
+	return static_cast<Tag>(in.Read<uint64_t>());
+}
+
+bool ReadUnitFields(ByteReader& in, Unit& unit, uint32_t game_loop) {
+	uint32_t mask = in.Read<uint32_t>();
+
+	if (mask & kDisplayType) {
+		unit.display_type = static_cast<Unit::DisplayType>(in.Read<uint8_t>());
+	}
+	if (mask & kAlliance) {
+		unit.alliance = static_cast<Unit::Alliance>(in.Read<uint8_t>());
+	}
+	if (mask & kUnitType) {
+		unit.unit_type = static_cast<UNIT_TYPEID>(in.Read<uint32_t>());
+	}
+	if (mask & kOwner) unit.owner = in.Read<int32_t>();
+	if (mask & kPosition) {
+		unit.pos.x = in.Read<float>();
+		unit.pos.y = in.Read<float>();
+		unit.pos.z = in.Read<float>();
+	}
+	if (mask & kFacing) unit.facing = in.Read<float>();
+	if (mask & kRadius) unit.radius = in.Read<float>();
+	if (mask & kBuildProgress) unit.build_progress = in.Read<float>();
+	if (mask & kCloak) {
+		unit.cloak = static_cast<Unit::CloakState>(in.Read<uint8_t>());
+	}
+	if (mask & kRanges) {
+		unit.detect_range = in.Read<float>();
+		unit.radar_range = in.Read<float>();
+	}
+	if (mask & kFlags) UnpackFlags(in.Read<uint8_t>(), unit);
+	if (mask & kHealth) unit.health = in.Read<float>();
+	if (mask & kHealthMax) unit.health_max = in.Read<float>();
+	if (mask & kShield) {
+		unit.shield = in.Read<float>();
+		unit.shield_max = in.Read<float>();
+	}
+	if (mask & kEnergy) {
+		unit.energy = in.Read<float>();
+		unit.energy_max = in.Read<float>();
+	}
+	if (mask & kMineralContents) unit.mineral_contents = in.Read<int32_t>();
+	if (mask & kVespeneContents) unit.vespene_contents = in.Read<int32_t>();
+	if (mask & kOrders) {
+		uint8_t count = in.Read<uint8_t>();
+		unit.orders.resize(count);
+		for (auto& order : unit.orders) {
+			order.ability_id = static_cast<ABILITY_ID>(in.Read<uint32_t>());
+			order.target_unit_tag = static_cast<Tag>(in.Read<uint64_t>());
+			order.target_pos.x = in.Read<float>();
+			order.target_pos.y = in.Read<float>();
+			order.progress = in.Read<float>();
+		}
+	}
+	if (mask & kAddOn) unit.add_on_tag = static_cast<Tag>(in.Read<uint64_t>());
+	if (mask & kPassengers) {
+		uint8_t count = in.Read<uint8_t>();
+		unit.passengers.resize(count);
+		for (auto& passenger : unit.passengers) {
+			passenger.tag = static_cast<Tag>(in.Read<uint64_t>());
+			passenger.health = in.Read<float>();
+			passenger.unit_type = static_cast<UNIT_TYPEID>(in.Read<uint32_t>());
+		}
+	}
+	if (mask & kCargo) {
+		unit.cargo_space_taken = in.Read<int32_t>();
+		unit.cargo_space_max = in.Read<int32_t>();
+	}
+	if (mask & kHarvesters) {
+		unit.assigned_harvesters = in.Read<int32_t>();
+		unit.ideal_harvesters = in.Read<int32_t>();
+	}
+	if (mask & kWeaponCooldown) unit.weapon_cooldown = in.Read<float>();
+	if (mask & kEngagedTarget) {
+		unit.engaged_target_tag = static_cast<Tag>(in.Read<uint64_t>());
+	}
+	if (mask & kBuffs) {
+		uint8_t count = in.Read<uint8_t>();
+		unit.buffs.clear();
+		for (uint8_t i = 0; i < count; ++i) {
+			unit.buffs.emplace_back(static_cast<BUFF_ID>(in.Read<uint32_t>()));
+		}
+	}
+	unit.last_seen_game_loop = (mask & kLastSeen) ? in.Read<uint32_t>()
+		: game_loop;
+	return in.Ok();
+}
+
+} // namespace recording
+
+FrameRecorder::~FrameRecorder() {
+	Close();
+}
+
+bool FrameRecorder::Open(const std::string& path) {
+	Close();
+	file.open(path, std::ios::binary | std::ios::trunc);
+	if (!file.is_open()) {
+		return false;
+	}
+	file.write(recording::kMagic, sizeof(recording::kMagic));
+	file.write(reinterpret_cast<const char*>(&recording::kVersion),
+		sizeof(recording::kVersion));
+	file.write(reinterpret_cast<const char*>(&recording::kChunkFrames),
+		sizeof(recording::kChunkFrames));
+	file_offset = sizeof(recording::kMagic) + 2 * sizeof(uint32_t);
+
+	index.clear();
+	dead_units.clear();
+	previous_units.clear();
+	static_written = false;
+	return true;
+}
+
+void FrameRecorder::UnitDestroyed(Tag tag) {
+	if (IsOpen()) {
+		dead_units.emplace_back(tag);
+	}
+}
+
+void FrameRecorder::WriteStatic(const ObservationInterface* obs) {
+	frame_buffer.Clear();
+	frame_buffer.Write(static_cast<uint32_t>(0));
+	recording::WriteGameInfo(frame_buffer, obs->GetGameInfo());
+	Point3D start = obs->GetStartLocation();
+	frame_buffer.Write(start.x);
+	frame_buffer.Write(start.y);
+	frame_buffer.Write(start.z);
+	frame_buffer.Write(obs->GetPlayerID());
+	recording::WriteUnitTypes(frame_buffer, obs->GetUnitTypeData());
+	frame_buffer.Patch(0,
+		static_cast<uint32_t>(frame_buffer.Size() - sizeof(uint32_t)));
+
+	file.write(frame_buffer.Data().data(), frame_buffer.Size());
+	file_offset += frame_buffer.Size();
+	static_written = true;
+}
+
+// Frame record: payload size, game loop, keyframe flag, resources,
+// upgrades, units destroyed since the last frame, then one unit record
+// per observed unit
+void FrameRecorder::Record(const ObservationInterface* obs) {
+	if (!IsOpen()) {
+		return;
+	}
+	if (!static_written) {
+		WriteStatic(obs);
+	}
+	uint32_t game_loop = obs->GetGameLoop();
+	if (!index.empty() && game_loop == last_game_loop) {
+		return;
+	}
+	last_game_loop = game_loop;
+
+	bool keyframe = index.size() % recording::kChunkFrames == 0;
+	index.push_back({ file_offset, game_loop, keyframe ? 1u : 0u });
+
+	frame_buffer.Clear();
+	frame_buffer.Write(static_cast<uint32_t>(0));
+	frame_buffer.Write(game_loop);
+	frame_buffer.Write(static_cast<uint8_t>(keyframe));
+	frame_buffer.Write(static_cast<int32_t>(obs->GetMinerals()));
+	frame_buffer.Write(static_cast<int32_t>(obs->GetVespene()));
+	frame_buffer.Write(static_cast<int32_t>(obs->GetFoodCap()));
+	frame_buffer.Write(static_cast<int32_t>(obs->GetFoodUsed()));
+
+	const std::vector<UpgradeID>& upgrades = obs->GetUpgrades();
+	frame_buffer.Write(static_cast<uint16_t>(upgrades.size()));
+	for (const auto& upgrade : upgrades) {
+		frame_buffer.Write(static_cast<uint32_t>(upgrade));
+	}
+	frame_buffer.Write(static_cast<uint16_t>(dead_units.size()));
+	for (const auto& tag : dead_units) {
+		frame_buffer.Write(static_cast<uint64_t>(tag));
+	}
+	dead_units.clear();
+
+	Units units = obs->GetUnits();
+	frame_buffer.Write(static_cast<uint32_t>(units.size()));
+	current_units.clear();
+	for (const auto& unit : units) {
+		const Unit* previous = nullptr;
+		if (!keyframe) {
+			auto it = previous_units.find(unit->tag);
+			if (it != previous_units.end()) {
+				previous = &it->second;
+			}
+		}
+		recording::WriteUnit(frame_buffer, *unit, previous, game_loop);
+		current_units.emplace(unit->tag, *unit);
+	}
+	previous_units.swap(current_units);
+
+	frame_buffer.Patch(0,
+		static_cast<uint32_t>(frame_buffer.Size() - sizeof(uint32_t)));
+	file.write(frame_buffer.Data().data(), frame_buffer.Size());
+	file_offset += frame_buffer.Size();
+}
+
+void FrameRecorder::Close() {
+	if (!IsOpen()) {
+		return;
+	}
+	recording::Footer footer;
+	footer.index_offset = file_offset;
+	footer.frame_count = static_cast<uint32_t>(index.size());
+	footer.magic = recording::kFooterMagic;
+	if (!index.empty()) {
+		file.write(reinterpret_cast<const char*>(index.data()),
+			index.size() * sizeof(recording::IndexEntry));
+	}
+	file.write(reinterpret_cast<const char*>(&footer), sizeof(footer));
+	file.close();
+}
@@ -0,0 +1,177 @@
+#ifndef RECORDING_H_
+#define RECORDING_H_
+
+#include "sc2api/sc2_interfaces.h"
+#include "sc2api/sc2_unit.h"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Binary observation log, written while playing and read back by the
+// replay bench.
+//
+// Layout (little endian):
+//   header   magic "UEDBOTRC", version, frames per chunk
+//   static   size prefixed block: game info grids, start location,
+//            player id and the unit type table
+//   frames   size prefixed records, see FrameRecorder::Record()
+//   index    one IndexEntry per frame
+//   footer   index offset, frame count, footer magic
+//
+// Frames are grouped in chunks. The first frame of a chunk is a keyframe
+// holding every unit in full, the others only store the fields that changed
+// since the previous frame, keyed by tag. Seeking goes to the keyframe of
+// the chunk and decodes forward. If the game ends without a footer (crash,
+// killed by the ladder) the index is rebuilt by walking the size prefixes.
+
+namespace recording {
+
+const char kMagic[8] = { 'U', 'E', 'D', 'B', 'O', 'T', 'R', 'C' };
+const uint32_t kFooterMagic = 0x58444E49; // "INDX"
+const uint32_t kVersion = 1;
+const uint32_t kChunkFrames = 256;
+
+struct IndexEntry {
+	uint64_t offset;
+	uint32_t game_loop;
+	uint32_t keyframe;
+};
+
+struct Footer {
+	uint64_t index_offset;
+	uint32_t frame_count;
+	uint32_t magic;
+};
+
+// Appends plain values to a byte buffer
+class ByteWriter {
+public:
+	template <typename T> void Write(const T& value) {
+		const char* bytes = reinterpret_cast<const char*>(&value);
+		buffer.append(bytes, sizeof(T));
+	}
+	void WriteString(const std::string& value) {
+		Write(static_cast<uint32_t>(value.size()));
+		buffer.append(value);
+	}
+
+	// Overwrites a value written earlier, used for size prefixes
+	template <typename T> void Patch(size_t offset, const T& value) {
+		std::memcpy(&buffer[offset], &value, sizeof(T));
+	}
+
+	size_t Size() const { return buffer.size(); }
+	const std::string& Data() const { return buffer; }
+	void Clear() { buffer.clear(); }
+
+private:
+	std::string buffer;
+};
+
+// Reads plain values straight out of a memory range. Reading past the end
+// returns zeros and clears Ok().
+class ByteReader {
+public:
+	ByteReader(const char* begin, const char* end) : cursor(begin), end(end) {}
+
+	template <typename T> T Read() {
+		T value{};
+		if (static_cast<size_t>(end - cursor) < sizeof(T)) {
+			ok = false;
+			cursor = end;
+			return value;
+		}
+		std::memcpy(&value, cursor, sizeof(T));
+		cursor += sizeof(T);
+		return value;
+	}
+	std::string ReadString() {
+		uint32_t size = Read<uint32_t>();
+		if (static_cast<size_t>(end - cursor) < size) {
+			ok = false;
+			cursor = end;
+			return std::string();
+		}
+		std::string value(cursor, size);
+		cursor += size;
+		return value;
+	}
+
+	const char* Cursor() const { return cursor; }
+	bool Ok() const { return ok; }
+
+private:
+	const char* cursor;
+	const char* end;
+	bool ok = true;
+};
+
+void WritePoints(ByteWriter& out, const std::vector<sc2::Point2D>& points);
+void ReadPoints(ByteReader& in, std::vector<sc2::Point2D>& points);
+
+void WriteGameInfo(ByteWriter& out, const sc2::GameInfo& game_info);
+bool ReadGameInfo(ByteReader& in, sc2::GameInfo& game_info);
+
+void WriteUnitTypes(ByteWriter& out, const sc2::UnitTypes& unit_types);
+bool ReadUnitTypes(ByteReader& in, sc2::UnitTypes& unit_types);
+
+// Writes the fields of unit that differ from previous, or every field when
+// previous is null. last_seen_game_loop is only stored when it isn't the
+// frame's game loop.
+void WriteUnit(ByteWriter& out, const sc2::Unit& unit,
+	const sc2::Unit* previous, uint32_t game_loop);
+
+// Reads the tag of the next unit record
+sc2::Tag ReadUnitTag(ByteReader& in);
+
+// Applies the fields of a unit record on top of unit, which must hold the
+// unit's previous state (or a default unit when it has none)
+bool ReadUnitFields(ByteReader& in, sc2::Unit& unit, uint32_t game_loop);
+
+} // namespace recording
+
+// Writes every observation of a game to a recording file.
+// Open() is called before the game starts, Record() once per step and
+// UnitDestroyed() from OnUnitDestroyed, so dead units end up in the frame
+// they died in.
+class FrameRecorder {
+public:
+	~FrameRecorder();
+
+	// Starts a recording, returns false if the file can't be created
+	bool Open(const std::string& path);
+
+	bool IsOpen() const { return file.is_open(); }
+
+	void UnitDestroyed(sc2::Tag tag);
+
+	// Appends the current observation as a frame. The static block is
+	// written on the first call.
+	void Record(const sc2::ObservationInterface* obs);
+
+	// Writes the index and footer and closes the file
+	void Close();
+
+private:
+	void WriteStatic(const sc2::ObservationInterface* obs);
+
+	std::ofstream file;
+	uint64_t file_offset = 0;
+
+	recording::ByteWriter frame_buffer;
+	std::vector<recording::IndexEntry> index;
+	std::vector<sc2::Tag> dead_units;
+
+	// Units of the previous frame, the base of the deltas
+	std::unordered_map<sc2::Tag, sc2::Unit> previous_units;
+	std::unordered_map<sc2::Tag, sc2::Unit> current_units;
+
+	uint32_t last_game_loop = 0;
+	bool static_written = false;
+};
+
+#endif
@@ -0,0 +1,391 @@
+#include "RegionGraph.h"
+
+#include "BitGrid.h"
+#include "DistanceField.h"
+#include "GridComponents.h"
+#include "Recording.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <queue>
+
+using namespace sc2;
+
+namespace {
+
+// Clearance is measured like the ground distances, 10 per straight step and
+// 14 per diagonal one
+const uint16_t kStraight = 10;
+const uint16_t kDiagonal = 14;
+
+// Cells this far from anything unpathable seed the regions, passages
+// narrower than about twice that are chokes
+const uint16_t kRegionClearance = 4 * kStraight;
+
+// Smaller open patches are flooded by the regions around them
+const size_t kMinRegionCells = 32;
+
+// Chamfer distance from every pathable cell to the closest unpathable one,
+// the map edge counting as unpathable
+std::vector<uint16_t> Clearance(const std::vector<uint8_t>& pathable,
+	int width, int height) {
+	std::vector<uint16_t> clearance(pathable.size());
+	for (size_t i = 0; i < pathable.size(); ++i) {
+		clearance[i] = pathable[i] ? 0xFFFF : 0;
+	}
+	auto at = [&](int x, int y) -> uint16_t {
+		if (x < 0 || y < 0 || x >= width || y >= height) {
+			return 0;
+		}
+		return clearance[x + y * width];
+	};
+	auto lower = [](uint16_t& value, uint16_t neighbour, uint16_t cost) {
+		if (neighbour + cost < value) {
+			value = static_cast<uint16_t>(neighbour + cost);
+		}
+	};
+	for (int y = 0; y < height; ++y) {
+		for (int x = 0; x < width; ++x) {
+			uint16_t& value = clearance[x + y * width];
+			if (value) {
+				lower(value, at(x - 1, y), kStraight);
+				lower(value, at(x, y - 1), kStraight);
+				lower(value, at(x - 1, y - 1), kDiagonal);
+				lower(value, at(x + 1, y - 1), kDiagonal);
+			}
+		}
+	}
+	for (int y = height - 1; y >= 0; --y) {
+		for (int x = width - 1; x >= 0; --x) {
+			uint16_t& value = clearance[x + y * width];
+			if (value) {
+				lower(value, at(x + 1, y), kStraight);
+				lower(value, at(x, y + 1), kStraight);
+				lower(value, at(x + 1, y + 1), kDiagonal);
+				lower(value, at(x - 1, y + 1), kDiagonal);
+			}
+		}
+	}
+	return clearance;
+}
+
+} // namespace
+
+const uint16_t RegionGraph::kNoRegion;
+
+void RegionGraph::Build(const GameInfo& game_info) {
+	width = game_info.pathing_grid.width;
+	height = game_info.pathing_grid.height;
+	const size_t cell_count = static_cast<size_t>(width) * height;
+	regions.clear();
+	chokes.clear();
+	labels.assign(cell_count, kNoRegion);
+
+	BitGrid pathing;
+	pathing.Decode(game_info.pathing_grid);
+	std::vector<uint8_t> pathable = pathing.Bytes();
+	std::vector<uint16_t> clearance = Clearance(pathable, width, height);
+
+	// Seed a region with every large enough open patch
+	std::vector<uint8_t> open(cell_count, 0);
+	for (size_t i = 0; i < cell_count; ++i) {
+		open[i] = clearance[i] >= kRegionClearance ? 1 : 0;
+	}
+	GridComponents patches;
+	patches.Label(open, width, height, { 0, 1 });
+
+	typedef std::pair<uint16_t, int> FloodEntry;
+	std::priority_queue<FloodEntry> flood;
+	for (size_t g = 0; g < patches.Count(); ++g) {
+		const std::vector<Point2D>& cells = patches.Cells(g);
+		if (cells.size() < kMinRegionCells ||
+			regions.size() == kNoRegion) {
+			continue;
+		}
+		uint16_t region = static_cast<uint16_t>(regions.size());
+		regions.emplace_back();
+		for (const auto& p : cells) {
+			int cell = static_cast<int>(p.x) + static_cast<int>(p.y) * width;
+			labels[cell] = region;
+			flood.emplace(clearance[cell], cell);
+		}
+	}
+
+	// Flood the narrower cells from the most open ones down
+	const int dx[4] = { 1, -1, 0, 0 };
+	const int dy[4] = { 0, 0, 1, -1 };
+	while (!flood.empty()) {
+		int cell = flood.top().second;
+		flood.pop();
+		int x = cell % width;
+		int y = cell / width;
+		for (int i = 0; i < 4; ++i) {
+			int nx = x + dx[i];
+			int ny = y + dy[i];
+			if (nx < 0 || ny < 0 || nx >= width || ny >= height) {
+				continue;
+			}
+			int neighbour = nx + ny * width;
+			if (pathable[neighbour] && labels[neighbour] == kNoRegion) {
+				labels[neighbour] = labels[cell];
+				flood.emplace(clearance[neighbour], neighbour);
+			}
+		}
+	}
+
+	std::vector<uint16_t> best_clearance(regions.size(), 0);
+	for (size_t cell = 0; cell < cell_count; ++cell) {
+		uint16_t region = labels[cell];
+		if (region == kNoRegion) {
+			continue;
+		}
+		Region& r = regions[region];
+		++r.size;
+		if (clearance[cell] > best_clearance[region]) {
+			best_clearance[region] = clearance[cell];
+			r.center = Point2D(cell % width + 0.5f, cell / width + 0.5f);
+		}
+	}
+
+	// Cells where two regions meet, keyed by the pair of regions
+	std::map<std::pair<uint16_t, uint16_t>, int> pairs;
+	std::vector<std::pair<uint16_t, uint16_t>> pair_regions;
+	std::vector<int> boundary(cell_count, -1);
+	for (int y = 0; y < height; ++y) {
+		for (int x = 0; x < width; ++x) {
+			int cell = x + y * width;
+			uint16_t a = labels[cell];
+			if (a == kNoRegion) {
+				continue;
+			}
+			// Right and upper neighbours, so each pair is seen once
+			for (int i = 0; i < 2; ++i) {
+				int nx = x + (i == 0 ? 1 : 0);
+				int ny = y + (i == 0 ? 0 : 1);
+				if (nx >= width || ny >= height) {
+					continue;
+				}
+				int neighbour = nx + ny * width;
+				uint16_t b = labels[neighbour];
+				if (b == kNoRegion || b == a) {
+					continue;
+				}
+				auto key = std::make_pair(std::min(a, b), std::max(a, b));
+				auto found = pairs.find(key);
+				if (found == pairs.end()) {
+					found = pairs.emplace(key,
+						static_cast<int>(pair_regions.size())).first;
+					pair_regions.push_back(key);
+				}
+				boundary[cell] = found->second;
+				boundary[neighbour] = found->second;
+			}
+		}
+	}
+
+	// Each connected stretch of a boundary is one choke
+	std::vector<int> stack;
+	for (size_t start = 0; start < cell_count; ++start) {
+		int key = boundary[start];
+		if (key < 0) {
+			continue;
+		}
+		Choke choke;
+		choke.regions[0] = pair_regions[key].first;
+		choke.regions[1] = pair_regions[key].second;
+		uint16_t widest = 0;
+		boundary[start] = -1;
+		stack.push_back(static_cast<int>(start));
+		while (!stack.empty()) {
+			int cell = stack.back();
+			stack.pop_back();
+			if (clearance[cell] > widest) {
+				widest = clearance[cell];
+				choke.center =
+					Point2D(cell % width + 0.5f, cell / width + 0.5f);
+			}
+			int x = cell % width;
+			int y = cell / width;
+			for (int ny = std::max(y - 1, 0);
+				ny <= std::min(y + 1, height - 1); ++ny) {
+				for (int nx = std::max(x - 1, 0);
+					nx <= std::min(x + 1, width - 1); ++nx) {
+					int neighbour = nx + ny * width;
+					if (boundary[neighbour] == key) {
+						boundary[neighbour] = -1;
+						stack.push_back(neighbour);
+					}
+				}
+			}
+		}
+		// The middle of the passage is half its width from either side
+		choke.width = 2.0f * widest / kStraight;
+		regions[choke.regions[0]].chokes.push_back(chokes.size());
+		regions[choke.regions[1]].chokes.push_back(chokes.size());
+		chokes.push_back(choke);
+	}
+
+	// Weigh the chokes with the ground distance from both region centers
+	DistanceField field;
+	for (size_t r = 0; r < regions.size(); ++r) {
+		field.Reset(&pathable, width, height, regions[r].center);
+		for (size_t c : regions[r].chokes) {
+			float distance = field.Distance(chokes[c].center);
+			chokes[c].distance += distance < 0.0f
+				? Distance2D(regions[r].center, chokes[c].center) : distance;
+		}
+	}
+}
+
+uint16_t RegionGraph::RegionNear(const Point2D& p, int radius) const {
+	int px = static_cast<int>(p.x);
+	int py = static_cast<int>(p.y);
+	for (int r = 0; r <= radius; ++r) {
+		for (int y = py - r; y <= py + r; ++y) {
+			for (int x = px - r; x <= px + r; ++x) {
+				if (std::max(std::abs(x - px), std::abs(y - py)) != r ||
+					x < 0 || y < 0 || x >= width || y >= height) {
+					continue;
+				}
+				if (labels[x + y * width] != kNoRegion) {
+					return labels[x + y * width];
+				}
+			}
+		}
+	}
+	return kNoRegion;
+}
+
+std::vector<size_t> RegionGraph::Route(uint16_t from, uint16_t to) const {
+	std::vector<size_t> route;
+	if (from == to || from >= regions.size() || to >= regions.size()) {
+		return route;
+	}
+
+	// Dijkstra over the regions, remembering the choke each was entered by
+	std::vector<float> distance(regions.size(), -1.0f);
+	std::vector<size_t> entered_by(regions.size(), chokes.size());
+	typedef std::pair<float, uint16_t> QueueEntry;
+	std::priority_queue<QueueEntry, std::vector<QueueEntry>,
+		std::greater<QueueEntry>> queue;
+	distance[from] = 0.0f;
+	queue.emplace(0.0f, from);
+	while (!queue.empty()) {
+		QueueEntry entry = queue.top();
+		queue.pop();
+		uint16_t region = entry.second;
+		if (entry.first > distance[region]) {
+			continue;
+		}
+		if (region == to) {
+			break;
+		}
+		for (size_t c : regions[region].chokes) {
+			uint16_t next = Across(c, region);
+			float next_distance = entry.first + chokes[c].distance;
+			if (distance[next] < 0.0f || next_distance < distance[next]) {
+				distance[next] = next_distance;
+				entered_by[next] = c;
+				queue.emplace(next_distance, next);
+			}
+		}
+	}
+	if (distance[to] < 0.0f) {
+		return route;
+	}
+	for (uint16_t region = to; region != from;
+		region = Across(entered_by[region], region)) {
+		route.push_back(entered_by[region]);
+	}
+	std::reverse(route.begin(), route.end());
+	return route;
+}
+
+void RegionGraph::Write(recording::ByteWriter& out) const {
+	out.Write(static_cast<int32_t>(width));
+	out.Write(static_cast<int32_t>(height));
+	for (uint16_t label : labels) {
+		out.Write(label);
+	}
+	out.Write(static_cast<uint32_t>(regions.size()));
+	for (const auto& region : regions) {
+		out.Write(region.center);
+		out.Write(static_cast<uint32_t>(region.size));
+		out.Write(static_cast<uint32_t>(region.chokes.size()));
+		for (size_t c : region.chokes) {
+			out.Write(static_cast<uint32_t>(c));
+		}
+	}
+	out.Write(static_cast<uint32_t>(chokes.size()));
+	for (const auto& choke : chokes) {
+		out.Write(choke.regions[0]);
+		out.Write(choke.regions[1]);
+		out.Write(choke.center);
+		out.Write(choke.width);
+		out.Write(choke.distance);
+	}
+}
+
+bool RegionGraph::Read(recording::ByteReader& in) {
+	width = in.Read<int32_t>();
+	height = in.Read<int32_t>();
+	if (!in.Ok() || width < 0 || height < 0 || width > 4096 ||
+		height > 4096) {
+		return false;
+	}
+	labels.resize(static_cast<size_t>(width) * height);
+	for (uint16_t& label : labels) {
+		label = in.Read<uint16_t>();
+	}
+	uint32_t count = in.Read<uint32_t>();
+	if (!in.Ok() || count > kNoRegion) {
+		return false;
+	}
+	regions.assign(count, Region());
+	for (auto& region : regions) {
+		region.center = in.Read<Point2D>();
+		region.size = in.Read<uint32_t>();
+		count = in.Read<uint32_t>();
+		if (!in.Ok() || count > labels.size()) {
+			return false;
+		}
+		region.chokes.resize(count);
+		for (size_t& c : region.chokes) {
+			c = in.Read<uint32_t>();
+		}
+		if (!in.Ok()) {
+			return false;
+		}
+	}
+	count = in.Read<uint32_t>();
+	if (!in.Ok() || count > labels.size()) {
+		return false;
+	}
+	chokes.resize(count);
+	for (auto& choke : chokes) {
+		choke.regions[0] = in.Read<uint16_t>();
+		choke.regions[1] = in.Read<uint16_t>();
+		choke.center = in.Read<Point2D>();
+		choke.width = in.Read<float>();
+		choke.distance = in.Read<float>();
+		if (!in.Ok() || choke.regions[0] >= regions.size() ||
+			choke.regions[1] >= regions.size()) {
+			return false;
+		}
+	}
+	for (const auto& region : regions) {
+		for (size_t c : region.chokes) {
+			if (c >= chokes.size()) {
+				return false;
+			}
+		}
+	}
+	for (uint16_t label : labels) {
+		if (label != kNoRegion && label >= regions.size()) {
+			return false;
+		}
+	}
+	return in.Ok();
+}
@@ -0,0 +1,90 @@
+#ifndef REGION_GRAPH_H_
+#define REGION_GRAPH_H_
+
+#include "sc2api/sc2_common.h"
+#include "sc2api/sc2_gametypes.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace recording {
+class ByteReader;
+class ByteWriter;
+}
+
+// The pathable map split into open regions joined by chokepoints.
+//
+// Each cell's clearance is its distance to the closest unpathable cell.
+// Connected cells with enough clearance seed the regions, which are then
+// flooded into the narrower cells from the most open ones down, so two
+// regions meet where the passage between them is narrowest. Every place
+// two regions meet is a choke, an edge of the graph weighted with the
+// ground distance between the region centers through it.
+class RegionGraph {
+public:
+	static const uint16_t kNoRegion = 0xFFFF;
+
+	struct Region {
+		// Most open cell of the region
+		sc2::Point2D center;
+		size_t size = 0;
+		std::vector<size_t> chokes;
+	};
+
+	struct Choke {
+		uint16_t regions[2];
+		// Middle of the passage between the regions
+		sc2::Point2D center;
+		// About how many cells wide the passage is
+		float width = 0.0f;
+		// Ground distance between the region centers through the choke
+		float distance = 0.0f;
+	};
+
+	// Decomposes the pathing grid of the map
+	void Build(const sc2::GameInfo& game_info);
+
+	// Region the point is in, kNoRegion if it isn't pathable or is on a
+	// patch too small to be a region
+	uint16_t RegionAt(const sc2::Point2D& p) const {
+		int x = static_cast<int>(p.x);
+		int y = static_cast<int>(p.y);
+		if (x < 0 || y < 0 || x >= width || y >= height) {
+			return kNoRegion;
+		}
+		return labels[x + y * width];
+	}
+
+	// Region of the closest cell within radius cells that has one, for
+	// points inside structures or minerals
+	uint16_t RegionNear(const sc2::Point2D& p, int radius) const;
+
+	const std::vector<Region>& Regions() const { return regions; }
+	const std::vector<Choke>& Chokes() const { return chokes; }
+
+	// Region on the other side of the choke
+	uint16_t Across(size_t choke, uint16_t region) const {
+		const Choke& c = chokes[choke];
+		return c.regions[0] == region ? c.regions[1] : c.regions[0];
+	}
+
+	// Chokes to cross on the shortest ground route between the regions,
+	// empty if they are the same or not connected
+	std::vector<size_t> Route(uint16_t from, uint16_t to) const;
+
+	// Stores the graph in the map cache, see MapCache.h
+	void Write(recording::ByteWriter& out) const;
+	bool Read(recording::ByteReader& in);
+
+private:
+	int width = 0;
+	int height = 0;
+
+	// Region of every cell, row-major from the bottom left
+	std::vector<uint16_t> labels;
+
+	std::vector<Region> regions;
+	std::vector<Choke> chokes;
+};
+
+#endif
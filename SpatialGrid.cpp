@@ -0,0 +1,173 @@
+#include "SpatialGrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace sc2;
+
+void SpatialGrid::Reset(const Point2D& min, const Point2D& max,
+	float size) {
+	origin = min;
+	cell_size = size;
+	inv_cell_size = 1.0f / size;
+	cols = std::max(1,
+		static_cast<int>(std::ceil((max.x - min.x) * inv_cell_size)));
+	rows = std::max(1,
+		static_cast<int>(std::ceil((max.y - min.y) * inv_cell_size)));
+	cell_start.assign(static_cast<size_t>(cols) * rows + 1, 0);
+	entries.clear();
+}
+
+int SpatialGrid::CellX(float x) const {
+	int cx = static_cast<int>(std::floor((x - origin.x) * inv_cell_size));
+	return std::min(std::max(cx, 0), cols - 1);
+}
+
+int SpatialGrid::CellY(float y) const {
+	int cy = static_cast<int>(std::floor((y - origin.y) * inv_cell_size));
+	return std::min(std::max(cy, 0), rows - 1);
+}
+
+// Counting sort of the units into their cells
+void SpatialGrid::Build(const Units& units, uint32_t loop) {
+	game_loop = loop;
+	std::fill(cell_start.begin(), cell_start.end(), 0);
+	unit_cells.resize(units.size());
+
+	for (size_t i = 0; i < units.size(); ++i) {
+		uint32_t cell = static_cast<uint32_t>(
+			CellY(units[i]->pos.y) * cols + CellX(units[i]->pos.x));
+		unit_cells[i] = cell;
+		++cell_start[cell + 1];
+	}
+	for (size_t i = 1; i < cell_start.size(); ++i) {
+		cell_start[i] += cell_start[i - 1];
+	}
+
+	// Fill each cell in insertion order
+	entries.resize(units.size());
+	cursor.assign(cell_start.begin(), cell_start.end() - 1);
+	for (size_t i = 0; i < units.size(); ++i) {
+		entries[cursor[unit_cells[i]]++] = {
+			units[i], static_cast<uint32_t>(i) };
+	}
+}
+
+template <typename Fn>
+bool SpatialGrid::Visit(const Point2D& pos, float radius, Fn fn) const {
+	if (entries.empty()) {
+		return false;
+	}
+	const float r2 = radius * radius;
+	const int x0 = CellX(pos.x - radius);
+	const int x1 = CellX(pos.x + radius);
+	const int y0 = CellY(pos.y - radius);
+	const int y1 = CellY(pos.y + radius);
+	for (int y = y0; y <= y1; ++y) {
+		for (int x = x0; x <= x1; ++x) {
+			const size_t cell = static_cast<size_t>(y) * cols + x;
+			for (uint32_t i = cell_start[cell]; i < cell_start[cell + 1]; ++i) {
+				const Entry& e = entries[i];
+				float d2 = DistanceSquared2D(pos, e.unit->pos);
+				if (d2 <= r2 && fn(e, d2)) {
+					return true;
+				}
+			}
+		}
+	}
+	return false;
+}
+
+Units SpatialGrid::GetUnitsWithin(const Point2D& pos, float radius) const {
+	Units result;
+	Visit(pos, radius, [&result](const Entry& e, float) {
+		result.emplace_back(e.unit);
+		return false;
+		});
+	return result;
+}
+
+bool SpatialGrid::AnyWithin(const Point2D& pos, float radius,
+	const Filter& filter) const {
+	return Visit(pos, radius, [&filter](const Entry& e, float) {
+		return filter(*e.unit);
+		});
+}
+
+const Unit* SpatialGrid::Closest(const Point2D& pos, float radius,
+	const Filter& filter) const {
+	const Entry* best = nullptr;
+	float best_d2 = std::numeric_limits<float>::max();
+	Visit(pos, radius, [&](const Entry& e, float d2) {
+		if ((d2 < best_d2 || (d2 == best_d2 && e.order < best->order)) &&
+			filter(*e.unit)) {
+			best = &e;
+			best_d2 = d2;
+		}
+		return false;
+		});
+	return best ? best->unit : nullptr;
+}
+
+float SpatialGrid::SumWithin(const Point2D& pos, float radius,
+	const std::function<float(const Unit&, float)>& weight) const {
+	float sum = 0.0f;
+	Visit(pos, radius, [&](const Entry& e, float d2) {
+		sum += weight(*e.unit, d2);
+		return false;
+		});
+	return sum;
+}
+
+Units SpatialGrid::KNearest(const Point2D& pos, size_t k,
+	float max_radius) const {
+	std::vector<std::pair<float, const Entry*>> found;
+	if (k == 0 || entries.empty()) {
+		return {};
+	}
+
+	// Widen the search until enough units are found or the grid is covered
+	float radius = std::min(cell_size, max_radius);
+	while (true) {
+		found.clear();
+		const bool covers_grid = CellX(pos.x - radius) == 0 &&
+			CellY(pos.y - radius) == 0 && CellX(pos.x + radius) == cols - 1 &&
+			CellY(pos.y + radius) == rows - 1;
+		if (covers_grid) {
+			// Units clamped into border cells may lie beyond the radius
+			const float r2 = max_radius < std::numeric_limits<float>::max()
+				? max_radius * max_radius
+				: std::numeric_limits<float>::max();
+			for (const auto& e : entries) {
+				float d2 = DistanceSquared2D(pos, e.unit->pos);
+				if (d2 <= r2) {
+					found.emplace_back(d2, &e);
+				}
+			}
+			break;
+		}
+		Visit(pos, radius, [&found](const Entry& e, float d2) {
+			found.emplace_back(d2, &e);
+			return false;
+			});
+		if (found.size() >= k || radius >= max_radius) {
+			break;
+		}
+		radius = std::min(radius * 2.0f, max_radius);
+	}
+
+	const size_t n = std::min(k, found.size());
+	std::partial_sort(found.begin(), found.begin() + n, found.end(),
+		[](const std::pair<float, const Entry*>& a,
+			const std::pair<float, const Entry*>& b) {
+			return a.first < b.first ||
+				(a.first == b.first && a.second->order < b.second->order);
+		});
+
+	Units result;
+	result.reserve(n);
+	for (size_t i = 0; i < n; ++i) {
+		result.emplace_back(found[i].second->unit);
+	}
+	return result;
+}
@@ -0,0 +1,86 @@
+#ifndef SPATIAL_GRID_H_
+#define SPATIAL_GRID_H_
+
+#include "sc2api/sc2_common.h"
+#include "sc2api/sc2_unit.h"
+#include "sc2api/sc2_unit_filters.h"
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <vector>
+
+// Uniform grid of units bucketed by position.
+// Rebuilt once per frame so proximity queries only touch the cells that
+// overlap the search radius instead of walking every unit.
+// Units inside a cell keep the order they were inserted in, and ties on
+// distance are broken by that order, matching a linear scan.
+class SpatialGrid {
+public:
+	// Sets the covered area; units outside are clamped to the border cells
+	void Reset(const sc2::Point2D& min, const sc2::Point2D& max,
+		float cell_size = 4.0f);
+
+	// Rebuilds the buckets from the given units
+	void Build(const sc2::Units& units, uint32_t game_loop);
+
+	// True once Reset() has been called
+	bool Initialized() const { return cols > 0; }
+
+	// Game loop the buckets were built on
+	uint32_t GameLoop() const { return game_loop; }
+
+	// All units within the radius (inclusive)
+	sc2::Units GetUnitsWithin(const sc2::Point2D& pos, float radius) const;
+
+	// True if a unit within the radius passes the filter
+	bool AnyWithin(const sc2::Point2D& pos, float radius,
+		const sc2::Filter& filter) const;
+
+	// Closest unit within the radius that passes the filter
+	const sc2::Unit* Closest(const sc2::Point2D& pos, float radius,
+		const sc2::Filter& filter) const;
+
+	// Sum of the weights of the units within the radius, given each unit
+	// and its squared distance
+	float SumWithin(const sc2::Point2D& pos, float radius,
+		const std::function<float(const sc2::Unit&, float)>& weight) const;
+
+	// Up to k closest units, nearest first, searching outwards ring by ring
+	sc2::Units KNearest(const sc2::Point2D& pos, size_t k,
+		float max_radius = std::numeric_limits<float>::max()) const;
+
+	// Number of units in the grid
+	size_t Size() const { return entries.size(); }
+
+private:
+	struct Entry {
+		const sc2::Unit* unit;
+		uint32_t order;
+	};
+
+	int CellX(float x) const;
+	int CellY(float y) const;
+
+	// Calls fn on every entry within the radius until it returns true
+	template <typename Fn>
+	bool Visit(const sc2::Point2D& pos, float radius, Fn fn) const;
+
+	sc2::Point2D origin;
+	float cell_size = 4.0f;
+	float inv_cell_size = 0.25f;
+	int cols = 0;
+	int rows = 0;
+
+	// Entries of cell i are entries[cell_start[i] .. cell_start[i + 1])
+	std::vector<uint32_t> cell_start;
+	std::vector<Entry> entries;
+
+	// Scratch buffers, kept between builds to avoid reallocating
+	std::vector<uint32_t> unit_cells;
+	std::vector<uint32_t> cursor;
+
+	uint32_t game_loop = 0;
+};
+
+#endif
@@ -0,0 +1,249 @@
+#include "Tracing.h"
+
+#include <cstdio>
+
+using namespace sc2;
+
+namespace {
+
+// Span over the rest of the scope, for the proxies below
+class TraceScope {
+public:
+	TraceScope(const char* name, const char* category)
+		: name(name), category(category),
+		begin(TraceWriter::Clock::now()) {
+	}
+	~TraceScope() {
+		TraceWriter::Get().Span(name, category, begin,
+			TraceWriter::Clock::now());
+	}
+	TraceScope(const TraceScope&) = delete;
+	TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+	const char* name;
+	const char* category;
+	TraceWriter::Clock::time_point begin;
+};
+
+// Names are literals from the bot, only quotes and backslashes need escaping
+void AppendEscaped(std::string& text, const char* value) {
+	for (const char* c = value; *c; ++c) {
+		if (*c == '"' || *c == '\\') {
+			text += '\\';
+		}
+		text += *c;
+	}
+}
+
+} // namespace
+
+TraceWriter& TraceWriter::Get() {
+	static TraceWriter trace_writer;
+	return trace_writer;
+}
+
+TraceWriter::~TraceWriter() {
+	Close();
+}
+
+bool TraceWriter::Open(const std::string& path) {
+	Close();
+	file.open(path, std::ios::binary | std::ios::trunc);
+	if (!file) {
+		return false;
+	}
+	file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+		"{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,"
+		"\"args\":{\"name\":\"UEDBot\"}},\n"
+		"{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,"
+		"\"args\":{\"name\":\"game\"}}";
+	epoch = Clock::now();
+	game_loop = 0;
+	stopping = false;
+	open = true;
+	writer = std::thread(&TraceWriter::WriterLoop, this);
+	return true;
+}
+
+void TraceWriter::BeginFrame(uint32_t loop) {
+	if (!open) {
+		return;
+	}
+	if (!pending.empty()) {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (queued.empty()) {
+				queued.swap(pending);
+			}
+			else {
+				// Writer is behind, keep the backlog in order
+				queued.insert(queued.end(), pending.begin(), pending.end());
+			}
+		}
+		queued_changed.notify_one();
+		pending.clear();
+	}
+	game_loop = loop;
+}
+
+void TraceWriter::Close() {
+	if (!open) {
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		queued.insert(queued.end(), pending.begin(), pending.end());
+		stopping = true;
+	}
+	pending.clear();
+	queued_changed.notify_one();
+	writer.join();
+	file << "\n]}\n";
+	file.close();
+	open = false;
+}
+
+void TraceWriter::WriterLoop() {
+	std::vector<Event> events;
+	for (;;) {
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			queued_changed.wait(lock,
+				[this] { return stopping || !queued.empty(); });
+			events.swap(queued);
+			if (events.empty() && stopping) {
+				return;
+			}
+		}
+		WriteEvents(events);
+		events.clear();
+	}
+}
+
+void TraceWriter::WriteEvents(const std::vector<Event>& events) {
+	char number[64];
+	auto micros = [](Clock::duration duration) {
+		return std::chrono::duration<double, std::micro>(duration).count();
+	};
+	text.clear();
+	for (const Event& event : events) {
+		text += ",\n{\"name\":\"";
+		AppendEscaped(text, event.name);
+		text += "\",\"cat\":\"";
+		AppendEscaped(text, event.category);
+		std::snprintf(number, sizeof(number),
+			"\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f",
+			micros(event.begin - epoch), micros(event.end - event.begin));
+		text += number;
+		std::snprintf(number, sizeof(number),
+			",\"pid\":1,\"tid\":1,\"args\":{\"loop\":%u}}", event.game_loop);
+		text += number;
+	}
+	file.write(text.data(), text.size());
+}
+
+AvailableAbilities TracedQuery::GetAbilitiesForUnit(const Unit* unit,
+	bool ignore_resource_requirements, bool use_generalized_ability) {
+	TraceScope scope("GetAbilitiesForUnit", "query");
+	return target->GetAbilitiesForUnit(unit, ignore_resource_requirements,
+		use_generalized_ability);
+}
+
+std::vector<AvailableAbilities> TracedQuery::GetAbilitiesForUnits(
+	const Units& units, bool ignore_resource_requirements,
+	bool use_generalized_ability) {
+	TraceScope scope("GetAbilitiesForUnits", "query");
+	return target->GetAbilitiesForUnits(units, ignore_resource_requirements,
+		use_generalized_ability);
+}
+
+float TracedQuery::PathingDistance(const Point2D& start, const Point2D& end) {
+	TraceScope scope("PathingDistance", "query");
+	return target->PathingDistance(start, end);
+}
+
+float TracedQuery::PathingDistance(const Unit* start, const Point2D& end) {
+	TraceScope scope("PathingDistance", "query");
+	return target->PathingDistance(start, end);
+}
+
+std::vector<float> TracedQuery::PathingDistance(
+	const std::vector<PathingQuery>& queries) {
+	TraceScope scope("PathingDistance batch", "query");
+	return target->PathingDistance(queries);
+}
+
+bool TracedQuery::Placement(const AbilityID& ability,
+	const Point2D& target_pos, const Unit* unit) {
+	TraceScope scope("Placement", "query");
+	return target->Placement(ability, target_pos, unit);
+}
+
+std::vector<bool> TracedQuery::Placement(
+	const std::vector<PlacementQuery>& queries) {
+	TraceScope scope("Placement batch", "query");
+	return target->Placement(queries);
+}
+
+void TracedActions::UnitCommand(const Unit* unit, AbilityID ability,
+	bool queued_command) {
+	TraceScope scope("UnitCommand", "action");
+	target->UnitCommand(unit, ability, queued_command);
+}
+
+void TracedActions::UnitCommand(const Unit* unit, AbilityID ability,
+	const Point2D& point, bool queued_command) {
+	TraceScope scope("UnitCommand", "action");
+	target->UnitCommand(unit, ability, point, queued_command);
+}
+
+void TracedActions::UnitCommand(const Unit* unit, AbilityID ability,
+	const Unit* unit_target, bool queued_command) {
+	TraceScope scope("UnitCommand", "action");
+	target->UnitCommand(unit, ability, unit_target, queued_command);
+}
+
+void TracedActions::UnitCommand(const Units& units, AbilityID ability,
+	bool queued_move) {
+	TraceScope scope("UnitCommand", "action");
+	target->UnitCommand(units, ability, queued_move);
+}
+
+void TracedActions::UnitCommand(const Units& units, AbilityID ability,
+	const Point2D& point, bool queued_command) {
+	TraceScope scope("UnitCommand", "action");
+	target->UnitCommand(units, ability, point, queued_command);
+}
+
+void TracedActions::UnitCommand(const Units& units, AbilityID ability,
+	const Unit* unit_target, bool queued_command) {
+	TraceScope scope("UnitCommand", "action");
+	target->UnitCommand(units, ability, unit_target, queued_command);
+}
+
+const std::vector<Tag>& TracedActions::Commands() const {
+	return target->Commands();
+}
+
+void TracedActions::ToggleAutocast(Tag unit_tag, AbilityID ability) {
+	TraceScope scope("ToggleAutocast", "action");
+	target->ToggleAutocast(unit_tag, ability);
+}
+
+void TracedActions::ToggleAutocast(const std::vector<Tag>& unit_tags,
+	AbilityID ability) {
+	TraceScope scope("ToggleAutocast", "action");
+	target->ToggleAutocast(unit_tags, ability);
+}
+
+void TracedActions::SendChat(const std::string& message,
+	ChatChannel channel) {
+	TraceScope scope("SendChat", "action");
+	target->SendChat(message, channel);
+}
+
+void TracedActions::SendActions() {
+	TraceScope scope("SendActions", "action");
+	target->SendActions();
+}
@@ -0,0 +1,134 @@
+#ifndef TRACING_H_
+#define TRACING_H_
+
+#include "sc2api/sc2_interfaces.h"
+#include "sc2api/sc2_unit.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Streams spans to a Chrome trace event file (chrome://tracing, Perfetto
+// UI or speedscope can open it).
+// Spans come from PROFILE_SCOPE and from the Query/Actions proxies below,
+// each tagged with the game loop it belongs to. The game thread only
+// appends spans to a buffer; BeginFrame() hands the buffer to a writer
+// thread that formats and writes the JSON.
+class TraceWriter {
+public:
+	typedef std::chrono::steady_clock Clock;
+
+	static TraceWriter& Get();
+
+	~TraceWriter();
+
+	// Starts a trace, returns false if the file can't be created
+	bool Open(const std::string& path);
+
+	bool IsOpen() const { return open; }
+
+	// Sends the spans of the finished frame to the writer thread and tags
+	// the following spans with game_loop. Called at the start of a step.
+	void BeginFrame(uint32_t game_loop);
+
+	// Adds a span. Name and category must outlive the trace (literals).
+	void Span(const char* name, const char* category, Clock::time_point begin,
+		Clock::time_point end) {
+		pending.push_back({ name, category, begin, end, game_loop });
+	}
+
+	// Writes the remaining spans, closes the JSON and stops the thread
+	void Close();
+
+private:
+	struct Event {
+		const char* name;
+		const char* category;
+		Clock::time_point begin;
+		Clock::time_point end;
+		uint32_t game_loop;
+	};
+
+	void WriterLoop();
+	void WriteEvents(const std::vector<Event>& events);
+
+	bool open = false;
+	uint32_t game_loop = 0;
+	Clock::time_point epoch;
+
+	// Filled by the game thread
+	std::vector<Event> pending;
+
+	// Handed over to the writer thread
+	std::vector<Event> queued;
+	std::mutex mutex;
+	std::condition_variable queued_changed;
+	bool stopping = false;
+
+	std::thread writer;
+	std::ofstream file;
+	std::string text;
+};
+
+// Times every query sent to the game
+class TracedQuery : public sc2::QueryInterface {
+public:
+	void SetTarget(sc2::QueryInterface* query) { target = query; }
+
+	sc2::AvailableAbilities GetAbilitiesForUnit(const sc2::Unit* unit,
+		bool ignore_resource_requirements = false,
+		bool use_generalized_ability = true) override;
+	std::vector<sc2::AvailableAbilities> GetAbilitiesForUnits(
+		const sc2::Units& units, bool ignore_resource_requirements = false,
+		bool use_generalized_ability = true) override;
+	float PathingDistance(const sc2::Point2D& start,
+		const sc2::Point2D& end) override;
+	float PathingDistance(const sc2::Unit* start,
+		const sc2::Point2D& end) override;
+	std::vector<float> PathingDistance(
+		const std::vector<PathingQuery>& queries) override;
+	bool Placement(const sc2::AbilityID& ability,
+		const sc2::Point2D& target_pos,
+		const sc2::Unit* unit = nullptr) override;
+	std::vector<bool> Placement(
+		const std::vector<PlacementQuery>& queries) override;
+
+private:
+	sc2::QueryInterface* target = nullptr;
+};
+
+// Times every command queued with the game
+class TracedActions : public sc2::ActionInterface {
+public:
+	void SetTarget(sc2::ActionInterface* actions) { target = actions; }
+
+	void UnitCommand(const sc2::Unit* unit, sc2::AbilityID ability,
+		bool queued_command = false) override;
+	void UnitCommand(const sc2::Unit* unit, sc2::AbilityID ability,
+		const sc2::Point2D& point, bool queued_command = false) override;
+	void UnitCommand(const sc2::Unit* unit, sc2::AbilityID ability,
+		const sc2::Unit* target, bool queued_command = false) override;
+	void UnitCommand(const sc2::Units& units, sc2::AbilityID ability,
+		bool queued_move = false) override;
+	void UnitCommand(const sc2::Units& units, sc2::AbilityID ability,
+		const sc2::Point2D& point, bool queued_command = false) override;
+	void UnitCommand(const sc2::Units& units, sc2::AbilityID ability,
+		const sc2::Unit* target, bool queued_command = false) override;
+	const std::vector<sc2::Tag>& Commands() const override;
+	void ToggleAutocast(sc2::Tag unit_tag, sc2::AbilityID ability) override;
+	void ToggleAutocast(const std::vector<sc2::Tag>& unit_tags,
+		sc2::AbilityID ability) override;
+	void SendChat(const std::string& message,
+		sc2::ChatChannel channel = sc2::ChatChannel::All) override;
+	void SendActions() override;
+
+private:
+	sc2::ActionInterface* target = nullptr;
+};
+
+#endif
@@ -0,0 +1,142 @@
+#include "UnitIndex.h"
+
+#include <algorithm>
+
+using namespace sc2;
+
+// Rebuild every bucket from a single scan of the observation
+void UnitIndex::Update(const ObservationInterface* obs) {
+	uint32_t loop = obs->GetGameLoop();
+	if (initialized && loop == game_loop) {
+		return;
+	}
+	initialized = true;
+	game_loop = loop;
+	++rebuilds;
+
+	// Keep the allocated capacity between frames
+	for (auto& b : buckets) {
+		b.all.clear();
+		b.townhalls.clear();
+		b.under_construction.clear();
+		b.idle.clear();
+		b.flying.clear();
+		for (auto& t : b.by_type) {
+			t.second.clear();
+		}
+	}
+	observation_order.clear();
+
+	Units units = obs->GetUnits();
+	uint32_t order = 0;
+	for (const auto& unit : units) {
+		int alliance = static_cast<int>(unit->alliance);
+		if (alliance <= 0 || alliance >= num_alliances) {
+			continue;
+		}
+		Buckets& b = buckets[alliance];
+		b.all.emplace_back(unit);
+		b.by_type[unit->unit_type.ToType()].emplace_back(unit);
+		if (IsTownHall()(*unit)) {
+			b.townhalls.emplace_back(unit);
+		}
+		if (unit->build_progress < 1.0f) {
+			b.under_construction.emplace_back(unit);
+		}
+		if (unit->orders.empty()) {
+			b.idle.emplace_back(unit);
+		}
+		if (unit->is_flying) {
+			b.flying.emplace_back(unit);
+		}
+		observation_order[unit] = order++;
+	}
+}
+
+const UnitIndex::Buckets&
+UnitIndex::GetBuckets(Unit::Alliance alliance) const {
+	static const Buckets empty;
+	int a = static_cast<int>(alliance);
+	if (a <= 0 || a >= num_alliances) {
+		return empty;
+	}
+	return buckets[a];
+}
+
+const Units& UnitIndex::GetUnits(Unit::Alliance alliance) const {
+	++scans_avoided;
+	return GetBuckets(alliance).all;
+}
+
+const Units& UnitIndex::GetUnits(Unit::Alliance alliance,
+	UNIT_TYPEID unit_type) const {
+	static const Units empty;
+	++scans_avoided;
+	const auto& by_type = GetBuckets(alliance).by_type;
+	auto it = by_type.find(unit_type);
+	return it != by_type.end() ? it->second : empty;
+}
+
+Units UnitIndex::GetUnits(Unit::Alliance alliance,
+	std::initializer_list<UNIT_TYPEID> unit_types) const {
+	++scans_avoided;
+	const auto& by_type = GetBuckets(alliance).by_type;
+	Units result;
+	for (const auto& type : unit_types) {
+		auto it = by_type.find(type);
+		if (it != by_type.end()) {
+			result.insert(result.end(), it->second.begin(), it->second.end());
+		}
+	}
+
+	// Restore the observation order when several buckets were merged
+	if (unit_types.size() > 1) {
+		std::sort(result.begin(), result.end(),
+			[this](const Unit* a, const Unit* b) {
+				return observation_order.at(a) < observation_order.at(b);
+			});
+	}
+	return result;
+}
+
+Units UnitIndex::GetUnits(Unit::Alliance alliance, UNIT_TYPEID unit_type,
+	const Filter& filter) const {
+	Units result;
+	for (const auto& unit : GetUnits(alliance, unit_type)) {
+		if (filter(*unit)) {
+			result.emplace_back(unit);
+		}
+	}
+	return result;
+}
+
+Units UnitIndex::GetUnits(Unit::Alliance alliance,
+	const Filter& filter) const {
+	Units result;
+	for (const auto& unit : GetUnits(alliance)) {
+		if (filter(*unit)) {
+			result.emplace_back(unit);
+		}
+	}
+	return result;
+}
+
+const Units& UnitIndex::GetTownHalls(Unit::Alliance alliance) const {
+	++scans_avoided;
+	return GetBuckets(alliance).townhalls;
+}
+
+const Units& UnitIndex::GetUnderConstruction(Unit::Alliance alliance) const {
+	++scans_avoided;
+	return GetBuckets(alliance).under_construction;
+}
+
+const Units& UnitIndex::GetIdle(Unit::Alliance alliance) const {
+	++scans_avoided;
+	return GetBuckets(alliance).idle;
+}
+
+const Units& UnitIndex::GetFlying(Unit::Alliance alliance) const {
+	++scans_avoided;
+	return GetBuckets(alliance).flying;
+}
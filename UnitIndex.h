@@ -0,0 +1,89 @@
+#ifndef UNIT_INDEX_H_
+#define UNIT_INDEX_H_
+
+#include "sc2api/sc2_interfaces.h"
+#include "sc2api/sc2_unit.h"
+#include "sc2api/sc2_unit_filters.h"
+
+#include <cstdint>
+#include <initializer_list>
+#include <unordered_map>
+
+// Per-frame snapshot of every observed unit.
+// Built with a single GetUnits() scan and bucketed by alliance and type so
+// subsystems can look units up without re-scanning the whole observation.
+// Every bucket keeps the order of the observation, so front() returns the
+// same unit a filtered GetUnits() call would.
+class UnitIndex {
+public:
+	// Rebuilds the buckets if the game loop has advanced since the last update
+	void Update(const sc2::ObservationInterface* obs);
+
+	// All units of the given alliance
+	const sc2::Units& GetUnits(sc2::Unit::Alliance alliance) const;
+
+	// All units of the given alliance and type
+	const sc2::Units& GetUnits(sc2::Unit::Alliance alliance,
+		sc2::UNIT_TYPEID unit_type) const;
+
+	// Units of the given alliance matching any of the types
+	sc2::Units GetUnits(sc2::Unit::Alliance alliance,
+		std::initializer_list<sc2::UNIT_TYPEID> unit_types) const;
+
+	// Units of the given alliance and type that pass the filter
+	sc2::Units GetUnits(sc2::Unit::Alliance alliance, sc2::UNIT_TYPEID unit_type,
+		const sc2::Filter& filter) const;
+
+	// Units of the given alliance that pass the filter
+	sc2::Units GetUnits(sc2::Unit::Alliance alliance,
+		const sc2::Filter& filter) const;
+
+	// Town halls (IsTownHall) of the given alliance
+	const sc2::Units& GetTownHalls(sc2::Unit::Alliance alliance) const;
+
+	// Units with build_progress < 1
+	const sc2::Units& GetUnderConstruction(sc2::Unit::Alliance alliance) const;
+
+	// Units without orders
+	const sc2::Units& GetIdle(sc2::Unit::Alliance alliance) const;
+
+	// Flying units (including lifted structures)
+	const sc2::Units& GetFlying(sc2::Unit::Alliance alliance) const;
+
+	// Number of GetUnits() scans answered from the buckets
+	uint64_t ScansAvoided() const { return scans_avoided; }
+
+	// Number of frames the index has been rebuilt
+	uint64_t Rebuilds() const { return rebuilds; }
+
+	// Game loop of the current snapshot
+	uint32_t GameLoop() const { return game_loop; }
+
+private:
+	struct Buckets {
+		sc2::Units all;
+		sc2::Units townhalls;
+		sc2::Units under_construction;
+		sc2::Units idle;
+		sc2::Units flying;
+		std::unordered_map<sc2::UNIT_TYPEID, sc2::Units> by_type;
+	};
+
+	// Alliance values are 1..4 (Self, Ally, Neutral, Enemy)
+	static constexpr int num_alliances = 5;
+
+	const Buckets& GetBuckets(sc2::Unit::Alliance alliance) const;
+
+	Buckets buckets[num_alliances];
+
+	// Position of each unit in the observation, used to merge buckets
+	std::unordered_map<const sc2::Unit*, uint32_t> observation_order;
+
+	uint32_t game_loop = 0;
+	bool initialized = false;
+
+	mutable uint64_t scans_avoided = 0;
+	uint64_t rebuilds = 0;
+};
+
+#endif
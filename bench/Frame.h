@@ -0,0 +1,46 @@
+#ifndef BENCH_FRAME_H_
+#define BENCH_FRAME_H_
+
+#include "sc2api/sc2_interfaces.h"
+#include "sc2api/sc2_unit.h"
+
+#include <cstdint>
+#include <vector>
+
+// One observation of the game, as the bot would see it on a single step
+struct Frame {
+	uint32_t game_loop = 0;
+	int32_t minerals = 0;
+	int32_t vespene = 0;
+	int32_t food_cap = 0;
+	int32_t food_used = 0;
+
+	// Every unit visible this frame, including snapshots
+	std::vector<sc2::Unit> units;
+
+	// Units that died since the previous frame
+	std::vector<sc2::Tag> dead_units;
+
+	// Upgrades researched so far
+	std::vector<sc2::UpgradeID> upgrades;
+};
+
+// Produces the frames the replay bench feeds to the bot
+class FrameSource {
+public:
+	virtual ~FrameSource() = default;
+
+	// Static map information, valid for the whole game
+	virtual const sc2::GameInfo& GetGameInfo() const = 0;
+
+	// Unit type table returned by GetUnitTypeData()
+	virtual const sc2::UnitTypes& GetUnitTypeData() const = 0;
+
+	// Our own start location
+	virtual sc2::Point3D GetStartLocation() const = 0;
+
+	// Fills the next frame, returns false once the game is over
+	virtual bool NextFrame(Frame& frame) = 0;
+};
+
+#endif
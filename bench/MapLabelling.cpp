@@ -0,0 +1,234 @@
+#include "MapLabelling.h"
+
+#include "BitGrid.h"
+#include "GridComponents.h"
+#include "MockInterfaces.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <vector>
+
+using namespace sc2;
+
+namespace {
+
+typedef std::vector<std::vector<Point2D>> Groups;
+
+const uint8_t kRampCell = 1;
+const uint8_t kBuildCell = 2;
+
+double ElapsedMilliseconds(std::chrono::steady_clock::time_point since) {
+	return std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - since).count();
+}
+
+// The flood fill find_groups used before GridComponents, minus the unused
+// picture. The build map was filled with half cell steps, so only direct
+// neighbours ended up in the same region.
+void LegacyFindGroups(std::vector<Point2D>& points,
+	int minimum_points_per_group, int max_distance_between_points,
+	Groups& groups) {
+	const float step = minimum_points_per_group == -1 ? 0.5f : 1.0f;
+
+	std::vector<Point2DI> nearby;
+	for (int dx = -max_distance_between_points;
+		dx <= max_distance_between_points; ++dx) {
+		for (int dy = -max_distance_between_points;
+			dy <= max_distance_between_points; ++dy) {
+			if (abs(dx) + abs(dy) <= max_distance_between_points) {
+				nearby.emplace_back(Point2DI(dx, dy));
+			}
+		}
+	}
+
+	std::vector<Point2D> remaining(points.begin(), points.end());
+	std::deque<Point2D> queue;
+	while (!remaining.empty()) {
+		std::vector<Point2D> currentGroup;
+		if (queue.empty()) {
+			auto start = remaining.back();
+			remaining.pop_back();
+			queue.emplace_back(start);
+			currentGroup.emplace_back(start);
+		}
+		while (!queue.empty()) {
+			Point2D base = queue.front();
+			queue.pop_front();
+			for (const auto& offset : nearby) {
+				Point2D point(base.x + offset.x * step,
+					base.y + offset.y * step);
+				auto it = std::find(remaining.begin(), remaining.end(), point);
+				if (it != remaining.end()) {
+					remaining.erase(it);
+					queue.emplace_back(point);
+					currentGroup.emplace_back(point);
+				}
+			}
+		}
+		if (minimum_points_per_group != -1
+			? currentGroup.size() >=
+				static_cast<size_t>(minimum_points_per_group)
+			: currentGroup.size() != 1) {
+			groups.push_back(currentGroup);
+		}
+	}
+}
+
+void LegacyLabel(const GameInfo& game_info, Groups& ramps, Groups& regions) {
+	for (int pass = 0; pass < 2; ++pass) {
+		bool is_ramp = pass == 0;
+		std::vector<Point2D> points;
+		for (int j = static_cast<int>(game_info.playable_min.y);
+			j < static_cast<int>(game_info.playable_max.y); ++j) {
+			for (int i = static_cast<int>(game_info.playable_min.x);
+				i < static_cast<int>(game_info.playable_max.x); ++i) {
+				bool placeable = SampleGridBit(game_info.placement_grid, i, j);
+				if (SampleGridBit(game_info.pathing_grid, i, j) &&
+					placeable != is_ramp) {
+					points.emplace_back(static_cast<float>(i),
+						static_cast<float>(j));
+				}
+			}
+		}
+		LegacyFindGroups(points, is_ramp ? 8 : -1, 2,
+			is_ramp ? ramps : regions);
+	}
+}
+
+// Cell classes read one cell at a time, the way the bot did before BitGrid
+std::vector<uint8_t> ClassifyPerCell(const GameInfo& game_info) {
+	std::vector<uint8_t> cells(
+		static_cast<size_t>(game_info.width) * game_info.height, 0);
+	for (int j = static_cast<int>(game_info.playable_min.y);
+		j < static_cast<int>(game_info.playable_max.y); ++j) {
+		for (int i = static_cast<int>(game_info.playable_min.x);
+			i < static_cast<int>(game_info.playable_max.x); ++i) {
+			if (SampleGridBit(game_info.pathing_grid, i, j)) {
+				cells[i + j * game_info.width] =
+					SampleGridBit(game_info.placement_grid, i, j) ? kBuildCell
+					: kRampCell;
+			}
+		}
+	}
+	return cells;
+}
+
+// Cell classes from whole words of the packed grids, as the bot does now
+std::vector<uint8_t> ClassifyPacked(const GameInfo& game_info) {
+	BitGrid pathable;
+	pathable.Decode(game_info.pathing_grid);
+	pathable.Crop(static_cast<int>(game_info.playable_min.x),
+		static_cast<int>(game_info.playable_min.y),
+		static_cast<int>(game_info.playable_max.x),
+		static_cast<int>(game_info.playable_max.y));
+	BitGrid placeable;
+	placeable.Decode(game_info.placement_grid);
+	BitGrid ramp_cells = pathable;
+	ramp_cells.AndNot(placeable);
+	BitGrid build_cells = pathable;
+	build_cells &= placeable;
+
+	const int width = pathable.Width();
+	std::vector<uint8_t> cells(
+		static_cast<size_t>(width) * pathable.Height(), 0);
+	ramp_cells.ForEach([&](int x, int y) { cells[x + y * width] = kRampCell; });
+	build_cells.ForEach([&](int x, int y) { cells[x + y * width] = kBuildCell; });
+	return cells;
+}
+
+void Label(const GameInfo& game_info, GridComponents& components,
+	Groups& ramps, Groups& regions) {
+	std::vector<uint8_t> cells = ClassifyPacked(game_info);
+	components.Label(cells, game_info.width, game_info.height, { 0, 2, 1 });
+	for (size_t g = 0; g < components.Count(); ++g) {
+		const std::vector<Point2D>& cells_of_group = components.Cells(g);
+		if (components.Class(g) == kRampCell) {
+			if (cells_of_group.size() >= 8) {
+				ramps.push_back(cells_of_group);
+			}
+		}
+		else if (cells_of_group.size() != 1) {
+			regions.push_back(cells_of_group);
+		}
+	}
+}
+
+// Sorts the cells of each group and the groups, so the two can be compared
+void Normalize(Groups& groups) {
+	auto less = [](const Point2D& a, const Point2D& b) {
+		return a.y < b.y || (a.y == b.y && a.x < b.x);
+		};
+	for (auto& group : groups) {
+		std::sort(group.begin(), group.end(), less);
+	}
+	std::sort(groups.begin(), groups.end(),
+		[&less](const std::vector<Point2D>& a, const std::vector<Point2D>& b) {
+			return less(a.front(), b.front());
+		});
+}
+
+bool SameGroups(Groups a, Groups b) {
+	Normalize(a);
+	Normalize(b);
+	if (a.size() != b.size()) {
+		return false;
+	}
+	for (size_t i = 0; i < a.size(); ++i) {
+		if (a[i].size() != b[i].size() ||
+			!std::equal(a[i].begin(), a[i].end(), b[i].begin())) {
+			return false;
+		}
+	}
+	return true;
+}
+
+} // namespace
+
+bool CompareMapLabelling(const GameInfo& game_info, int runs,
+	std::ostream& out) {
+	Groups legacy_ramps, legacy_regions;
+	auto start = std::chrono::steady_clock::now();
+	for (int run = 0; run < runs; ++run) {
+		legacy_ramps.clear();
+		legacy_regions.clear();
+		LegacyLabel(game_info, legacy_ramps, legacy_regions);
+	}
+	double legacy_ms = ElapsedMilliseconds(start) / runs;
+
+	GridComponents components;
+	Groups ramps, regions;
+	start = std::chrono::steady_clock::now();
+	for (int run = 0; run < runs; ++run) {
+		ramps.clear();
+		regions.clear();
+		Label(game_info, components, ramps, regions);
+	}
+	double labelling_ms = ElapsedMilliseconds(start) / runs;
+
+	std::vector<uint8_t> per_cell, packed;
+	start = std::chrono::steady_clock::now();
+	for (int run = 0; run < runs; ++run) {
+		per_cell = ClassifyPerCell(game_info);
+	}
+	double per_cell_ms = ElapsedMilliseconds(start) / runs;
+	start = std::chrono::steady_clock::now();
+	for (int run = 0; run < runs; ++run) {
+		packed = ClassifyPacked(game_info);
+	}
+	double packed_ms = ElapsedMilliseconds(start) / runs;
+
+	bool same = SameGroups(legacy_ramps, ramps) &&
+		SameGroups(legacy_regions, regions) && per_cell == packed;
+	out << "Map:               " << game_info.map_name << " ("
+		<< game_info.width << "x" << game_info.height << ")" << std::endl;
+	out << "Groups:            " << ramps.size() << " ramps, "
+		<< regions.size() << " build regions" << std::endl;
+	out << "Flood fill:        " << legacy_ms << " ms" << std::endl;
+	out << "Union-find:        " << labelling_ms << " ms" << std::endl;
+	out << "Cell classes:      " << per_cell_ms << " ms per-cell decode, "
+		<< packed_ms << " ms packed" << std::endl;
+	out << "Same groups:       " << (same ? "yes" : "NO") << std::endl;
+	return same;
+}
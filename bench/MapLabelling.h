@@ -0,0 +1,14 @@
+#ifndef BENCH_MAP_LABELLING_H_
+#define BENCH_MAP_LABELLING_H_
+
+#include "sc2api/sc2_gametypes.h"
+
+#include <ostream>
+
+// Times the ramp and build region labelling of the bot against the flood
+// fill it replaced, on the grids of the given map, and checks both find
+// the same groups. Returns false if they differ.
+bool CompareMapLabelling(const sc2::GameInfo& game_info, int runs,
+	std::ostream& out);
+
+#endif
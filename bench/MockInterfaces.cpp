@@ -0,0 +1,637 @@
+#include "MockInterfaces.h"
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_set>
+
+using namespace sc2;
+
+bool SampleGridBit(const ImageData& grid, int x, int y) {
+	if (x < 0 || y < 0 || x >= grid.width || y >= grid.height) {
+		return false;
+	}
+	// Grids are stored with an upper left origin
+	int index = x + (grid.height - 1 - y) * grid.width;
+	if (grid.bits_per_pixel == 1) {
+		uint8_t byte = static_cast<uint8_t>(grid.data[index / 8]);
+		return (byte >> (7 - index % 8)) & 1;
+	}
+	return static_cast<uint8_t>(grid.data[index]) != 0;
+}
+
+uint8_t SampleGridByte(const ImageData& grid, int x, int y) {
+	if (x < 0 || y < 0 || x >= grid.width || y >= grid.height) {
+		return 0;
+	}
+	int index = x + (grid.height - 1 - y) * grid.width;
+	return static_cast<uint8_t>(grid.data[index]);
+}
+
+// ------------------ MockObservation ------------------
+
+MockObservation::MockObservation(const FrameSource& source) : source(source) {
+}
+
+void MockObservation::SetFrame(const Frame& next, FrameEvents& events) {
+	events = FrameEvents();
+
+	// Units that died since the last frame
+	for (const auto& tag : next.dead_units) {
+		auto it = unit_pool.find(tag);
+		if (it != unit_pool.end() && it->second->is_alive) {
+			it->second->is_alive = false;
+			events.destroyed.emplace_back(it->second.get());
+		}
+	}
+
+	// Update the pooled units in place so pointers held by the bot stay valid
+	units.clear();
+	for (const auto& observed : next.units) {
+		std::unique_ptr<Unit>& slot = unit_pool[observed.tag];
+		const bool is_new = !slot;
+		bool had_orders = false;
+		float last_progress = 1.0f;
+		if (is_new) {
+			slot.reset(new Unit(observed));
+		}
+		else {
+			had_orders = !slot->orders.empty();
+			last_progress = slot->build_progress;
+			*slot = observed;
+		}
+		Unit* unit = slot.get();
+		unit->is_alive = true;
+		unit->last_seen_game_loop = next.game_loop;
+		units.emplace_back(unit);
+
+		if (unit->alliance == Unit::Alliance::Enemy && is_new) {
+			events.entered_vision.emplace_back(unit);
+		}
+		if (unit->alliance != Unit::Alliance::Self) {
+			continue;
+		}
+		if (is_new && !first_frame) {
+			events.created.emplace_back(unit);
+		}
+		if (!is_new && last_progress < 1.0f && unit->build_progress >= 1.0f) {
+			events.construction_complete.emplace_back(unit);
+		}
+		if (unit->orders.empty() && unit->build_progress >= 1.0f &&
+			(is_new || had_orders)) {
+			events.idle.emplace_back(unit);
+		}
+	}
+
+	// Upgrades that were not present in the previous frame
+	for (const auto& upgrade : next.upgrades) {
+		if (std::find(frame.upgrades.begin(), frame.upgrades.end(), upgrade) ==
+			frame.upgrades.end()) {
+			events.upgrades_completed.emplace_back(upgrade);
+		}
+	}
+
+	frame.game_loop = next.game_loop;
+	frame.minerals = next.minerals;
+	frame.vespene = next.vespene;
+	frame.food_cap = next.food_cap;
+	frame.food_used = next.food_used;
+	frame.upgrades = next.upgrades;
+	first_frame = false;
+}
+
+uint32_t MockObservation::GetPlayerID() const {
+	++calls;
+	return 1;
+}
+
+uint32_t MockObservation::GetGameLoop() const {
+	++calls;
+	return frame.game_loop;
+}
+
+Units MockObservation::GetUnits() const {
+	++calls;
+	return units;
+}
+
+Units MockObservation::GetUnits(Unit::Alliance alliance, Filter filter) const {
+	++calls;
+	Units result;
+	for (const auto& unit : units) {
+		if (unit->alliance == alliance && (!filter || filter(*unit))) {
+			result.emplace_back(unit);
+		}
+	}
+	return result;
+}
+
+Units MockObservation::GetUnits(Filter filter) const {
+	++calls;
+	Units result;
+	for (const auto& unit : units) {
+		if (!filter || filter(*unit)) {
+			result.emplace_back(unit);
+		}
+	}
+	return result;
+}
+
+const Unit* MockObservation::GetUnit(Tag tag) const {
+	++calls;
+	auto it = unit_pool.find(tag);
+	return it != unit_pool.end() ? it->second.get() : nullptr;
+}
+
+const RawActions& MockObservation::GetRawActions() const {
+	static const RawActions empty;
+	return empty;
+}
+
+const SpatialActions& MockObservation::GetFeatureLayerActions() const {
+	static const SpatialActions empty;
+	return empty;
+}
+
+const SpatialActions& MockObservation::GetRenderedActions() const {
+	static const SpatialActions empty;
+	return empty;
+}
+
+const std::vector<ChatMessage>& MockObservation::GetChatMessages() const {
+	static const std::vector<ChatMessage> empty;
+	return empty;
+}
+
+const std::vector<PowerSource>& MockObservation::GetPowerSources() const {
+	static const std::vector<PowerSource> empty;
+	return empty;
+}
+
+const std::vector<Effect>& MockObservation::GetEffects() const {
+	static const std::vector<Effect> empty;
+	return empty;
+}
+
+const std::vector<UpgradeID>& MockObservation::GetUpgrades() const {
+	++calls;
+	return frame.upgrades;
+}
+
+const Score& MockObservation::GetScore() const {
+	static const Score empty;
+	return empty;
+}
+
+const Abilities& MockObservation::GetAbilityData(bool) const {
+	static const Abilities empty;
+	return empty;
+}
+
+const UnitTypes& MockObservation::GetUnitTypeData(bool) const {
+	++calls;
+	return source.GetUnitTypeData();
+}
+
+const Upgrades& MockObservation::GetUpgradeData(bool) const {
+	static const Upgrades empty;
+	return empty;
+}
+
+const Buffs& MockObservation::GetBuffData(bool) const {
+	static const Buffs empty;
+	return empty;
+}
+
+const Effects& MockObservation::GetEffectData(bool) const {
+	static const Effects empty;
+	return empty;
+}
+
+const GameInfo& MockObservation::GetGameInfo() const {
+	++calls;
+	return source.GetGameInfo();
+}
+
+int32_t MockObservation::GetMinerals() const {
+	++calls;
+	return frame.minerals;
+}
+
+int32_t MockObservation::GetVespene() const {
+	++calls;
+	return frame.vespene;
+}
+
+int32_t MockObservation::GetFoodCap() const {
+	++calls;
+	return frame.food_cap;
+}
+
+int32_t MockObservation::GetFoodUsed() const {
+	++calls;
+	return frame.food_used;
+}
+
+int32_t MockObservation::GetFoodArmy() const {
+	return 0;
+}
+
+int32_t MockObservation::GetFoodWorkers() const {
+	return 0;
+}
+
+int32_t MockObservation::GetIdleWorkerCount() const {
+	return 0;
+}
+
+int32_t MockObservation::GetArmyCount() const {
+	return 0;
+}
+
+int32_t MockObservation::GetWarpGateCount() const {
+	return 0;
+}
+
+int32_t MockObservation::GetLarvaCount() const {
+	return 0;
+}
+
+Point2D MockObservation::GetCameraPos() const {
+	return Point2D();
+}
+
+Point3D MockObservation::GetStartLocation() const {
+	++calls;
+	return source.GetStartLocation();
+}
+
+const std::vector<PlayerResult>& MockObservation::GetResults() const {
+	return results;
+}
+
+bool MockObservation::HasCreep(const Point2D&) const {
+	return false;
+}
+
+Visibility MockObservation::GetVisibility(const Point2D&) const {
+	return Visibility::Visible;
+}
+
+bool MockObservation::IsPathable(const Point2D& point) const {
+	++calls;
+	return SampleGridBit(source.GetGameInfo().pathing_grid,
+		static_cast<int>(point.x), static_cast<int>(point.y));
+}
+
+bool MockObservation::IsPlacable(const Point2D& point) const {
+	++calls;
+	return SampleGridBit(source.GetGameInfo().placement_grid,
+		static_cast<int>(point.x), static_cast<int>(point.y));
+}
+
+float MockObservation::TerrainHeight(const Point2D& point) const {
+	++calls;
+	uint8_t value = SampleGridByte(source.GetGameInfo().terrain_height,
+		static_cast<int>(point.x), static_cast<int>(point.y));
+	return -100.0f + 200.0f * value / 255.0f;
+}
+
+const SC2APIProtocol::Observation* MockObservation::GetRawObservation() const {
+	return nullptr;
+}
+
+// ------------------ MockActions ------------------
+
+void MockActions::Record(const Units& units, AbilityID ability,
+	ActionRaw::TargetType target_type, Tag target_tag,
+	const Point2D& target_point) {
+	ActionRaw action;
+	action.ability_id = ability;
+	action.target_type = target_type;
+	action.target_tag = target_tag;
+	action.target_point = target_point;
+	for (const auto& unit : units) {
+		if (unit) {
+			action.unit_tags.emplace_back(unit->tag);
+			commanded_tags.emplace_back(unit->tag);
+		}
+	}
+	commanded_units += action.unit_tags.size();
+	++commands;
+	pending.emplace_back(action);
+}
+
+void MockActions::UnitCommand(const Unit* unit, AbilityID ability, bool) {
+	Record({ unit }, ability, ActionRaw::TargetNone, NullTag, Point2D());
+}
+
+void MockActions::UnitCommand(const Unit* unit, AbilityID ability,
+	const Point2D& point, bool) {
+	Record({ unit }, ability, ActionRaw::TargetPosition, NullTag, point);
+}
+
+void MockActions::UnitCommand(const Unit* unit, AbilityID ability,
+	const Unit* target, bool) {
+	Record({ unit }, ability, ActionRaw::TargetUnitTag,
+		target ? target->tag : NullTag, Point2D());
+}
+
+void MockActions::UnitCommand(const Units& units, AbilityID ability, bool) {
+	Record(units, ability, ActionRaw::TargetNone, NullTag, Point2D());
+}
+
+void MockActions::UnitCommand(const Units& units, AbilityID ability,
+	const Point2D& point, bool) {
+	Record(units, ability, ActionRaw::TargetPosition, NullTag, point);
+}
+
+void MockActions::UnitCommand(const Units& units, AbilityID ability,
+	const Unit* target, bool) {
+	Record(units, ability, ActionRaw::TargetUnitTag,
+		target ? target->tag : NullTag, Point2D());
+}
+
+const std::vector<Tag>& MockActions::Commands() const {
+	return commanded_tags;
+}
+
+void MockActions::ToggleAutocast(Tag, AbilityID) {
+	++commands;
+}
+
+void MockActions::ToggleAutocast(const std::vector<Tag>&, AbilityID) {
+	++commands;
+}
+
+void MockActions::SendChat(const std::string&, ChatChannel) {
+}
+
+void MockActions::SendActions() {
+	pending.clear();
+	commanded_tags.clear();
+}
+
+// ------------------ MockQuery ------------------
+
+MockQuery::MockQuery(const MockObservation& observation)
+	: observation(observation) {
+}
+
+AvailableAbilities MockQuery::GetAbilitiesForUnit(const Unit* unit, bool,
+	bool) {
+	++requests;
+	return Abilities(unit);
+}
+
+std::vector<AvailableAbilities> MockQuery::GetAbilitiesForUnits(
+	const Units& units, bool, bool) {
+	++requests;
+	std::vector<AvailableAbilities> result;
+	for (const auto& unit : units) {
+		result.emplace_back(Abilities(unit));
+	}
+	return result;
+}
+
+float MockQuery::PathingDistance(const Point2D& start, const Point2D& end) {
+	++requests;
+	return Distance(start, end);
+}
+
+float MockQuery::PathingDistance(const Unit* start, const Point2D& end) {
+	++requests;
+	if (!start) {
+		++queries;
+		return 0.0f;
+	}
+	return Distance(Point2D(start->pos.x, start->pos.y), end);
+}
+
+std::vector<float> MockQuery::PathingDistance(
+	const std::vector<PathingQuery>& queries) {
+	++requests;
+	std::vector<float> result;
+	for (const auto& query : queries) {
+		const Unit* start = query.start_unit_tag_
+			? observation.GetUnit(query.start_unit_tag_)
+			: nullptr;
+		result.emplace_back(start
+			? Distance(Point2D(start->pos.x, start->pos.y), query.end_)
+			: Distance(query.start_, query.end_));
+	}
+	return result;
+}
+
+bool MockQuery::Placement(const AbilityID& ability, const Point2D& target_pos,
+	const Unit* unit) {
+	++requests;
+	++queries;
+	return CanPlace(ability, target_pos, unit);
+}
+
+std::vector<bool> MockQuery::Placement(
+	const std::vector<PlacementQuery>& queries) {
+	++requests;
+	std::vector<bool> result;
+	for (const auto& query : queries) {
+		const Unit* builder = query.placing_unit_tag
+			? observation.GetUnit(query.placing_unit_tag)
+			: nullptr;
+		++this->queries;
+		result.emplace_back(CanPlace(query.ability, query.target_pos, builder));
+	}
+	return result;
+}
+
+AvailableAbilities MockQuery::Abilities(const Unit* unit) {
+	++queries;
+	AvailableAbilities abilities;
+	if (unit) {
+		abilities.unit_tag = unit->tag;
+		abilities.unit_type_id = unit->unit_type;
+	}
+	return abilities;
+}
+
+// Straight-line distance, or 0 when either end is unreachable like the game
+float MockQuery::Distance(const Point2D& start, const Point2D& end) {
+	++queries;
+	if (!observation.IsPathable(start) || !observation.IsPathable(end)) {
+		return 0.0f;
+	}
+	return Distance2D(start, end);
+}
+
+bool MockQuery::CanPlace(AbilityID ability, const Point2D& pos,
+	const Unit* builder) const {
+	// Refineries go on top of a free geyser
+	if (ability == ABILITY_ID::BUILD_REFINERY) {
+		for (const auto& unit : observation.GetUnits()) {
+			if (unit->vespene_contents > 0 &&
+				unit->alliance == Unit::Alliance::Neutral &&
+				Distance2D(Point2D(unit->pos.x, unit->pos.y), pos) < 0.5f) {
+				return observation.GetUnits(Unit::Alliance::Self,
+					[pos](const Unit& u) {
+						return u.unit_type == UNIT_TYPEID::TERRAN_REFINERY &&
+							Distance2D(Point2D(u.pos.x, u.pos.y), pos) < 0.5f;
+					}).empty();
+			}
+		}
+		return false;
+	}
+
+	float size = 3.0f;
+	if (ability == ABILITY_ID::BUILD_SUPPLYDEPOT ||
+		ability == ABILITY_ID::BUILD_MISSILETURRET) {
+		size = 2.0f;
+	}
+	else if (ability == ABILITY_ID::BUILD_COMMANDCENTER) {
+		size = 5.0f;
+	}
+
+	// Every cell of the footprint must be placeable terrain
+	const float min_x = pos.x - size / 2.0f;
+	const float min_y = pos.y - size / 2.0f;
+	const int x0 = static_cast<int>(std::floor(min_x + 0.5f));
+	const int y0 = static_cast<int>(std::floor(min_y + 0.5f));
+	const GameInfo& game_info = observation.GetGameInfo();
+	for (int x = x0; x < x0 + static_cast<int>(size); ++x) {
+		for (int y = y0; y < y0 + static_cast<int>(size); ++y) {
+			if (!SampleGridBit(game_info.placement_grid, x, y)) {
+				return false;
+			}
+		}
+	}
+
+	// No ground unit of a relevant size may overlap the footprint
+	for (const auto& unit : observation.GetUnits()) {
+		if (unit == builder || unit->is_flying || unit->radius < 0.5f) {
+			continue;
+		}
+		if (std::abs(unit->pos.x - pos.x) < unit->radius + size / 2.0f &&
+			std::abs(unit->pos.y - pos.y) < unit->radius + size / 2.0f) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// ------------------ MockDebug ------------------
+
+void MockDebug::DebugTextOut(const std::string&, Color) {
+	++calls;
+}
+
+void MockDebug::DebugTextOut(const std::string&, const Point2D&, Color,
+	uint32_t) {
+	++calls;
+}
+
+void MockDebug::DebugTextOut(const std::string&, const Point3D&, Color,
+	uint32_t) {
+	++calls;
+}
+
+void MockDebug::DebugLineOut(const Point3D&, const Point3D&, Color) {
+	++calls;
+}
+
+void MockDebug::DebugBoxOut(const Point3D&, const Point3D&, Color) {
+	++calls;
+}
+
+void MockDebug::DebugSphereOut(const Point3D&, float, Color) {
+	++calls;
+}
+
+void MockDebug::DebugCreateUnit(UnitTypeID, const Point2D&, uint32_t,
+	uint32_t) {
+	++calls;
+}
+
+void MockDebug::DebugKillUnit(const Unit*) {
+	++calls;
+}
+
+void MockDebug::DebugShowMap() {
+	++calls;
+}
+
+void MockDebug::DebugEnemyControl() {
+	++calls;
+}
+
+void MockDebug::DebugIgnoreFood() {
+	++calls;
+}
+
+void MockDebug::DebugIgnoreResourceCost() {
+	++calls;
+}
+
+void MockDebug::DebugGiveAllResources() {
+	++calls;
+}
+
+void MockDebug::DebugGodMode() {
+	++calls;
+}
+
+void MockDebug::DebugIgnoreMineral() {
+	++calls;
+}
+
+void MockDebug::DebugNoCooldowns() {
+	++calls;
+}
+
+void MockDebug::DebugGiveAllTech() {
+	++calls;
+}
+
+void MockDebug::DebugGiveAllUpgrades() {
+	++calls;
+}
+
+void MockDebug::DebugFastBuild() {
+	++calls;
+}
+
+void MockDebug::DebugSetScore(float) {
+	++calls;
+}
+
+void MockDebug::DebugEndGame(bool) {
+	++calls;
+}
+
+void MockDebug::DebugSetEnergy(float, const Unit*) {
+	++calls;
+}
+
+void MockDebug::DebugSetLife(float, const Unit*) {
+	++calls;
+}
+
+void MockDebug::DebugSetShields(float, const Unit*) {
+	++calls;
+}
+
+void MockDebug::DebugMoveCamera(const Point2D&) {
+	++calls;
+}
+
+void MockDebug::DebugTestApp(AppTest, int) {
+	++calls;
+}
+
+void MockDebug::DebugSetMinerals(float) {
+	++calls;
+}
+
+void MockDebug::DebugSetVespene(float) {
+	++calls;
+}
+
+void MockDebug::SendDebug() {
+}
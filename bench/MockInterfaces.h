@@ -0,0 +1,222 @@
+#ifndef BENCH_MOCK_INTERFACES_H_
+#define BENCH_MOCK_INTERFACES_H_
+
+#include "sc2api/sc2_interfaces.h"
+#include "sc2api/sc2_unit.h"
+
+#include "Frame.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Stand-ins for the sc2 game interfaces used by the replay bench.
+
+// Events the game would raise when moving from one frame to the next
+struct FrameEvents {
+	sc2::Units destroyed;
+	sc2::Units created;
+	sc2::Units idle;
+	std::vector<sc2::UpgradeID> upgrades_completed;
+	sc2::Units construction_complete;
+	sc2::Units entered_vision;
+};
+
+class MockObservation : public sc2::ObservationInterface {
+public:
+	explicit MockObservation(const FrameSource& source);
+
+	// Loads a frame and collects the events it raises
+	void SetFrame(const Frame& frame, FrameEvents& events);
+
+	// Number of calls made through the interface
+	uint64_t Calls() const { return calls; }
+
+	uint32_t GetPlayerID() const override;
+	uint32_t GetGameLoop() const override;
+	sc2::Units GetUnits() const override;
+	sc2::Units GetUnits(sc2::Unit::Alliance alliance,
+		sc2::Filter filter = {}) const override;
+	sc2::Units GetUnits(sc2::Filter filter) const override;
+	const sc2::Unit* GetUnit(sc2::Tag tag) const override;
+	const sc2::RawActions& GetRawActions() const override;
+	const sc2::SpatialActions& GetFeatureLayerActions() const override;
+	const sc2::SpatialActions& GetRenderedActions() const override;
+	const std::vector<sc2::ChatMessage>& GetChatMessages() const override;
+	const std::vector<sc2::PowerSource>& GetPowerSources() const override;
+	const std::vector<sc2::Effect>& GetEffects() const override;
+	const std::vector<sc2::UpgradeID>& GetUpgrades() const override;
+	const sc2::Score& GetScore() const override;
+	const sc2::Abilities& GetAbilityData(bool force_refresh = false) const override;
+	const sc2::UnitTypes& GetUnitTypeData(bool force_refresh = false) const override;
+	const sc2::Upgrades& GetUpgradeData(bool force_refresh = false) const override;
+	const sc2::Buffs& GetBuffData(bool force_refresh = false) const override;
+	const sc2::Effects& GetEffectData(bool force_refresh = false) const override;
+	const sc2::GameInfo& GetGameInfo() const override;
+	int32_t GetMinerals() const override;
+	int32_t GetVespene() const override;
+	int32_t GetFoodCap() const override;
+	int32_t GetFoodUsed() const override;
+	int32_t GetFoodArmy() const override;
+	int32_t GetFoodWorkers() const override;
+	int32_t GetIdleWorkerCount() const override;
+	int32_t GetArmyCount() const override;
+	int32_t GetWarpGateCount() const override;
+	int32_t GetLarvaCount() const override;
+	sc2::Point2D GetCameraPos() const override;
+	sc2::Point3D GetStartLocation() const override;
+	const std::vector<sc2::PlayerResult>& GetResults() const override;
+	bool HasCreep(const sc2::Point2D& point) const override;
+	sc2::Visibility GetVisibility(const sc2::Point2D& point) const override;
+	bool IsPathable(const sc2::Point2D& point) const override;
+	bool IsPlacable(const sc2::Point2D& point) const override;
+	float TerrainHeight(const sc2::Point2D& point) const override;
+	const SC2APIProtocol::Observation* GetRawObservation() const override;
+
+private:
+	const FrameSource& source;
+
+	// Units live here for the whole game so pointers stay valid, like the
+	// unit pool of the real client
+	std::unordered_map<sc2::Tag, std::unique_ptr<sc2::Unit>> unit_pool;
+
+	// Units visible in the current frame, in frame order
+	sc2::Units units;
+
+	Frame frame;
+	std::vector<sc2::PlayerResult> results;
+	bool first_frame = true;
+
+	mutable uint64_t calls = 0;
+};
+
+class MockActions : public sc2::ActionInterface {
+public:
+	// Actions issued since the last SendActions()
+	const sc2::RawActions& Pending() const { return pending; }
+
+	// Totals over the whole run
+	uint64_t TotalCommands() const { return commands; }
+	uint64_t TotalCommandedUnits() const { return commanded_units; }
+
+	void UnitCommand(const sc2::Unit* unit, sc2::AbilityID ability,
+		bool queued_command = false) override;
+	void UnitCommand(const sc2::Unit* unit, sc2::AbilityID ability,
+		const sc2::Point2D& point, bool queued_command = false) override;
+	void UnitCommand(const sc2::Unit* unit, sc2::AbilityID ability,
+		const sc2::Unit* target, bool queued_command = false) override;
+	void UnitCommand(const sc2::Units& units, sc2::AbilityID ability,
+		bool queued_move = false) override;
+	void UnitCommand(const sc2::Units& units, sc2::AbilityID ability,
+		const sc2::Point2D& point, bool queued_command = false) override;
+	void UnitCommand(const sc2::Units& units, sc2::AbilityID ability,
+		const sc2::Unit* target, bool queued_command = false) override;
+	const std::vector<sc2::Tag>& Commands() const override;
+	void ToggleAutocast(sc2::Tag unit_tag, sc2::AbilityID ability) override;
+	void ToggleAutocast(const std::vector<sc2::Tag>& unit_tags,
+		sc2::AbilityID ability) override;
+	void SendChat(const std::string& message,
+		sc2::ChatChannel channel = sc2::ChatChannel::All) override;
+	void SendActions() override;
+
+private:
+	void Record(const sc2::Units& units, sc2::AbilityID ability,
+		sc2::ActionRaw::TargetType target_type, sc2::Tag target_tag,
+		const sc2::Point2D& target_point);
+
+	sc2::RawActions pending;
+	std::vector<sc2::Tag> commanded_tags;
+	uint64_t commands = 0;
+	uint64_t commanded_units = 0;
+};
+
+class MockQuery : public sc2::QueryInterface {
+public:
+	explicit MockQuery(const MockObservation& observation);
+
+	// Number of queries answered, batched queries count each element
+	uint64_t Queries() const { return queries; }
+
+	// Number of round trips, a batched query is one
+	uint64_t Requests() const { return requests; }
+
+	sc2::AvailableAbilities GetAbilitiesForUnit(const sc2::Unit* unit,
+		bool ignore_resource_requirements = false,
+		bool use_generalized_ability = true) override;
+	std::vector<sc2::AvailableAbilities> GetAbilitiesForUnits(
+		const sc2::Units& units, bool ignore_resource_requirements = false,
+		bool use_generalized_ability = true) override;
+	float PathingDistance(const sc2::Point2D& start, const sc2::Point2D& end) override;
+	float PathingDistance(const sc2::Unit* start, const sc2::Point2D& end) override;
+	std::vector<float> PathingDistance(
+		const std::vector<PathingQuery>& queries) override;
+	bool Placement(const sc2::AbilityID& ability,
+		const sc2::Point2D& target_pos, const sc2::Unit* unit = nullptr) override;
+	std::vector<bool> Placement(const std::vector<PlacementQuery>& queries) override;
+
+private:
+	// Placement answered from the placement grid and the current units
+	bool CanPlace(sc2::AbilityID ability, const sc2::Point2D& pos,
+		const sc2::Unit* builder) const;
+	sc2::AvailableAbilities Abilities(const sc2::Unit* unit);
+	float Distance(const sc2::Point2D& start, const sc2::Point2D& end);
+
+	const MockObservation& observation;
+	uint64_t queries = 0;
+	uint64_t requests = 0;
+};
+
+class MockDebug : public sc2::DebugInterface {
+public:
+	// Number of draw and cheat calls
+	uint64_t Calls() const { return calls; }
+
+	void DebugTextOut(const std::string& out,
+		sc2::Color color = sc2::Colors::White) override;
+	void DebugTextOut(const std::string& out,
+		const sc2::Point2D& pt_virtual_2D,
+		sc2::Color color = sc2::Colors::White, uint32_t size = 8) override;
+	void DebugTextOut(const std::string& out, const sc2::Point3D& pt3D,
+		sc2::Color color = sc2::Colors::White, uint32_t size = 8) override;
+	void DebugLineOut(const sc2::Point3D& p0, const sc2::Point3D& p1,
+		sc2::Color color = sc2::Colors::White) override;
+	void DebugBoxOut(const sc2::Point3D& p_min, const sc2::Point3D& p_max,
+		sc2::Color color = sc2::Colors::White) override;
+	void DebugSphereOut(const sc2::Point3D& p, float r,
+		sc2::Color color = sc2::Colors::White) override;
+	void DebugCreateUnit(sc2::UnitTypeID unit_type, const sc2::Point2D& p,
+		uint32_t player_id = 1, uint32_t count = 1) override;
+	void DebugKillUnit(const sc2::Unit* unit) override;
+	void DebugShowMap() override;
+	void DebugEnemyControl() override;
+	void DebugIgnoreFood() override;
+	void DebugIgnoreResourceCost() override;
+	void DebugGiveAllResources() override;
+	void DebugGodMode() override;
+	void DebugIgnoreMineral() override;
+	void DebugNoCooldowns() override;
+	void DebugGiveAllTech() override;
+	void DebugGiveAllUpgrades() override;
+	void DebugFastBuild() override;
+	void DebugSetScore(float score) override;
+	void DebugEndGame(bool victory = false) override;
+	void DebugSetEnergy(float value, const sc2::Unit* unit) override;
+	void DebugSetLife(float value, const sc2::Unit* unit) override;
+	void DebugSetShields(float value, const sc2::Unit* unit) override;
+	void DebugMoveCamera(const sc2::Point2D& pos) override;
+	void DebugTestApp(AppTest app_test, int delay_ms = 0) override;
+	void DebugSetMinerals(float value) override;
+	void DebugSetVespene(float value) override;
+	void SendDebug() override;
+
+private:
+	uint64_t calls = 0;
+};
+
+// Reads one cell of a game info grid (upper left origin, like the game)
+bool SampleGridBit(const sc2::ImageData& grid, int x, int y);
+uint8_t SampleGridByte(const sc2::ImageData& grid, int x, int y);
+
+#endif
@@ -0,0 +1,195 @@
+#include "RecordedFrames.h"
+
+#include <cstring>
+
+using namespace sc2;
+
+RecordedFrameSource::RecordedFrameSource(const std::string& path) {
+	if (!file.Open(path)) {
+		Fail("Could not open " + path);
+		return;
+	}
+	const char* cursor = file.Data();
+	const size_t header_size = sizeof(recording::kMagic) + 2 * sizeof(uint32_t);
+	if (file.Size() < header_size ||
+		std::memcmp(cursor, recording::kMagic, sizeof(recording::kMagic)) != 0) {
+		Fail(path + " is not a recording");
+		return;
+	}
+	uint32_t version;
+	std::memcpy(&version, cursor + sizeof(recording::kMagic), sizeof(version));
+	if (version != recording::kVersion) {
+		Fail(path + " has unsupported version " + std::to_string(version));
+		return;
+	}
+	cursor += header_size;
+	if (!ReadStatic(cursor) || !ReadIndex(cursor)) {
+		return;
+	}
+	valid = true;
+}
+
+bool RecordedFrameSource::Fail(const std::string& message) {
+	error = message;
+	valid = false;
+	return false;
+}
+
+bool RecordedFrameSource::ReadStatic(const char*& cursor) {
+	recording::ByteReader size_reader(cursor, file.Data() + file.Size());
+	uint32_t size = size_reader.Read<uint32_t>();
+	const char* begin = size_reader.Cursor();
+	if (!size_reader.Ok() ||
+		size > static_cast<size_t>(file.Data() + file.Size() - begin)) {
+		return Fail("Truncated game info");
+	}
+	recording::ByteReader in(begin, begin + size);
+	recording::ReadGameInfo(in, game_info);
+	start_location.x = in.Read<float>();
+	start_location.y = in.Read<float>();
+	start_location.z = in.Read<float>();
+	in.Read<uint32_t>(); // player id, always ours
+	recording::ReadUnitTypes(in, unit_types);
+	if (!in.Ok()) {
+		return Fail("Corrupt game info");
+	}
+	cursor = begin + size;
+	return true;
+}
+
+// Uses the index at the end of the file, or rebuilds it from the frame size
+// prefixes when the recording was not closed
+bool RecordedFrameSource::ReadIndex(const char* frames_begin) {
+	const char* end = file.Data() + file.Size();
+	const uint64_t frames_offset = frames_begin - file.Data();
+	if (file.Size() >= frames_offset + sizeof(recording::Footer)) {
+		recording::Footer footer;
+		std::memcpy(&footer, end - sizeof(footer), sizeof(footer));
+		uint64_t index_size =
+			static_cast<uint64_t>(footer.frame_count) *
+			sizeof(recording::IndexEntry);
+		if (footer.magic == recording::kFooterMagic &&
+			footer.index_offset >= frames_offset &&
+			footer.index_offset + index_size + sizeof(footer) == file.Size()) {
+			index.resize(footer.frame_count);
+			if (index_size > 0) {
+				std::memcpy(index.data(), file.Data() + footer.index_offset,
+					static_cast<size_t>(index_size));
+			}
+			return true;
+		}
+	}
+
+	const char* cursor = frames_begin;
+	while (end - cursor > static_cast<ptrdiff_t>(sizeof(uint32_t) * 2 + 1)) {
+		uint32_t size;
+		uint32_t game_loop;
+		std::memcpy(&size, cursor, sizeof(size));
+		std::memcpy(&game_loop, cursor + sizeof(size), sizeof(game_loop));
+		if (size > static_cast<size_t>(end - cursor) - sizeof(size) ||
+			(!index.empty() && game_loop <= index.back().game_loop)) {
+			// The last frame was cut off, or this is the start of the index
+			break;
+		}
+		bool keyframe = cursor[2 * sizeof(uint32_t)] != 0;
+		index.push_back({ static_cast<uint64_t>(cursor - file.Data()),
+			game_loop, keyframe ? 1u : 0u });
+		cursor += sizeof(size) + size;
+	}
+	return true;
+}
+
+bool RecordedFrameSource::Seek(size_t frame) {
+	if (frame > index.size()) {
+		return false;
+	}
+	// Start over from the keyframe of the chunk and skip up to the frame
+	size_t keyframe = frame;
+	while (keyframe > 0 && !index[keyframe].keyframe) {
+		--keyframe;
+	}
+	next_frame = keyframe;
+	Frame skipped;
+	while (next_frame < frame) {
+		if (!DecodeFrame(skipped)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+const GameInfo& RecordedFrameSource::GetGameInfo() const {
+	return game_info;
+}
+
+const UnitTypes& RecordedFrameSource::GetUnitTypeData() const {
+	return unit_types;
+}
+
+Point3D RecordedFrameSource::GetStartLocation() const {
+	return start_location;
+}
+
+bool RecordedFrameSource::NextFrame(Frame& frame) {
+	if (!valid || next_frame >= index.size()) {
+		return false;
+	}
+	return DecodeFrame(frame);
+}
+
+bool RecordedFrameSource::DecodeFrame(Frame& frame) {
+	const char* begin = file.Data() + index[next_frame].offset;
+	recording::ByteReader size_reader(begin, file.Data() + file.Size());
+	uint32_t size = size_reader.Read<uint32_t>();
+	recording::ByteReader in(size_reader.Cursor(), size_reader.Cursor() + size);
+	++next_frame;
+
+	frame.game_loop = in.Read<uint32_t>();
+	bool keyframe = in.Read<uint8_t>() != 0;
+	frame.minerals = in.Read<int32_t>();
+	frame.vespene = in.Read<int32_t>();
+	frame.food_cap = in.Read<int32_t>();
+	frame.food_used = in.Read<int32_t>();
+
+	uint16_t upgrades = in.Read<uint16_t>();
+	frame.upgrades.clear();
+	for (uint16_t i = 0; i < upgrades; ++i) {
+		frame.upgrades.emplace_back(static_cast<UPGRADE_ID>(in.Read<uint32_t>()));
+	}
+	uint16_t dead = in.Read<uint16_t>();
+	frame.dead_units.clear();
+	for (uint16_t i = 0; i < dead; ++i) {
+		frame.dead_units.emplace_back(static_cast<Tag>(in.Read<uint64_t>()));
+	}
+
+	if (keyframe) {
+		units.clear();
+		unit_slots.clear();
+	}
+	uint32_t count = in.Read<uint32_t>();
+	decoded.clear();
+	decoded.reserve(count);
+	for (uint32_t i = 0; i < count && in.Ok(); ++i) {
+		Tag tag = recording::ReadUnitTag(in);
+		auto it = unit_slots.find(tag);
+		if (it != unit_slots.end()) {
+			decoded.emplace_back(units[it->second]);
+		}
+		else {
+			decoded.emplace_back();
+			decoded.back().tag = tag;
+		}
+		recording::ReadUnitFields(in, decoded.back(), frame.game_loop);
+	}
+	if (!in.Ok()) {
+		return Fail("Corrupt frame " + std::to_string(next_frame - 1));
+	}
+
+	units.swap(decoded);
+	unit_slots.clear();
+	for (size_t i = 0; i < units.size(); ++i) {
+		unit_slots[units[i].tag] = i;
+	}
+	frame.units = units;
+	return true;
+}
@@ -0,0 +1,60 @@
+#ifndef BENCH_RECORDED_FRAMES_H_
+#define BENCH_RECORDED_FRAMES_H_
+
+#include "Frame.h"
+
+#include "MappedFile.h"
+#include "Recording.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Plays back a recording written by FrameRecorder.
+// The file is memory mapped and frames are decoded straight from the
+// mapping, one delta at a time.
+class RecordedFrameSource : public FrameSource {
+public:
+	// Maps and validates the recording, check IsValid() afterwards
+	explicit RecordedFrameSource(const std::string& path);
+
+	bool IsValid() const { return valid; }
+	const std::string& Error() const { return error; }
+
+	size_t FrameCount() const { return index.size(); }
+
+	// Makes the next call to NextFrame() return the given frame
+	bool Seek(size_t frame);
+
+	const sc2::GameInfo& GetGameInfo() const;
+	const sc2::UnitTypes& GetUnitTypeData() const;
+	sc2::Point3D GetStartLocation() const;
+	bool NextFrame(Frame& frame);
+
+private:
+	bool Fail(const std::string& message);
+	bool ReadStatic(const char*& cursor);
+	bool ReadIndex(const char* frames_begin);
+
+	// Decodes the frame at the cursor on top of the previous frame's units
+	bool DecodeFrame(Frame& frame);
+
+	MappedFile file;
+	std::vector<recording::IndexEntry> index;
+	size_t next_frame = 0;
+
+	sc2::GameInfo game_info;
+	sc2::UnitTypes unit_types;
+	sc2::Point3D start_location;
+
+	// Units of the last decoded frame by tag, the base of the next deltas
+	std::vector<sc2::Unit> units;
+	std::unordered_map<sc2::Tag, size_t> unit_slots;
+	std::vector<sc2::Unit> decoded;
+
+	bool valid = false;
+	std::string error;
+};
+
+#endif
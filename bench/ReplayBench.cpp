@@ -0,0 +1,112 @@
+#include "ReplayBench.h"
+
+#include "BasicSc2Bot.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <numeric>
+
+using namespace sc2;
+
+namespace {
+
+double ElapsedMicroseconds(std::chrono::steady_clock::time_point since) {
+	return std::chrono::duration<double, std::micro>(
+		std::chrono::steady_clock::now() - since).count();
+}
+
+} // namespace
+
+ReplayBench::ReplayBench(FrameSource& source)
+	: source(source), observation(source), query(observation) {
+}
+
+// Same order as the client: destroyed, created, idle, upgrades,
+// construction complete, then units entering vision
+void ReplayBench::DispatchEvents(BasicSc2Bot& bot,
+	const FrameEvents& events) {
+	for (const auto& unit : events.destroyed) {
+		bot.OnUnitDestroyed(unit);
+	}
+	for (const auto& unit : events.created) {
+		bot.OnUnitCreated(unit);
+	}
+	for (const auto& unit : events.idle) {
+		bot.OnUnitIdle(unit);
+	}
+	for (const auto& upgrade : events.upgrades_completed) {
+		bot.OnUpgradeCompleted(upgrade);
+	}
+	for (const auto& unit : events.construction_complete) {
+		bot.OnBuildingConstructionComplete(unit);
+	}
+	for (const auto& unit : events.entered_vision) {
+		bot.OnUnitEnterVision(unit);
+	}
+}
+
+void ReplayBench::Run(BasicSc2Bot& bot) {
+	bot.SetInterfaces(&observation, &actions, &query, &debug);
+
+	Frame frame;
+	FrameEvents events;
+	bool started = false;
+	while (source.NextFrame(frame)) {
+		observation.SetFrame(frame, events);
+
+		auto frame_start = std::chrono::steady_clock::now();
+		if (!started) {
+			bot.OnGameStart();
+			start_time = ElapsedMicroseconds(frame_start);
+			frame_start = std::chrono::steady_clock::now();
+			started = true;
+		}
+		DispatchEvents(bot, events);
+		bot.OnStep();
+		actions.SendActions();
+		debug.SendDebug();
+		frame_times.emplace_back(ElapsedMicroseconds(frame_start));
+		frame_loops.emplace_back(frame.game_loop);
+	}
+
+	auto end_start = std::chrono::steady_clock::now();
+	bot.OnGameEnd();
+	end_time = ElapsedMicroseconds(end_start);
+}
+
+void ReplayBench::PrintReport(std::ostream& out) const {
+	if (frame_times.empty()) {
+		out << "No frames played" << std::endl;
+		return;
+	}
+
+	std::vector<double> sorted = frame_times;
+	std::sort(sorted.begin(), sorted.end());
+	auto percentile = [&sorted](double p) {
+		size_t index = static_cast<size_t>(p * (sorted.size() - 1));
+		return sorted[index];
+	};
+	double total = std::accumulate(sorted.begin(), sorted.end(), 0.0);
+	size_t slowest = std::max_element(frame_times.begin(), frame_times.end()) -
+		frame_times.begin();
+	double frames = static_cast<double>(frame_times.size());
+
+	out << std::fixed << std::setprecision(2);
+	out << "Frames:            " << frame_times.size() << std::endl;
+	out << "OnGameStart:       " << start_time << " us" << std::endl;
+	out << "OnGameEnd:         " << end_time << " us" << std::endl;
+	out << "Total step time:   " << total / 1000.0 << " ms" << std::endl;
+	out << "Per frame (us):    mean " << total / frames
+		<< ", p50 " << percentile(0.50) << ", p90 " << percentile(0.90)
+		<< ", p99 " << percentile(0.99) << ", max " << sorted.back()
+		<< " (loop " << frame_loops[slowest] << ")" << std::endl;
+	out << "Actions:           " << actions.TotalCommands() << " commands, "
+		<< actions.TotalCommandedUnits() << " unit orders ("
+		<< actions.TotalCommands() / frames << " per frame)" << std::endl;
+	out << "Queries:           " << query.Queries() << " in "
+		<< query.Requests() << " requests ("
+		<< query.Requests() / frames << " per frame)" << std::endl;
+	out << "Observation calls: " << observation.Calls() << std::endl;
+	out << "Debug calls:       " << debug.Calls() << std::endl;
+}
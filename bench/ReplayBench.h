@@ -0,0 +1,43 @@
+#ifndef BENCH_REPLAY_BENCH_H_
+#define BENCH_REPLAY_BENCH_H_
+
+#include "Frame.h"
+#include "MockInterfaces.h"
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+class BasicSc2Bot;
+
+// Drives the bot through a sequence of frames without a game client.
+// Each frame is loaded into the mock observation, the events it raises are
+// dispatched in the same order as the real client, then OnStep runs.
+// Only the bot's own work (events, OnStep and sending actions) is timed.
+class ReplayBench {
+public:
+	explicit ReplayBench(FrameSource& source);
+
+	// Plays every frame of the source through the bot
+	void Run(BasicSc2Bot& bot);
+
+	// Prints per-frame timing and interface usage
+	void PrintReport(std::ostream& out) const;
+
+private:
+	void DispatchEvents(BasicSc2Bot& bot, const FrameEvents& events);
+
+	FrameSource& source;
+	MockObservation observation;
+	MockActions actions;
+	MockQuery query;
+	MockDebug debug;
+
+	// Wall time of each frame in microseconds
+	std::vector<double> frame_times;
+	std::vector<uint32_t> frame_loops;
+	double start_time = 0.0;
+	double end_time = 0.0;
+};
+
+#endif
@@ -0,0 +1,575 @@
+#include "SyntheticFrames.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace sc2;
+
+namespace {
+
+const int kMapSize = 128;
+
+// Terrain height bytes, decoded by the game as -100 + 200 * v / 255,
+// so one step is about 0.8 in game height
+const uint8_t kCenterGround = 138;
+const uint8_t kLowGround = 140;
+const uint8_t kHighGround = 143;
+
+// Grids are stored with an upper left origin
+void SetGridBit(ImageData& grid, int x, int y, bool value) {
+	int index = x + (grid.height - 1 - y) * grid.width;
+	char& byte = grid.data[index / 8];
+	char mask = static_cast<char>(1 << (7 - index % 8));
+	byte = static_cast<char>(value ? (byte | mask) : (byte & ~mask));
+}
+
+void SetGridByte(ImageData& grid, int x, int y, uint8_t value) {
+	grid.data[x + (grid.height - 1 - y) * grid.width] =
+		static_cast<char>(value);
+}
+
+float UnitRadius(UNIT_TYPEID type) {
+	switch (type) {
+	case UNIT_TYPEID::TERRAN_COMMANDCENTER:
+	case UNIT_TYPEID::ZERG_HATCHERY:
+		return 2.75f;
+	case UNIT_TYPEID::TERRAN_BARRACKS:
+	case UNIT_TYPEID::TERRAN_FACTORY:
+	case UNIT_TYPEID::TERRAN_STARPORT:
+	case UNIT_TYPEID::TERRAN_FUSIONCORE:
+	case UNIT_TYPEID::TERRAN_ENGINEERINGBAY:
+	case UNIT_TYPEID::TERRAN_REFINERY:
+	case UNIT_TYPEID::NEUTRAL_VESPENEGEYSER:
+		return 1.8125f;
+	case UNIT_TYPEID::TERRAN_SUPPLYDEPOT:
+		return 1.0f;
+	case UNIT_TYPEID::NEUTRAL_MINERALFIELD:
+		return 1.125f;
+	case UNIT_TYPEID::TERRAN_SIEGETANK:
+		return 0.875f;
+	case UNIT_TYPEID::TERRAN_BATTLECRUISER:
+		return 1.25f;
+	case UNIT_TYPEID::ZERG_ROACH:
+		return 0.625f;
+	default:
+		return 0.375f;
+	}
+}
+
+float UnitHealth(UNIT_TYPEID type) {
+	switch (type) {
+	case UNIT_TYPEID::TERRAN_COMMANDCENTER:
+	case UNIT_TYPEID::ZERG_HATCHERY:
+		return 1500.0f;
+	case UNIT_TYPEID::TERRAN_BARRACKS:
+	case UNIT_TYPEID::TERRAN_FACTORY:
+	case UNIT_TYPEID::TERRAN_STARPORT:
+	case UNIT_TYPEID::TERRAN_FUSIONCORE:
+		return 1000.0f;
+	case UNIT_TYPEID::TERRAN_SUPPLYDEPOT:
+	case UNIT_TYPEID::TERRAN_REFINERY:
+	case UNIT_TYPEID::TERRAN_ENGINEERINGBAY:
+		return 500.0f;
+	case UNIT_TYPEID::TERRAN_SIEGETANK:
+		return 175.0f;
+	case UNIT_TYPEID::TERRAN_BATTLECRUISER:
+		return 550.0f;
+	case UNIT_TYPEID::ZERG_ROACH:
+		return 145.0f;
+	case UNIT_TYPEID::TERRAN_MARINE:
+		return 45.0f;
+	case UNIT_TYPEID::ZERG_ZERGLING:
+		return 35.0f;
+	default:
+		return 40.0f;
+	}
+}
+
+// Damage dealt per game loop to a unit in range
+float UnitDamage(UNIT_TYPEID type) {
+	switch (type) {
+	case UNIT_TYPEID::TERRAN_MARINE:
+		return 0.45f;
+	case UNIT_TYPEID::TERRAN_SIEGETANK:
+		return 1.0f;
+	case UNIT_TYPEID::TERRAN_BATTLECRUISER:
+		return 1.2f;
+	case UNIT_TYPEID::ZERG_ZERGLING:
+		return 0.5f;
+	case UNIT_TYPEID::ZERG_ROACH:
+		return 0.6f;
+	default:
+		return 0.0f;
+	}
+}
+
+bool IsStructureType(UNIT_TYPEID type) {
+	return UnitRadius(type) >= 1.0f &&
+		type != UNIT_TYPEID::TERRAN_BATTLECRUISER;
+}
+
+} // namespace
+
+SyntheticFrameSource::SyntheticFrameSource(uint32_t num_frames, uint32_t seed)
+	: num_frames(num_frames), rng(seed) {
+	BuildMap();
+
+	// The unit type table is indexed by unit type id
+	unit_types.resize(4096);
+
+	// Our base and the enemy base on the opposite corner
+	start = Point2D(26.5f, 26.5f);
+	Spawn(UNIT_TYPEID::TERRAN_COMMANDCENTER, Unit::Alliance::Self, start);
+	Spawn(UNIT_TYPEID::ZERG_HATCHERY, Unit::Alliance::Enemy, Mirror(start));
+	SpawnResources(Point2D(19.0f, 26.0f));
+	SpawnResources(Mirror(Point2D(19.0f, 26.0f)));
+	SpawnResources(Point2D(60.0f, 18.0f));
+	SpawnResources(Mirror(Point2D(60.0f, 18.0f)));
+	SpawnResources(Point2D(18.0f, 64.0f));
+	SpawnResources(Mirror(Point2D(18.0f, 64.0f)));
+
+	for (int i = 0; i < 12; ++i) {
+		Point2D offset(-4.0f + (i % 4), -2.0f + (i / 4) * 1.5f);
+		Unit& scv = Spawn(UNIT_TYPEID::TERRAN_SCV, Unit::Alliance::Self,
+			start + offset);
+		UnitOrder order;
+		order.ability_id = ABILITY_ID::HARVEST_GATHER;
+		scv.orders.emplace_back(order);
+		Spawn(UNIT_TYPEID::ZERG_DRONE, Unit::Alliance::Enemy,
+			Mirror(start + offset));
+	}
+
+	// Scripted build: type, position, start loop
+	const struct {
+		UNIT_TYPEID type;
+		Point2D pos;
+		uint32_t start_loop;
+		float seconds;
+		int32_t minerals;
+		int32_t vespene;
+	} script[] = {
+		{ UNIT_TYPEID::TERRAN_SUPPLYDEPOT, Point2D(32.0f, 36.0f), 400, 21, 100, 0 },
+		{ UNIT_TYPEID::TERRAN_BARRACKS, Point2D(34.5f, 30.5f), 900, 46, 150, 0 },
+		{ UNIT_TYPEID::TERRAN_REFINERY, Point2D(22.5f, 19.5f), 1000, 21, 75, 0 },
+		{ UNIT_TYPEID::TERRAN_SUPPLYDEPOT, Point2D(30.0f, 38.0f), 1500, 21, 100, 0 },
+		{ UNIT_TYPEID::TERRAN_FACTORY, Point2D(34.5f, 20.5f), 1900, 43, 150, 100 },
+		{ UNIT_TYPEID::TERRAN_STARPORT, Point2D(34.5f, 14.5f), 2900, 36, 150, 100 },
+		{ UNIT_TYPEID::TERRAN_ENGINEERINGBAY, Point2D(20.5f, 37.5f), 3000, 25, 125, 0 },
+		{ UNIT_TYPEID::TERRAN_SUPPLYDEPOT, Point2D(28.0f, 38.0f), 3200, 21, 100, 0 },
+		{ UNIT_TYPEID::TERRAN_FUSIONCORE, Point2D(14.5f, 35.5f), 3800, 46, 150, 150 },
+		{ UNIT_TYPEID::TERRAN_SUPPLYDEPOT, Point2D(26.0f, 38.0f), 4400, 21, 100, 0 },
+	};
+	for (const auto& step : script) {
+		constructions.push_back({ step.type, step.pos, step.start_loop,
+			static_cast<uint32_t>(step.seconds * 22.4f), step.minerals,
+			step.vespene, 0 });
+	}
+}
+
+// Two high ground mains in opposite corners, each with a ramp down to the
+// low ground in between
+void SyntheticFrameSource::BuildMap() {
+	game_info.width = kMapSize;
+	game_info.height = kMapSize;
+	game_info.map_name = "Synthetic";
+	game_info.playable_min = Point2D(8.0f, 8.0f);
+	game_info.playable_max = Point2D(kMapSize - 8.0f, kMapSize - 8.0f);
+
+	ImageData& pathing = game_info.pathing_grid;
+	ImageData& placement = game_info.placement_grid;
+	ImageData& height = game_info.terrain_height;
+	pathing.width = placement.width = height.width = kMapSize;
+	pathing.height = placement.height = height.height = kMapSize;
+	pathing.bits_per_pixel = placement.bits_per_pixel = 1;
+	height.bits_per_pixel = 8;
+	pathing.data.assign(kMapSize * kMapSize / 8, 0);
+	placement.data.assign(kMapSize * kMapSize / 8, 0);
+	height.data.assign(kMapSize * kMapSize, static_cast<char>(kLowGround));
+
+	for (int x = 0; x < kMapSize; ++x) {
+		for (int y = 0; y < kMapSize; ++y) {
+			// Fold onto our half, the map is point symmetric
+			int fx = x;
+			int fy = y;
+			if (x + y >= kMapSize) {
+				fx = kMapSize - 1 - x;
+				fy = kMapSize - 1 - y;
+			}
+			// Distance along and across the main diagonal
+			int along = fx + fy;
+			int across = fx - fy;
+
+			bool playable = fx >= 8 && fy >= 8;
+			bool main = fx < 42 && fy < 42;
+			bool center = along >= 100;
+			bool cliff = (fx >= 42 && fx < 44 && fy < 44) ||
+				(fy >= 42 && fy < 44 && fx < 44) ||
+				(along >= 96 && along < 100);
+
+			// The main ramp runs diagonally out of the corner of the main,
+			// two cells wide at the top like ladder maps. The natural ramp
+			// down to the center is a lot wider.
+			bool main_ramp = along >= 83 && along < 92 && std::abs(across) <= 2;
+			bool natural_ramp = along >= 96 && along < 100 &&
+				across >= 14 && across < 34;
+			bool ramp = main_ramp || natural_ramp;
+
+			bool pathable = playable && (!cliff || ramp);
+			SetGridBit(pathing, x, y, pathable);
+			SetGridBit(placement, x, y, pathable && !ramp);
+			if (main_ramp) {
+				// Only the top row shares the height of the main
+				SetGridByte(height, x, y, along == 83 ? kHighGround :
+					static_cast<uint8_t>(kHighGround - 1 - (along - 84) * 3 / 8));
+			}
+			else if (natural_ramp) {
+				SetGridByte(height, x, y, along < 98 ? kLowGround
+					: kCenterGround);
+			}
+			else if (main) {
+				SetGridByte(height, x, y, kHighGround);
+			}
+			else if (center) {
+				SetGridByte(height, x, y, kCenterGround);
+			}
+		}
+	}
+
+	const Point2D self_start(26.5f, 26.5f);
+	game_info.start_locations = { self_start, Mirror(self_start) };
+	game_info.enemy_start_locations = { Mirror(self_start) };
+	PlayerInfo self;
+	self.player_id = 1;
+	self.player_type = PlayerType::Participant;
+	PlayerInfo enemy;
+	enemy.player_id = 2;
+	enemy.player_type = PlayerType::Computer;
+	game_info.player_info = { self, enemy };
+}
+
+// Eight mineral patches in a column and two geysers at its ends
+void SyntheticFrameSource::SpawnResources(const Point2D& center) {
+	for (int i = 0; i < 8; ++i) {
+		Point2D pos(center.x + (i % 2), center.y - 4.5f + i);
+		Unit& mineral = Spawn(UNIT_TYPEID::NEUTRAL_MINERALFIELD,
+			Unit::Alliance::Neutral, pos);
+		mineral.mineral_contents = 1800;
+	}
+	float side = center.x < kMapSize / 2 ? 3.5f : -3.5f;
+	const Point2D offsets[] = { Point2D(side, -6.5f), Point2D(side, 6.5f) };
+	for (const auto& offset : offsets) {
+		Unit& geyser = Spawn(UNIT_TYPEID::NEUTRAL_VESPENEGEYSER,
+			Unit::Alliance::Neutral, center + offset);
+		geyser.vespene_contents = 2250;
+	}
+}
+
+Point2D SyntheticFrameSource::Mirror(const Point2D& p) const {
+	return Point2D(kMapSize - p.x, kMapSize - p.y);
+}
+
+Unit& SyntheticFrameSource::Spawn(UNIT_TYPEID type, Unit::Alliance alliance,
+	const Point2D& pos) {
+	Unit unit;
+	unit.tag = next_tag++;
+	unit.unit_type = type;
+	unit.alliance = alliance;
+	unit.owner = alliance == Unit::Alliance::Self ? 1
+		: alliance == Unit::Alliance::Enemy ? 2 : 16;
+	unit.pos = Point3D(pos.x, pos.y, 10.0f);
+	unit.radius = UnitRadius(type);
+	unit.health_max = UnitHealth(type);
+	unit.health = unit.health_max;
+	unit.build_progress = 1.0f;
+	unit.display_type = Unit::DisplayType::Visible;
+	unit.is_flying = type == UNIT_TYPEID::TERRAN_BATTLECRUISER;
+	unit.is_alive = true;
+	world.emplace_back(unit);
+	return world.back();
+}
+
+int SyntheticFrameSource::Find(Tag tag) const {
+	for (size_t i = 0; i < world.size(); ++i) {
+		if (world[i].tag == tag) {
+			return static_cast<int>(i);
+		}
+	}
+	return -1;
+}
+
+const GameInfo& SyntheticFrameSource::GetGameInfo() const {
+	return game_info;
+}
+
+const UnitTypes& SyntheticFrameSource::GetUnitTypeData() const {
+	return unit_types;
+}
+
+Point3D SyntheticFrameSource::GetStartLocation() const {
+	return Point3D(start.x, start.y, 10.0f);
+}
+
+bool SyntheticFrameSource::NextFrame(Frame& frame) {
+	if (game_loop >= num_frames) {
+		return false;
+	}
+	++game_loop;
+
+	frame.dead_units.clear();
+	UpdateConstruction();
+	UpdateProduction();
+	UpdateEnemyWaves();
+	UpdateCombat(frame);
+
+	// Income from workers and refineries
+	int32_t scvs = 0;
+	int32_t refineries = 0;
+	int32_t food_cap = 0;
+	int32_t food_used = 0;
+	for (const auto& unit : world) {
+		if (unit.alliance != Unit::Alliance::Self) {
+			continue;
+		}
+		if (unit.unit_type == UNIT_TYPEID::TERRAN_SCV) {
+			++scvs;
+		}
+		if (unit.build_progress < 1.0f) {
+			continue;
+		}
+		switch (unit.unit_type.ToType()) {
+		case UNIT_TYPEID::TERRAN_REFINERY:
+			++refineries;
+			break;
+		case UNIT_TYPEID::TERRAN_COMMANDCENTER:
+			food_cap += 15;
+			break;
+		case UNIT_TYPEID::TERRAN_SUPPLYDEPOT:
+			food_cap += 8;
+			break;
+		case UNIT_TYPEID::TERRAN_SIEGETANK:
+			food_used += 3;
+			break;
+		case UNIT_TYPEID::TERRAN_BATTLECRUISER:
+			food_used += 6;
+			break;
+		case UNIT_TYPEID::TERRAN_SCV:
+		case UNIT_TYPEID::TERRAN_MARINE:
+			food_used += 1;
+			break;
+		default:
+			break;
+		}
+	}
+	minerals += 0.045f * scvs;
+	vespene += 0.12f * refineries;
+
+	frame.game_loop = game_loop;
+	frame.minerals = static_cast<int32_t>(minerals);
+	frame.vespene = static_cast<int32_t>(vespene);
+	frame.food_cap = std::min(food_cap, 200);
+	frame.food_used = food_used;
+	frame.units = world;
+	return true;
+}
+
+void SyntheticFrameSource::UpdateConstruction() {
+	for (auto& construction : constructions) {
+		if (game_loop == construction.start_loop) {
+			Unit& building = Spawn(construction.type, Unit::Alliance::Self,
+				construction.pos);
+			building.build_progress = 0.0f;
+			building.health = 1.0f;
+			construction.tag = building.tag;
+			minerals = std::max(0.0f, minerals - construction.minerals);
+			vespene = std::max(0.0f, vespene - construction.vespene);
+		}
+		if (!construction.tag || game_loop < construction.start_loop) {
+			continue;
+		}
+		int index = Find(construction.tag);
+		if (index < 0) {
+			continue;
+		}
+		Unit& building = world[index];
+		float progress = static_cast<float>(game_loop -
+			construction.start_loop) / construction.build_loops;
+		building.build_progress = std::min(progress, 1.0f);
+		building.health = std::max(building.health,
+			building.health_max * building.build_progress);
+	}
+}
+
+// Production buildings queue a unit on a fixed cadence
+void SyntheticFrameSource::UpdateProduction() {
+	int32_t scvs = 0;
+	bool fusion_core = false;
+	for (const auto& unit : world) {
+		if (unit.alliance != Unit::Alliance::Self) {
+			continue;
+		}
+		scvs += unit.unit_type == UNIT_TYPEID::TERRAN_SCV;
+		fusion_core |= unit.unit_type == UNIT_TYPEID::TERRAN_FUSIONCORE &&
+			unit.build_progress >= 1.0f;
+	}
+
+	std::uniform_real_distribution<float> jitter(-2.0f, 2.0f);
+	const size_t count = world.size();
+	for (size_t i = 0; i < count; ++i) {
+		const Unit producer = world[i];
+		if (producer.alliance != Unit::Alliance::Self ||
+			producer.build_progress < 1.0f) {
+			continue;
+		}
+		UNIT_TYPEID type = UNIT_TYPEID::INVALID;
+		uint32_t cadence = 0;
+		int32_t cost_m = 0;
+		int32_t cost_g = 0;
+		switch (producer.unit_type.ToType()) {
+		case UNIT_TYPEID::TERRAN_COMMANDCENTER:
+			if (scvs < 22) {
+				type = UNIT_TYPEID::TERRAN_SCV;
+				cadence = 272;
+				cost_m = 50;
+			}
+			break;
+		case UNIT_TYPEID::TERRAN_BARRACKS:
+			type = UNIT_TYPEID::TERRAN_MARINE;
+			cadence = 400;
+			cost_m = 50;
+			break;
+		case UNIT_TYPEID::TERRAN_FACTORY:
+			type = UNIT_TYPEID::TERRAN_SIEGETANK;
+			cadence = 720;
+			cost_m = 150;
+			cost_g = 125;
+			break;
+		case UNIT_TYPEID::TERRAN_STARPORT:
+			if (fusion_core) {
+				type = UNIT_TYPEID::TERRAN_BATTLECRUISER;
+				cadence = 1600;
+				cost_m = 400;
+				cost_g = 300;
+			}
+			break;
+		default:
+			break;
+		}
+		if (type == UNIT_TYPEID::INVALID || game_loop % cadence != 0 ||
+			minerals < cost_m || vespene < cost_g) {
+			continue;
+		}
+		minerals -= cost_m;
+		vespene -= cost_g;
+		Point2D offset(producer.radius + 1.0f + jitter(rng), jitter(rng));
+		Unit& unit = Spawn(type, Unit::Alliance::Self,
+			Point2D(producer.pos.x, producer.pos.y) + offset);
+		if (type == UNIT_TYPEID::TERRAN_SCV) {
+			UnitOrder order;
+			order.ability_id = ABILITY_ID::HARVEST_GATHER;
+			unit.orders.emplace_back(order);
+		}
+	}
+}
+
+// Zerg waves walk from the center of the map to our command center
+void SyntheticFrameSource::UpdateEnemyWaves() {
+	const Point2D rally(70.0f, 42.0f);
+	if (game_loop >= 2400 && game_loop % 900 == 0) {
+		std::uniform_real_distribution<float> jitter(-3.0f, 3.0f);
+		for (int i = 0; i < 8; ++i) {
+			UNIT_TYPEID type = i < 6 ? UNIT_TYPEID::ZERG_ZERGLING
+				: UNIT_TYPEID::ZERG_ROACH;
+			Spawn(type, Unit::Alliance::Enemy,
+				rally + Point2D(jitter(rng), jitter(rng)));
+		}
+	}
+
+	for (auto& unit : world) {
+		if (unit.alliance != Unit::Alliance::Enemy ||
+			(unit.unit_type != UNIT_TYPEID::ZERG_ZERGLING &&
+				unit.unit_type != UNIT_TYPEID::ZERG_ROACH)) {
+			continue;
+		}
+		if (unit.engaged_target_tag) {
+			unit.orders.clear();
+			continue;
+		}
+
+		// Go down the natural ramp, then up the main ramp
+		Point2D pos(unit.pos.x, unit.pos.y);
+		float along = pos.x + pos.y;
+		float across = pos.x - pos.y;
+		Point2D target = start;
+		if (along > 96.0f) {
+			target = Point2D(58.5f, 34.5f);
+		}
+		else if (along > 91.5f || std::abs(across) > 1.5f) {
+			target = Point2D(45.5f, 45.5f);
+		}
+		Point2D direction = target - pos;
+		float length = Distance2D(target, pos);
+		float speed = unit.unit_type == UNIT_TYPEID::ZERG_ZERGLING ? 0.18f
+			: 0.14f;
+		if (length > speed) {
+			pos += direction * (speed / length);
+			unit.pos = Point3D(pos.x, pos.y, unit.pos.z);
+		}
+		UnitOrder order;
+		order.ability_id = ABILITY_ID::ATTACK;
+		order.target_pos = start;
+		unit.orders.assign(1, order);
+	}
+}
+
+// Units within 6 of an opposing unit trade damage every loop
+void SyntheticFrameSource::UpdateCombat(Frame& frame) {
+	const float range = 6.0f;
+	for (auto& unit : world) {
+		unit.engaged_target_tag = NullTag;
+	}
+	for (auto& attacker : world) {
+		float damage = UnitDamage(attacker.unit_type);
+		if (damage <= 0.0f) {
+			continue;
+		}
+		Unit* target = nullptr;
+		float best = range;
+		for (auto& other : world) {
+			if (other.alliance == attacker.alliance ||
+				other.alliance == Unit::Alliance::Neutral ||
+				other.health <= 0.0f) {
+				continue;
+			}
+			float distance = Distance2D(Point2D(attacker.pos.x, attacker.pos.y),
+				Point2D(other.pos.x, other.pos.y));
+			if (distance < best) {
+				best = distance;
+				target = &other;
+			}
+		}
+		if (target) {
+			target->health -= damage;
+			if (IsStructureType(target->unit_type)) {
+				// Structures are never destroyed by the script
+				target->health = std::max(target->health, 1.0f);
+			}
+			attacker.engaged_target_tag = target->tag;
+			attacker.weapon_cooldown = 0.5f;
+		}
+		else {
+			attacker.weapon_cooldown = 0.0f;
+		}
+	}
+
+	// Remove the dead units
+	auto dead = std::remove_if(world.begin(), world.end(),
+		[&frame](const Unit& unit) {
+			if (unit.alliance != Unit::Alliance::Neutral &&
+				unit.health <= 0.0f) {
+				frame.dead_units.emplace_back(unit.tag);
+				return true;
+			}
+			return false;
+		});
+	world.erase(dead, world.end());
+}
@@ -0,0 +1,69 @@
+#ifndef BENCH_SYNTHETIC_FRAMES_H_
+#define BENCH_SYNTHETIC_FRAMES_H_
+
+#include "Frame.h"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// Deterministic frame generator used when no recording is available.
+// Plays a scripted Terran opening on a small two-player map: structures go
+// up over time, production buildings spawn units, and Zerg waves walk into
+// the main base and fight, so every bot subsystem gets exercised.
+// The script does not react to the bot's commands.
+class SyntheticFrameSource : public FrameSource {
+public:
+	SyntheticFrameSource(uint32_t num_frames, uint32_t seed);
+
+	const sc2::GameInfo& GetGameInfo() const;
+	const sc2::UnitTypes& GetUnitTypeData() const;
+	sc2::Point3D GetStartLocation() const;
+	bool NextFrame(Frame& frame);
+
+private:
+	struct Construction {
+		sc2::UNIT_TYPEID type;
+		sc2::Point2D pos;
+		uint32_t start_loop;
+		uint32_t build_loops;
+		int32_t minerals;
+		int32_t vespene;
+		sc2::Tag tag;
+	};
+
+	void BuildMap();
+	void SpawnResources(const sc2::Point2D& center);
+
+	// Adds a unit to the world and returns it
+	sc2::Unit& Spawn(sc2::UNIT_TYPEID type, sc2::Unit::Alliance alliance,
+		const sc2::Point2D& pos);
+
+	// Index of the unit with the given tag, or -1
+	int Find(sc2::Tag tag) const;
+
+	void UpdateConstruction();
+	void UpdateProduction();
+	void UpdateEnemyWaves();
+	void UpdateCombat(Frame& frame);
+
+	// Mirrors a point to the opposite side of the map
+	sc2::Point2D Mirror(const sc2::Point2D& p) const;
+
+	sc2::GameInfo game_info;
+	sc2::UnitTypes unit_types;
+	sc2::Point2D start;
+
+	uint32_t num_frames;
+	uint32_t game_loop = 0;
+	std::mt19937 rng;
+
+	std::vector<sc2::Unit> world;
+	std::vector<Construction> constructions;
+	sc2::Tag next_tag = 0x100000001ULL;
+
+	float minerals = 50.0f;
+	float vespene = 0.0f;
+};
+
+#endif
@@ -0,0 +1,92 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "sc2utils/sc2_arg_parser.h"
+
+#include "BasicSc2Bot.h"
+#include "MapLabelling.h"
+#include "RecordedFrames.h"
+#include "ReplayBench.h"
+#include "SyntheticFrames.h"
+
+// Offline benchmark: plays frames through the bot with mock game interfaces
+// and reports the CPU time spent per frame
+
+int main(int argc, char* argv[]) {
+	sc2::ArgParser arg_parser(argv[0]);
+	arg_parser.AddOptions({
+		{ "-f", "--Frames", "Number of game loops to play", false },
+		{ "-s", "--Seed", "Seed of the synthetic game", false },
+		{ "-r", "--Replay", "Recording to play instead of the synthetic game",
+			false },
+		{ "-w", "--Write", "File to record the played frames to", false },
+		{ "-t", "--Trace", "File to write a Chrome trace of every step to",
+			false },
+		{ "-k", "--MapCache", "Directory to cache the map analysis in",
+			false },
+		{ "-l", "--Labelling",
+			"Time the map labelling against the old flood fill this many "
+			"times and exit", false },
+		});
+	arg_parser.Parse(argc, argv);
+
+	uint32_t frames = 13440; // 10 minutes at faster speed
+	std::string frames_str;
+	if (arg_parser.Get("Frames", frames_str)) {
+		frames = static_cast<uint32_t>(atoi(frames_str.c_str()));
+	}
+	uint32_t seed = 1;
+	std::string seed_str;
+	if (arg_parser.Get("Seed", seed_str)) {
+		seed = static_cast<uint32_t>(atoi(seed_str.c_str()));
+	}
+
+	std::unique_ptr<FrameSource> source;
+	std::string replay;
+	if (arg_parser.Get("Replay", replay)) {
+		std::unique_ptr<RecordedFrameSource> recorded(
+			new RecordedFrameSource(replay));
+		if (!recorded->IsValid()) {
+			std::cout << recorded->Error() << std::endl;
+			return 1;
+		}
+		std::cout << "Playing " << recorded->FrameCount() << " frames of "
+			<< replay << std::endl;
+		source = std::move(recorded);
+	}
+	else {
+		source.reset(new SyntheticFrameSource(frames, seed));
+	}
+
+	std::string labelling;
+	if (arg_parser.Get("Labelling", labelling)) {
+		int runs = std::max(atoi(labelling.c_str()), 1);
+		return CompareMapLabelling(source->GetGameInfo(), runs, std::cout)
+			? 0 : 1;
+	}
+
+	BasicSc2Bot bot;
+	std::string write;
+	if (arg_parser.Get("Write", write) && !bot.Recorder().Open(write)) {
+		std::cout << "Could not open " << write << " for recording"
+			<< std::endl;
+		return 1;
+	}
+	std::string map_cache;
+	if (arg_parser.Get("MapCache", map_cache)) {
+		bot.AnalysisCache().SetDirectory(map_cache);
+	}
+	std::string trace;
+	if (arg_parser.Get("Trace", trace) && !TraceWriter::Get().Open(trace)) {
+		std::cout << "Could not open " << trace << " for tracing" << std::endl;
+		return 1;
+	}
+
+	ReplayBench bench(*source);
+	bench.Run(bot);
+	bench.PrintReport(std::cout);
+	return 0;
+}
@@ -11,6 +11,8 @@
 // played against other bots
 
 int main(int argc, char* argv[]) {
-	RunBot(argc, argv, new BasicSc2Bot(), sc2::Race::Terran);
+	BasicSc2Bot* bot = new BasicSc2Bot();
+	RunBot(argc, argv, bot, sc2::Race::Terran, &bot->Recorder(),
+		&bot->AnalysisCache());
 	return 0;
 }
\ No newline at end of file